@@ -0,0 +1,217 @@
+/*
+ * AnalysisCache.cpp is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#include "AnalysisCache.h"
+#include <wx/fileconf.h>
+#include <wx/filename.h>
+#include <wx/log.h>
+#include <wx/thread.h>
+#include <map>
+#include <cstring>
+
+bool AnalysisCache::m_enabled = true;
+
+typedef struct {
+  wxFileConfig *file;
+  bool changed;
+} CACHE_FILE;
+
+// The sidecars read so far by directory, shared by everything in the program
+static wxMutex& GetCacheLock() {
+  static wxMutex lock;
+  return lock;
+}
+
+static std::map<wxString, CACHE_FILE>& GetCacheFiles() {
+  static std::map<wxString, CACHE_FILE> cacheFiles;
+  return cacheFiles;
+}
+
+// The lock must be held
+static CACHE_FILE& GetCacheFile(const wxString &directory) {
+  std::map<wxString, CACHE_FILE> &cacheFiles = GetCacheFiles();
+  std::map<wxString, CACHE_FILE>::iterator it = cacheFiles.find(directory);
+  if (it != cacheFiles.end())
+    return it->second;
+
+  wxString filePath = directory;
+  filePath += wxFILE_SEP_PATH;
+  filePath += wxT(".loopauditioneer-cache");
+
+  // a missing or unreadable sidecar shouldn't give any error dialogs, it's just empty
+  wxLogNull noLog;
+  CACHE_FILE &cacheFile = cacheFiles[directory];
+  cacheFile.file = new wxFileConfig(wxEmptyString, wxEmptyString, filePath, wxEmptyString, wxCONFIG_USE_LOCAL_FILE);
+  cacheFile.changed = false;
+  return cacheFile;
+}
+
+// The lock must be held
+static void WriteCacheFile(CACHE_FILE &cacheFile) {
+  if (!cacheFile.changed)
+    return;
+
+  // a read-only directory shouldn't give any error dialogs, the results are just not kept
+  wxLogNull noLog;
+  cacheFile.file->Flush();
+  cacheFile.changed = false;
+}
+
+AnalysisCache::AnalysisCache(wxString directory, wxString contentHash) {
+  m_directory = directory;
+  m_group = contentHash;
+}
+
+AnalysisCache::AnalysisCache(wxString directory, wxString fileName, wxString fileStamp) {
+  m_directory = directory;
+  m_fileStamp = fileStamp;
+  // without a stamp nothing can be trusted
+  if (!fileStamp.IsEmpty())
+    m_group = fileName;
+}
+
+AnalysisCache::~AnalysisCache() {
+}
+
+template <typename T> bool AnalysisCache::ReadValue(const wxString &key, T *value) {
+  if (!IsUsable())
+    return false;
+
+  wxMutexLocker locker(GetCacheLock());
+  wxFileConfig *cache = GetCacheFile(m_directory).file;
+  cache->SetPath(wxT("/") + m_group);
+  if (!m_fileStamp.IsEmpty() && cache->Read(wxT("FileStamp"), wxEmptyString) != m_fileStamp)
+    return false;
+  return cache->Read(key, value);
+}
+
+template <typename T> void AnalysisCache::WriteValue(const wxString &key, T value) {
+  if (!IsUsable())
+    return;
+
+  wxMutexLocker locker(GetCacheLock());
+  CACHE_FILE &cacheFile = GetCacheFile(m_directory);
+  cacheFile.file->SetPath(wxT("/") + m_group);
+  if (!m_fileStamp.IsEmpty() && cacheFile.file->Read(wxT("FileStamp"), wxEmptyString) != m_fileStamp) {
+    // the file has changed so all that was kept for it is replaced
+    cacheFile.file->SetPath(wxT("/"));
+    cacheFile.file->DeleteGroup(m_group);
+    cacheFile.file->SetPath(wxT("/") + m_group);
+    cacheFile.file->Write(wxT("FileStamp"), m_fileStamp);
+  }
+  cacheFile.file->Write(key, value);
+  cacheFile.changed = true;
+}
+
+bool AnalysisCache::Read(const wxString &key, double *value) {
+  return ReadValue(key, value);
+}
+
+bool AnalysisCache::Read(const wxString &key, long *value) {
+  return ReadValue(key, value);
+}
+
+bool AnalysisCache::Read(const wxString &key, wxString *value) {
+  return ReadValue(key, value);
+}
+
+void AnalysisCache::Write(const wxString &key, double value) {
+  WriteValue(key, value);
+}
+
+void AnalysisCache::Write(const wxString &key, long value) {
+  WriteValue(key, value);
+}
+
+void AnalysisCache::Write(const wxString &key, const wxString &value) {
+  WriteValue(key, value);
+}
+
+void AnalysisCache::Flush(wxString directory) {
+  wxMutexLocker locker(GetCacheLock());
+  std::map<wxString, CACHE_FILE> &cacheFiles = GetCacheFiles();
+  std::map<wxString, CACHE_FILE>::iterator it = cacheFiles.find(directory);
+  if (it != cacheFiles.end())
+    WriteCacheFile(it->second);
+}
+
+void AnalysisCache::FlushAll() {
+  wxMutexLocker locker(GetCacheLock());
+  wxLogNull noLog;
+  std::map<wxString, CACHE_FILE> &cacheFiles = GetCacheFiles();
+  for (std::map<wxString, CACHE_FILE>::iterator it = cacheFiles.begin(); it != cacheFiles.end(); ++it) {
+    WriteCacheFile(it->second);
+    delete it->second.file;
+  }
+  cacheFiles.clear();
+}
+
+/*
+ * FNV-1a style hash that consumes 64 bits at a time which is plenty for
+ * telling audio files apart, it still takes a pass over all the audio
+ */
+wxUint64 AnalysisCache::HashData(const void *data, size_t bytes, wxUint64 hash) {
+  const wxUint64 prime = 1099511628211ULL;
+  const unsigned char *ptr = (const unsigned char*) data;
+
+  while (bytes >= sizeof(wxUint64)) {
+    wxUint64 word;
+    memcpy(&word, ptr, sizeof(wxUint64));
+    hash ^= word;
+    hash *= prime;
+    ptr += sizeof(wxUint64);
+    bytes -= sizeof(wxUint64);
+  }
+  while (bytes > 0) {
+    hash ^= *ptr;
+    hash *= prime;
+    ptr++;
+    bytes--;
+  }
+  return hash;
+}
+
+wxString AnalysisCache::HashToString(wxUint64 hash) {
+  return wxString::Format(wxT("%016") wxLongLongFmtSpec wxT("x"), hash);
+}
+
+wxString AnalysisCache::GetFileStamp(wxString filePath) {
+  wxFileName file(filePath);
+  wxDateTime modified = file.GetModificationTime();
+  if (!modified.IsValid())
+    return wxEmptyString;
+
+  return file.GetSize().ToString() + wxT(" ") + modified.GetValue().ToString();
+}
+
+void AnalysisCache::SetEnabled(bool enabled) {
+  m_enabled = enabled;
+}
+
+bool AnalysisCache::IsEnabled() {
+  return m_enabled;
+}
+
+bool AnalysisCache::IsUsable() {
+  if (m_enabled && !m_group.IsEmpty())
+    return true;
+  else
+    return false;
+}
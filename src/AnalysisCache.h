@@ -0,0 +1,85 @@
+/*
+ * AnalysisCache.h is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#ifndef ANALYSISCACHE_H
+#define ANALYSISCACHE_H
+
+#include <wx/wx.h>
+
+/*
+ * AnalysisCache stores results of (slow) analysis of audio data in a sidecar
+ * file in the same directory as the audio files. The results are grouped by
+ * a hash of the audio content so a result is only found again if the audio
+ * data is unchanged. Results that take no longer to calculate than hashing
+ * the audio are grouped by the name of the file instead, with a stamp of its
+ * size and modification time. When the stamp no longer matches nothing is
+ * found and the next write replaces the whole group, so a file that is saved
+ * over and over keeps a single group. The key should describe the analysis and any parameters
+ * that affect the result, and end with a version that is raised whenever the
+ * algorithm starts to return something else.
+ *
+ * The sidecar of a directory is read once and kept for the whole program,
+ * shared by all AnalysisCache objects and threads under one lock. Changes
+ * are only written to disk by Flush() or FlushAll(), which should be called
+ * when a file is closed or a job over many files is done.
+ */
+class AnalysisCache {
+public:
+  AnalysisCache(wxString directory, wxString contentHash);
+  // For a file as it is on disk, fileStamp from GetFileStamp()
+  AnalysisCache(wxString directory, wxString fileName, wxString fileStamp);
+  ~AnalysisCache();
+
+  bool Read(const wxString &key, double *value);
+  bool Read(const wxString &key, long *value);
+  bool Read(const wxString &key, wxString *value);
+  void Write(const wxString &key, double value);
+  void Write(const wxString &key, long value);
+  void Write(const wxString &key, const wxString &value);
+
+  // Hashing helpers, pass a previous result as hash to continue hashing
+  static wxUint64 HashData(const void *data, size_t bytes, wxUint64 hash = 14695981039346656037ULL);
+  static wxString HashToString(wxUint64 hash);
+  // Size and modification time of a file, empty if the file can't be found
+  static wxString GetFileStamp(wxString filePath);
+
+  // The cache can be turned off globally
+  static void SetEnabled(bool enabled);
+  static bool IsEnabled();
+
+  // Writes the changed results of one directory to its sidecar file
+  static void Flush(wxString directory);
+  // Writes the changed results of all directories and drops them from memory
+  static void FlushAll();
+
+private:
+  wxString m_directory;
+  wxString m_group;
+  wxString m_fileStamp; // empty when grouped by content
+
+  bool IsUsable();
+
+  template <typename T> bool ReadValue(const wxString &key, T *value);
+  template <typename T> void WriteValue(const wxString &key, T value);
+
+  static bool m_enabled;
+};
+
+#endif
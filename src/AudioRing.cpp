@@ -0,0 +1,103 @@
+/*
+ * AudioRing.cpp is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#include "AudioRing.h"
+#include <algorithm>
+
+AudioRing::AudioRing() :
+  m_channels(1),
+  m_mask(0),
+  m_readFrame(0),
+  m_writeFrame(0),
+  m_dropped(0) {
+
+}
+
+AudioRing::~AudioRing() {
+
+}
+
+void AudioRing::Reset(unsigned channels, unsigned long frames) {
+  unsigned long size = 1;
+  while (size < frames)
+    size <<= 1;
+
+  m_channels = channels > 0 ? channels : 1;
+  m_mask = size - 1;
+  m_buffer.assign(size * m_channels, 0.0f);
+  m_readFrame.store(0);
+  m_writeFrame.store(0);
+  m_dropped.store(0);
+}
+
+unsigned AudioRing::GetChannels() {
+  return m_channels;
+}
+
+unsigned long AudioRing::Write(const float *data, unsigned long frames) {
+  if (m_buffer.empty())
+    return 0;
+
+  unsigned long write = m_writeFrame.load();
+  unsigned long space = m_mask + 1 - (write - m_readFrame.load());
+  if (frames > space) {
+    m_dropped.fetch_add(frames - space);
+    frames = space;
+  }
+
+  // in at most two pieces around the end of the buffer
+  unsigned long index = write & m_mask;
+  unsigned long first = std::min(frames, m_mask + 1 - index);
+  std::copy(data, data + first * m_channels, &m_buffer[index * m_channels]);
+  if (frames > first)
+    std::copy(data + first * m_channels, data + frames * m_channels, &m_buffer[0]);
+
+  m_writeFrame.store(write + frames);
+  return frames;
+}
+
+unsigned long AudioRing::Available() {
+  return m_writeFrame.load() - m_readFrame.load();
+}
+
+unsigned long AudioRing::Read(float *dest, unsigned long maxFrames) {
+  unsigned long read = m_readFrame.load();
+  unsigned long frames = std::min(maxFrames, m_writeFrame.load() - read);
+  if (frames == 0)
+    return 0;
+
+  unsigned long index = read & m_mask;
+  unsigned long first = std::min(frames, m_mask + 1 - index);
+  const float *source = &m_buffer[index * m_channels];
+  std::copy(source, source + first * m_channels, dest);
+  if (frames > first)
+    std::copy(&m_buffer[0], &m_buffer[(frames - first) * m_channels], dest + first * m_channels);
+
+  m_readFrame.store(read + frames);
+  return frames;
+}
+
+void AudioRing::Discard() {
+  m_readFrame.store(m_writeFrame.load());
+}
+
+unsigned long AudioRing::TakeDropped() {
+  return m_dropped.exchange(0);
+}
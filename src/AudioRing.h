@@ -0,0 +1,63 @@
+/*
+ * AudioRing.h is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#ifndef AUDIORING_H
+#define AUDIORING_H
+
+#include <atomic>
+#include <vector>
+
+/*
+ * AudioRing is a single producer, single consumer ring buffer of interleaved
+ * frames. Write() is wait-free so that the audio callback can hand what it
+ * plays to the GUI, frames that don't fit are dropped instead of waiting for
+ * the reader. Read() and Discard() are only called by the consumer. Reset()
+ * reallocates the buffer and must not run while either side is using it.
+ */
+class AudioRing {
+public:
+  AudioRing();
+  ~AudioRing();
+
+  // frames is rounded up to a power of two
+  void Reset(unsigned channels, unsigned long frames);
+  unsigned GetChannels();
+
+  // Producer side, returns the number of frames written
+  unsigned long Write(const float *data, unsigned long frames);
+
+  // Consumer side
+  unsigned long Available();
+  unsigned long Read(float *dest, unsigned long maxFrames);
+  void Discard();
+  // Frames the producer had to drop since the last call
+  unsigned long TakeDropped();
+
+private:
+  std::vector<float> m_buffer;
+  unsigned m_channels;
+  unsigned long m_mask; // frames in the buffer - 1
+  std::atomic<unsigned long> m_readFrame; // only increasing, masked when used
+  std::atomic<unsigned long> m_writeFrame;
+  std::atomic<unsigned long> m_dropped;
+
+};
+
+#endif
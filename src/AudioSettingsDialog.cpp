@@ -29,6 +29,7 @@ IMPLEMENT_CLASS(AudioSettingsDialog, wxDialog )
 BEGIN_EVENT_TABLE(AudioSettingsDialog, wxDialog)
   EVT_CHOICE(ID_SOUND_API, AudioSettingsDialog::OnApiChoice)
   EVT_CHOICE(ID_SOUND_DEVICE, AudioSettingsDialog::OnDeviceChoice)
+  EVT_CHECKBOX(ID_LOW_LATENCY, AudioSettingsDialog::OnLowLatencyCheck)
 END_EVENT_TABLE()
 
 AudioSettingsDialog::AudioSettingsDialog(MySound *my_snd) {
@@ -54,6 +55,23 @@ void AudioSettingsDialog::Init(MySound *my_snd) {
   for (unsigned i = 0; i < my_snd->m_availableApis.size(); i++)
     m_availableApis.Add(wxString(RtAudio::getApiName(my_snd->m_availableApis[i])));
   UpdateAvailableDevices();
+
+  m_lowLatency = my_snd->IsLowLatency();
+  m_lowLatencyFrames = my_snd->GetLowLatencyBufferFrames();
+  for (unsigned size = 32; size < MYSOUND_BUFFER_FRAMES; size *= 2)
+    m_bufferSizes.Add(wxString::Format(wxT("%u"), size));
+
+  // what the device agreed to the last time a stream was opened
+  if (my_snd->GetStreamLatency() > 0 || my_snd->IsStreamAvailable()) {
+    m_streamStatus = wxString::Format(
+      wxT("Last stream: %u frames per buffer, %.1f ms output latency, %u xruns"),
+      my_snd->GetBufferFrames(),
+      my_snd->GetStreamLatency() * 1000.0,
+      my_snd->GetPlaybackEngine()->GetXrunCount()
+    );
+  } else {
+    m_streamStatus = wxT("No audio stream has been opened yet.");
+  }
 }
 
 bool AudioSettingsDialog::Create(
@@ -151,6 +169,67 @@ void AudioSettingsDialog::CreateControls() {
   if (ConvertDeviceIdToString() != wxEmptyString)
     m_deviceChoice->SetStringSelection(ConvertDeviceIdToString());
 
+  // A horizontal line before the latency settings
+  wxStaticLine *latencyline = new wxStaticLine(
+    this,
+    wxID_STATIC,
+    wxDefaultPosition,
+    wxDefaultSize,
+    wxLI_HORIZONTAL
+  );
+  boxSizer->Add(latencyline, 0, wxGROW|wxALL, 5);
+
+  // Checkbox for low latency mode
+  m_lowLatencyCheck = new wxCheckBox(
+    this,
+    ID_LOW_LATENCY,
+    wxT("Low latency mode"),
+    wxDefaultPosition,
+    wxDefaultSize,
+    0
+  );
+  m_lowLatencyCheck->SetValue(m_lowLatency);
+  boxSizer->Add(m_lowLatencyCheck, 0, wxALL, 5);
+
+  // Horizontal sizer for the buffer size
+  wxBoxSizer *bufferRow = new wxBoxSizer(wxHORIZONTAL);
+  boxSizer->Add(bufferRow, 0, wxEXPAND|wxALL, 0);
+
+  // Label for buffer size
+  wxStaticText *bufferLabel = new wxStaticText(
+    this,
+    wxID_STATIC,
+    wxT("Buffer size (frames): "),
+    wxDefaultPosition,
+    wxDefaultSize,
+    0
+  );
+  bufferRow->Add(bufferLabel, 0, wxALIGN_CENTER_VERTICAL|wxALL, 2);
+
+  // wxChoice for low latency buffer size
+  m_bufferChoice = new wxChoice(
+    this,
+    ID_LOW_LATENCY_BUFFER,
+    wxDefaultPosition,
+    wxDefaultSize,
+    m_bufferSizes
+  );
+  bufferRow->Add(m_bufferChoice, 1, wxEXPAND|wxALL, 5);
+  if (!m_bufferChoice->SetStringSelection(wxString::Format(wxT("%u"), m_lowLatencyFrames)))
+    m_bufferChoice->SetStringSelection(wxT("128"));
+  m_bufferChoice->Enable(m_lowLatency);
+
+  // Information about the last opened stream
+  wxStaticText *streamStatus = new wxStaticText(
+    this,
+    wxID_STATIC,
+    m_streamStatus,
+    wxDefaultPosition,
+    wxDefaultSize,
+    0
+  );
+  boxSizer->Add(streamStatus, 0, wxALIGN_LEFT|wxALL, 5);
+
   // A horizontal line before the buttons
   wxStaticLine *bottomline = new wxStaticLine(
     this,
@@ -192,6 +271,8 @@ void AudioSettingsDialog::CreateControls() {
 
 wxString AudioSettingsDialog::GetSoundApi() {  return m_snd_api;}
 unsigned int AudioSettingsDialog::GetSoundDeviceId() {  return m_snd_device;}
+bool AudioSettingsDialog::GetLowLatency() {  return m_lowLatency;}
+unsigned int AudioSettingsDialog::GetLowLatencyBufferFrames() {  return m_lowLatencyFrames;}
 
 // Override of transfer data to the window
 bool AudioSettingsDialog::TransferDataToWindow() {
@@ -204,6 +285,10 @@ bool AudioSettingsDialog::TransferDataToWindow() {
 // Override of transfer data from the window
 bool AudioSettingsDialog::TransferDataFromWindow() {
   m_snd_api = m_availableApis.Item(m_apiChoice->GetSelection());
+  m_lowLatency = m_lowLatencyCheck->GetValue();
+  unsigned long frames;
+  if (m_bufferChoice->GetStringSelection().ToULong(&frames))
+    m_lowLatencyFrames = frames;
   
   return true;
 }
@@ -261,6 +346,10 @@ void AudioSettingsDialog::OnDeviceChoice(wxCommandEvent& WXUNUSED(event)) {
   CheckIfOkCanBeEnabled();
 }
 
+void AudioSettingsDialog::OnLowLatencyCheck(wxCommandEvent& event) {
+  m_bufferChoice->Enable(event.IsChecked());
+}
+
 void AudioSettingsDialog::CheckIfOkCanBeEnabled() {
   wxButton *okButton = (wxButton*) FindWindow(wxID_OK);
   if ((m_apiChoice->GetSelection() != wxNOT_FOUND) && (m_deviceChoice->GetSelection() != wxNOT_FOUND)) {
@@ -28,7 +28,9 @@
 // Identifiers
 enum {
   ID_SOUND_API = wxID_HIGHEST + 570,
-  ID_SOUND_DEVICE = wxID_HIGHEST + 571
+  ID_SOUND_DEVICE = wxID_HIGHEST + 571,
+  ID_LOW_LATENCY = wxID_HIGHEST + 572,
+  ID_LOW_LATENCY_BUFFER = wxID_HIGHEST + 573
 };
 
 class AudioSettingsDialog : public wxDialog {
@@ -67,6 +69,8 @@ public:
   // Accessors
   wxString GetSoundApi();
   unsigned int GetSoundDeviceId();
+  bool GetLowLatency();
+  unsigned int GetLowLatencyBufferFrames();
   
     // Overrides
   bool TransferDataToWindow();
@@ -75,15 +79,22 @@ public:
 private:
   wxChoice *m_apiChoice;
   wxChoice *m_deviceChoice;
+  wxCheckBox *m_lowLatencyCheck;
+  wxChoice *m_bufferChoice;
   wxString m_snd_api;
   unsigned int m_snd_device;
   wxArrayString m_availableApis;
   wxArrayString m_availableDevices;
+  bool m_lowLatency;
+  unsigned int m_lowLatencyFrames;
+  wxArrayString m_bufferSizes;
+  wxString m_streamStatus;
   
   void UpdateAvailableDevices();
   wxString ConvertDeviceIdToString();
   void OnApiChoice(wxCommandEvent& event);
   void OnDeviceChoice(wxCommandEvent& event);
+  void OnLowLatencyCheck(wxCommandEvent& event);
   void CheckIfOkCanBeEnabled();
 
 };
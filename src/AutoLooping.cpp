@@ -19,6 +19,8 @@
  */
 
 #include "AutoLooping.h"
+#include "AnalysisCache.h"
+#include <wx/tokenzr.h>
 #include <cmath>
 
 AutoLooping::AutoLooping(
@@ -43,6 +45,70 @@ AutoLooping::~AutoLooping() {
 }
 
 bool AutoLooping::AutoFindLoops(
+  FileHandling *audioFile,
+  unsigned samplerate,
+  std::vector<std::pair<std::pair<unsigned, unsigned>, double> > &loops,
+  unsigned sustainStart,
+  unsigned sustainEnd,
+  std::vector<std::pair<unsigned, unsigned> > &loopsAlreadyInFile) {
+
+  // the result depends on all settings, the sustainsection and existing loops
+  // so they're all hashed together to form the key in the analysis cache
+  wxString settings = wxString::Format(
+    wxT("%.6f %.6f %.6f %.6f %u %u %u %d %u %u %u"),
+    m_derivativeThreshold,
+    m_minLoopDuration,
+    m_distanceBetweenLoops,
+    m_qualityFactor,
+    m_maxCandidates,
+    m_loopsToReturn,
+    m_maxLoopsMultiple,
+    (int) m_useBruteForce,
+    samplerate,
+    sustainStart,
+    sustainEnd
+  );
+  for (unsigned i = 0; i < loopsAlreadyInFile.size(); i++)
+    settings += wxString::Format(wxT(" %u:%u"), loopsAlreadyInFile[i].first, loopsAlreadyInFile[i].second);
+  wxScopedCharBuffer settingsBuffer = settings.utf8_str();
+  wxString key = wxT("Loops") + AnalysisCache::HashToString(AnalysisCache::HashData(settingsBuffer.data(), settingsBuffer.length()));
+
+  AnalysisCache cache(audioFile->GetFilePath(), audioFile->GetContentHash());
+  wxString cachedLoops;
+  if (cache.Read(key, &cachedLoops)) {
+    // stored as start:end:quality separated by spaces, empty if none found
+    wxStringTokenizer tokens(cachedLoops, wxT(" "));
+    while (tokens.HasMoreTokens()) {
+      wxString loop = tokens.GetNextToken();
+      unsigned long start, end;
+      double quality;
+      if (loop.BeforeFirst(wxT(':')).ToULong(&start) &&
+          loop.AfterFirst(wxT(':')).BeforeFirst(wxT(':')).ToULong(&end) &&
+          loop.AfterLast(wxT(':')).ToCDouble(&quality)) {
+        loops.push_back(std::make_pair(std::make_pair((unsigned) start, (unsigned) end), quality));
+      }
+    }
+    return !loops.empty();
+  }
+
+  unsigned loopsBefore = loops.size();
+  bool foundLoops = SearchForLoops(audioFile, samplerate, loops, sustainStart, sustainEnd, loopsAlreadyInFile);
+
+  wxString toStore;
+  if (foundLoops) {
+    for (unsigned i = loopsBefore; i < loops.size(); i++) {
+      if (!toStore.IsEmpty())
+        toStore += wxT(" ");
+      toStore += wxString::Format(wxT("%u:%u:"), loops[i].first.first, loops[i].first.second);
+      toStore += wxString::FromCDouble(loops[i].second, 12);
+    }
+  }
+  cache.Write(key, toStore);
+
+  return foundLoops;
+}
+
+bool AutoLooping::SearchForLoops(
   FileHandling *audioFile,
   unsigned samplerate,
   std::vector<std::pair<std::pair<unsigned, unsigned>, double> > &loops, 
@@ -79,6 +79,16 @@ private:
   unsigned m_loopsToReturn;      // 6
   unsigned m_maxLoopsMultiple;   // 10
   bool m_useBruteForce;
+
+  // the actual loop search, AutoFindLoops first checks the analysis cache
+  bool SearchForLoops(
+    FileHandling *audioFile,
+    unsigned samplerate,
+    std::vector<std::pair<std::pair<unsigned, unsigned>, double> > &loops,
+    unsigned sustainStart,
+    unsigned sustainEnd,
+    std::vector<std::pair<unsigned, unsigned> > &loopsAlreadyInFile
+  );
 };
 
 #endif
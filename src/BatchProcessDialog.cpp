@@ -25,12 +25,15 @@
 #include "CutNFadeDialog.h"
 #include "CrossfadeDialog.h"
 #include "ListInfoDialog.h"
+#include "SeamMetrics.h"
+#include "AnalysisCache.h"
 #include <wx/statline.h>
 #include <wx/listctrl.h>
 #include <wx/filename.h>
 #include <wx/dir.h>
 #include <wx/datetime.h>
 #include <wx/app.h>
+#include <wx/numdlg.h>
 #include <vector>
 #include <climits>
 #include <cmath>
@@ -87,6 +90,8 @@ void BatchProcessDialog::Init(AutoLoopDialog* autoloopSettings) {
   m_batchProcessesAvailable.Add(wxT("Cut & Fade in/out"));
   m_batchProcessesAvailable.Add(wxT("Crossfade all loops"));
   m_batchProcessesAvailable.Add(wxT("Set LIST INFO strings"));
+  m_batchProcessesAvailable.Add(wxT("List pitch stability over time"));
+  m_batchProcessesAvailable.Add(wxT("Snap loop ends to best match"));
 
   m_lastSource = wxEmptyString;
   m_lastTarget = wxEmptyString;
@@ -1430,12 +1435,118 @@ void BatchProcessDialog::OnRunBatch(wxCommandEvent& WXUNUSED(event)) {
 
     break;
 
+    case 23:
+      // This is for listing drift and variance of the pitch over the sustainsection to find unstable recordings
+      if (!filesToProcess.IsEmpty()) {
+        wxArrayString unstableFiles;
+        // a few cents is about what a careful listener starts to notice in a chord
+        double unstableCentsLimit = 3.0;
+        m_statusProgress->AppendText(m_sourceField->GetValue());
+        m_statusProgress->AppendText(wxT("\n"));
+        m_statusProgress->AppendText(wxT("\n"));
+
+        for (unsigned i = 0; i < filesToProcess.GetCount(); i++) {
+          m_statusProgress->AppendText(filesToProcess.Item(i));
+          m_statusProgress->AppendText(wxT("\n"));
+          FileHandling fh(filesToProcess.Item(i), m_sourceField->GetValue());
+          if (fh.FileCouldBeOpened()) {
+            PITCH_STABILITY stability;
+            if (fh.GetPitchStability(stability)) {
+              m_statusProgress->AppendText(wxString::Format(wxT("\tMean pitch = %.2f Hz\n"), stability.meanPitch));
+              m_statusProgress->AppendText(wxString::Format(wxT("\tDrift = %+.2f cent\n"), stability.driftCents));
+              m_statusProgress->AppendText(wxString::Format(wxT("\tDeviation = %.2f cent (%u windows)\n"), stability.centsStdDev, stability.points));
+              if (fabs(stability.driftCents) > unstableCentsLimit || stability.centsStdDev > unstableCentsLimit)
+                unstableFiles.Add(filesToProcess.Item(i));
+            } else {
+              m_statusProgress->AppendText(wxT("\tNo stable pitch could be detected!\n"));
+              unstableFiles.Add(filesToProcess.Item(i));
+            }
+          } else {
+            m_statusProgress->AppendText(wxT("\tCouldn't open file!\n"));
+          }
+          wxSafeYield();
+        }
+
+        if (!unstableFiles.IsEmpty()) {
+          m_statusProgress->AppendText(wxString::Format(wxT("\nFiles with drift or deviation above %.1f cent:\n"), unstableCentsLimit));
+          for (unsigned i = 0; i < unstableFiles.GetCount(); i++) {
+            m_statusProgress->AppendText(wxT("\t"));
+            m_statusProgress->AppendText(unstableFiles.Item(i));
+            m_statusProgress->AppendText(wxT("\n"));
+          }
+        }
+        m_statusProgress->AppendText(wxT("\nBatch process complete!\n\n"));
+      } else {
+        m_statusProgress->AppendText(wxT("No wav files to process!\n"));
+      }
+
+    break;
+
+    case 24:
+      // This is for moving the end of every loop to where its seam matches best
+      if (!filesToProcess.IsEmpty()) {
+        long radius = wxGetNumberFromUser(
+          wxT("Samples searched on each side of every loop end"),
+          wxT("Search radius"),
+          wxT("Snap loop ends to best match"),
+          SEAM_SEARCH_RADIUS,
+          10,
+          SEAM_SEARCH_MAX_RADIUS,
+          this
+        );
+
+        if (radius > 0) {
+          for (unsigned i = 0; i < filesToProcess.GetCount(); i++) {
+            m_statusProgress->AppendText(filesToProcess.Item(i));
+            m_statusProgress->AppendText(wxT("\n"));
+            FileHandling fh(filesToProcess.Item(i), m_sourceField->GetValue());
+            if (fh.FileCouldBeOpened()) {
+              m_statusProgress->AppendText(wxT("\tFile opened.\n"));
+              // the loops of the file are searched in parallel
+              std::vector<SEAM_MATCH> bestMatches;
+              FindBestSeamMatchesForAllLoops(&fh, true, (unsigned) radius, bestMatches);
+              for (unsigned j = 0; j < bestMatches.size(); j++) {
+                if (bestMatches[j].error < 0) {
+                  m_statusProgress->AppendText(wxString::Format(wxT("\tLoop %u: no valid loop end found\n"), j + 1));
+                  continue;
+                }
+                LOOPDATA currentLoop;
+                fh.m_loops->GetLoopData(j, currentLoop);
+                fh.m_loops->SetLoopPositions(currentLoop.dwStart, bestMatches[j].position, j);
+                m_statusProgress->AppendText(wxString::Format(
+                  wxT("\tLoop %u: end %u -> %lu, seam error %.5f\n"),
+                  j + 1,
+                  currentLoop.dwEnd,
+                  bestMatches[j].position,
+                  bestMatches[j].error
+                ));
+              }
+              fh.SaveAudioFile(filesToProcess.Item(i), m_targetField->GetValue());
+              m_statusProgress->AppendText(wxT("\tDone!\n"));
+            } else {
+              m_statusProgress->AppendText(wxT("\tCouldn't open file!\n"));
+            }
+            wxSafeYield();
+          }
+          m_statusProgress->AppendText(wxT("\nBatch process complete!\n\n"));
+        } else {
+          m_statusProgress->AppendText(wxT("\nBatch process aborted!\n"));
+        }
+      } else {
+        m_statusProgress->AppendText(wxT("No wav files to process!\n"));
+      }
+
+    break;
+
     default:
       // This should be impossible as well!
       m_statusProgress->AppendText(wxT("No process selected!\n"));
   }
   delete autoloop;
 
+  // the results of the whole job are written to the cache files at once
+  AnalysisCache::FlushAll();
+
   if (m_currentWorkingDir.IsSameAs(m_targetField->GetValue()))
     m_mustRefreshMainDir = true;
 }
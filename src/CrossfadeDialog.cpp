@@ -26,6 +26,7 @@ IMPLEMENT_CLASS(CrossfadeDialog, wxDialog )
 BEGIN_EVENT_TABLE(CrossfadeDialog, wxDialog)
   EVT_SLIDER(ID_FADEDURATION, CrossfadeDialog::OnFadedurationSlider)
   EVT_RADIOBOX(ID_FADEMETHOD, CrossfadeDialog::OnFademethodSelection)
+  EVT_CHECKBOX(ID_FADEAUDITION, CrossfadeDialog::OnAuditionCheck)
 END_EVENT_TABLE()
 
 CrossfadeDialog::CrossfadeDialog() {
@@ -51,6 +52,9 @@ void CrossfadeDialog::Init() {
   m_fademethods.Add(wxT("Equal power/gain"));
   m_fademethods.Add(wxT("Equal power (sin)"));
   selectedMethod = 0;
+  m_audition = true;
+  m_engine = NULL;
+  m_samplerate = 0;
 }
 
 bool CrossfadeDialog::Create( 
@@ -129,6 +133,18 @@ void CrossfadeDialog::CreateControls() {
   );
   secondRow->Add(durationSlider, 1, wxGROW|wxALL, 2);
 
+  // Checkbox for hearing the crossfade at the loop while it's playing
+  wxCheckBox *auditionCheck = new wxCheckBox(
+    this,
+    ID_FADEAUDITION,
+    wxT("Audition the crossfade while the loop is playing"),
+    wxDefaultPosition,
+    wxDefaultSize,
+    0
+  );
+  auditionCheck->SetValue(m_audition);
+  boxSizer->Add(auditionCheck, 0, wxALIGN_LEFT|wxALL, 5);
+
   // A horizontal line before the OK and Cancel buttons
   wxStaticLine *line = new wxStaticLine(
     this, 
@@ -181,6 +197,8 @@ bool CrossfadeDialog::TransferDataToWindow() {
   int value = (m_fadeduration * 1000);
   durationSl->SetValue(value);
 
+  UpdateAudition();
+
   return true;
 }
 
@@ -199,12 +217,37 @@ void CrossfadeDialog::OnFadedurationSlider(wxCommandEvent& WXUNUSED(event)) {
 
   double value = (double) durationSl->GetValue() / 1000.0;
   m_fadeduration = value;
+  UpdateAudition();
 }
 
 void CrossfadeDialog::OnFademethodSelection(wxCommandEvent& WXUNUSED(event)) {
   wxRadioBox *radioBox = (wxRadioBox*) FindWindow(ID_FADEMETHOD);
 
   selectedMethod = radioBox->GetSelection();
+  UpdateAudition();
+}
+
+void CrossfadeDialog::OnAuditionCheck(wxCommandEvent& event) {
+  m_audition = event.IsChecked();
+  UpdateAudition();
+}
+
+void CrossfadeDialog::SetAuditionEngine(PlaybackEngine *engine, unsigned samplerate) {
+  if (m_engine && m_engine != engine)
+    m_engine->SetCrossfade(0, 0);
+  m_engine = engine;
+  m_samplerate = samplerate;
+}
+
+void CrossfadeDialog::UpdateAudition() {
+  if (!m_engine)
+    return;
+
+  // the engine applies the fade at the loop seam without changing the file
+  if (m_audition)
+    m_engine->SetCrossfade((unsigned) (m_samplerate * m_fadeduration), selectedMethod);
+  else
+    m_engine->SetCrossfade(0, 0);
 }
 
 void CrossfadeDialog::SetCaption(wxString str) {
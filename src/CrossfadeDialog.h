@@ -22,11 +22,13 @@
 #define CROSSFADEDIALOG_H
 
 #include <wx/wx.h>
+#include "PlaybackEngine.h"
 
 // Identifiers
 enum {
   ID_FADEDURATION = wxID_HIGHEST + 500,
-  ID_FADEMETHOD = wxID_HIGHEST + 501
+  ID_FADEMETHOD = wxID_HIGHEST + 501,
+  ID_FADEAUDITION = wxID_HIGHEST + 502
 };
 
 class CrossfadeDialog : public wxDialog {
@@ -69,15 +71,23 @@ public:
   bool TransferDataToWindow();
   bool TransferDataFromWindow();
   void SetCaption(wxString str);
+  // Engine that plays the loop being crossfaded, NULL when not playing
+  void SetAuditionEngine(PlaybackEngine *engine, unsigned samplerate);
 
   // Event processing methods
   void OnFadedurationSlider(wxCommandEvent& event);
   void OnFademethodSelection(wxCommandEvent& event);
+  void OnAuditionCheck(wxCommandEvent& event);
 
 private:
   double m_fadeduration;  // in seconds (default 50 ms = 0.05, range 1 ms to 1000 ms)
   wxArrayString m_fademethods; // linear, equal power
   int selectedMethod; // index of fademethods linear = 0 as default
+  bool m_audition;
+  PlaybackEngine *m_engine;
+  unsigned m_samplerate;
+
+  void UpdateAudition();
 };
 
 
@@ -0,0 +1,213 @@
+/*
+ * DiskStream.cpp is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#include "DiskStream.h"
+#include <algorithm>
+
+class DiskStreamReader : public wxThread {
+public:
+  DiskStreamReader(DiskStream *stream) : wxThread(wxTHREAD_JOINABLE), m_stream(stream) {}
+
+protected:
+  virtual ExitCode Entry() {
+    m_stream->ReaderLoop();
+    return (ExitCode) 0;
+  }
+
+private:
+  DiskStream *m_stream;
+};
+
+DiskStream::DiskStream(wxString filePath, unsigned channels, unsigned long frames) :
+  m_file(std::string(filePath.mb_str())),
+  m_channels(channels),
+  m_frames(frames),
+  m_reader(NULL),
+  m_stop(false),
+  m_readFrame(0),
+  m_writeFrame(0),
+  m_requestPosition(0),
+  m_requestLoop(0),
+  m_requestLooping(false),
+  m_requestLead(0),
+  m_requestGeneration(0),
+  m_readyGeneration(0),
+  m_position(0),
+  m_filePosition(0),
+  m_loopStart(0),
+  m_loopEnd(0),
+  m_looping(false),
+  m_lead(0),
+  m_pinnedStart(1),
+  m_pinnedEnd(0) {
+  // the file must still be what was loaded
+  if (!m_file || m_file.channels() != (int) m_channels || (unsigned long) m_file.frames() < m_frames)
+    return;
+
+  m_buffer.assign(DISKSTREAM_BUFFER_FRAMES * m_channels, 0.0f);
+
+  DiskStreamReader *reader = new DiskStreamReader(this);
+  if (reader->Run() == wxTHREAD_NO_ERROR)
+    m_reader = reader;
+  else
+    delete reader;
+}
+
+DiskStream::~DiskStream() {
+  m_stop.store(true);
+  if (m_reader) {
+    m_reader->Wait();
+    delete m_reader;
+  }
+}
+
+bool DiskStream::IsOk() {
+  return m_reader != NULL;
+}
+
+void DiskStream::Restart(unsigned long position, unsigned long loopStart, unsigned long loopEnd, bool looping, unsigned long lead) {
+  m_requestPosition.store(position);
+  m_requestLoop.store(((unsigned long long) loopStart << 32) | loopEnd);
+  m_requestLooping.store(looping);
+  m_requestLead.store(lead);
+  m_requestGeneration.store(m_requestGeneration.load() + 1);
+}
+
+unsigned long DiskStream::Available() {
+  if (m_readyGeneration.load() != m_requestGeneration.load())
+    return 0;
+  return m_writeFrame.load() - m_readFrame.load();
+}
+
+const float* DiskStream::Peek(unsigned long &frames) {
+  unsigned long available = Available();
+  if (frames > available)
+    frames = available;
+
+  unsigned long index = m_readFrame.load() % DISKSTREAM_BUFFER_FRAMES;
+  if (frames > DISKSTREAM_BUFFER_FRAMES - index)
+    frames = DISKSTREAM_BUFFER_FRAMES - index;
+
+  return &m_buffer[index * m_channels];
+}
+
+void DiskStream::Consume(unsigned long frames) {
+  // the reader empties the buffer itself when restarting
+  if (m_readyGeneration.load() != m_requestGeneration.load())
+    return;
+  m_readFrame.store(m_readFrame.load() + frames);
+}
+
+const float* DiskStream::GetPinnedFrames(unsigned long frame) {
+  // the pinned frames only change while nothing is available
+  if (Available() == 0 || frame < m_pinnedStart || frame > m_pinnedEnd)
+    return NULL;
+  return &m_pinnedLoop[(frame - m_pinnedStart) * m_channels];
+}
+
+void DiskStream::ReaderLoop() {
+  while (!m_stop.load()) {
+    unsigned requested = m_requestGeneration.load();
+    if (requested != m_readyGeneration.load())
+      TakeRequest(requested);
+
+    if (Produce() == 0)
+      wxMilliSleep(5);
+  }
+}
+
+void DiskStream::TakeRequest(unsigned generation) {
+  m_position = m_requestPosition.load();
+  unsigned long long loop = m_requestLoop.load();
+  m_loopStart = (unsigned long) (loop >> 32);
+  m_loopEnd = (unsigned long) (loop & 0xFFFFFFFFULL);
+  m_looping = m_requestLooping.load() && m_loopEnd >= m_loopStart;
+  m_lead = m_requestLead.load();
+  if (m_lead > m_loopStart)
+    m_lead = m_loopStart;
+
+  // the callback doesn't read while waiting for the request to be ready
+  m_readFrame.store(m_writeFrame.load());
+
+  if (m_looping)
+    PinLoop();
+
+  m_readyGeneration.store(generation);
+}
+
+void DiskStream::PinLoop() {
+  unsigned long start = m_loopStart - m_lead;
+  unsigned long end = m_loopEnd < m_frames ? m_loopEnd : m_frames - 1;
+  if (m_loopStart >= m_frames || (m_pinnedStart == start && m_pinnedEnd == end))
+    return;
+
+  unsigned long length = end - start + 1;
+  m_pinnedLoop.assign(length * m_channels, 0.0f);
+  m_file.seek(start, SEEK_SET);
+  m_file.readf(&m_pinnedLoop[0], length);
+  m_filePosition = start + length;
+  m_pinnedStart = start;
+  m_pinnedEnd = end;
+}
+
+unsigned long DiskStream::Produce() {
+  unsigned long write = m_writeFrame.load();
+  unsigned long space = DISKSTREAM_BUFFER_FRAMES - (write - m_readFrame.load());
+  if (space == 0)
+    return 0;
+
+  // the same order of frames as the playback engine plays them
+  if (m_looping && m_position > m_loopEnd)
+    m_position = m_loopStart;
+  if (m_position >= m_frames)
+    return 0;
+
+  unsigned long span = m_frames - m_position;
+  if (m_looping && m_loopEnd + 1 - m_position < span)
+    span = m_loopEnd + 1 - m_position;
+  if (span > space)
+    span = space;
+  if (span > DISKSTREAM_READ_FRAMES)
+    span = DISKSTREAM_READ_FRAMES;
+  unsigned long index = write % DISKSTREAM_BUFFER_FRAMES;
+  if (span > DISKSTREAM_BUFFER_FRAMES - index)
+    span = DISKSTREAM_BUFFER_FRAMES - index;
+
+  float *dest = &m_buffer[index * m_channels];
+  if (m_looping && m_position >= m_pinnedStart && m_position + span - 1 <= m_pinnedEnd) {
+    const float *source = &m_pinnedLoop[(m_position - m_pinnedStart) * m_channels];
+    std::copy(source, source + span * m_channels, dest);
+  } else {
+    if (m_filePosition != m_position) {
+      m_file.seek(m_position, SEEK_SET);
+      m_filePosition = m_position;
+    }
+    sf_count_t got = m_file.readf(dest, span);
+    if (got < 0)
+      got = 0;
+    if ((unsigned long) got < span)
+      std::fill(dest + got * m_channels, dest + span * m_channels, 0.0f);
+    m_filePosition += got;
+  }
+
+  m_position += span;
+  m_writeFrame.store(write + span);
+  return span;
+}
@@ -0,0 +1,102 @@
+/*
+ * DiskStream.h is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#ifndef DISKSTREAM_H
+#define DISKSTREAM_H
+
+#include <wx/wx.h>
+#include <wx/thread.h>
+#include <sndfile.hh>
+#include <atomic>
+#include <vector>
+
+// Size of the read ahead buffer in frames
+#define DISKSTREAM_BUFFER_FRAMES 131072
+// Largest number of frames read from the file at a time
+#define DISKSTREAM_READ_FRAMES 8192
+
+class DiskStreamReader;
+
+/*
+ * DiskStream reads audio for playback from the file on a background thread
+ * into a single producer, single consumer ring buffer. The reader produces
+ * exactly the frames the playback engine will play, wrapping at the loop
+ * end, and the whole loop is kept in memory so the wrap never waits for the
+ * disk. A lead of frames before the loop start can be kept in memory too
+ * for the engine to crossfade with.
+ *
+ * Restart(), Available(), Peek(), Consume() and GetPinnedFrames() are only
+ * called from the audio callback. When a restart has been requested nothing is available until the
+ * reader has taken the request and emptied the buffer.
+ */
+class DiskStream {
+public:
+  DiskStream(wxString filePath, unsigned channels, unsigned long frames);
+  ~DiskStream();
+
+  bool IsOk();
+
+  void Restart(unsigned long position, unsigned long loopStart, unsigned long loopEnd, bool looping, unsigned long lead = 0);
+  unsigned long Available();
+  // Contiguous frames ready to be played, at most frames which is updated
+  const float* Peek(unsigned long &frames);
+  void Consume(unsigned long frames);
+  // The kept loop and lead from frame on, NULL if frame isn't kept
+  const float* GetPinnedFrames(unsigned long frame);
+
+  void ReaderLoop();
+
+private:
+  SndfileHandle m_file;
+  unsigned m_channels;
+  unsigned long m_frames;
+  DiskStreamReader *m_reader;
+  std::atomic<bool> m_stop;
+
+  std::vector<float> m_buffer;
+  std::atomic<unsigned long> m_readFrame; // only increasing, modulo the buffer size
+  std::atomic<unsigned long> m_writeFrame;
+
+  // the request is written before the generation is increased
+  std::atomic<unsigned long> m_requestPosition;
+  std::atomic<unsigned long long> m_requestLoop; // start in the high and end in the low 32 bits
+  std::atomic<bool> m_requestLooping;
+  std::atomic<unsigned long> m_requestLead;
+  std::atomic<unsigned> m_requestGeneration;
+  std::atomic<unsigned> m_readyGeneration;
+
+  // only used by the reader thread
+  unsigned long m_position;
+  unsigned long m_filePosition;
+  unsigned long m_loopStart;
+  unsigned long m_loopEnd;
+  bool m_looping;
+  unsigned long m_lead;
+  std::vector<float> m_pinnedLoop;
+  unsigned long m_pinnedStart;
+  unsigned long m_pinnedEnd;
+
+  void TakeRequest(unsigned generation);
+  void PinLoop();
+  unsigned long Produce();
+
+};
+
+#endif
@@ -40,15 +40,23 @@
 */
 
 #include <wx/intl.h>
+#include <wx/thread.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include <math.h>
+#include <map>
+#include <vector>
 
 #include "FFT.h"
 
 int **gFFTBitTable = NULL;
 const int MaxFastBits = 16;
 
+/* Cached window tables and float twiddle tables, guarded by gFFTTablesLock */
+static std::map<std::pair<int, int>, std::vector<double> > gWindowTables;
+static std::map<int, std::vector<float> > gTwiddleTables;
+static wxCriticalSection gFFTTablesLock;
+
 /* Declare Static functions */
 static int IsPowerOfTwo(int x);
 static int NumberOfBitsNeeded(int PowerOfTwo);
@@ -92,30 +100,45 @@ int ReverseBits(int index, int NumBits)
    return rev;
 }
 
+/*
+ * Builds the bit reversal table the first time, taking the lock also when
+ * it's already built so that every thread sees the complete table
+ */
 void InitFFT()
 {
-   gFFTBitTable = new int *[MaxFastBits];
+   wxCriticalSectionLocker locker(gFFTTablesLock);
+   if (gFFTBitTable)
+      return;
+
+   int **table = new int *[MaxFastBits];
 
    int len = 2;
    for (int b = 1; b <= MaxFastBits; b++) {
 
-      gFFTBitTable[b - 1] = new int[len];
+      table[b - 1] = new int[len];
 
       for (int i = 0; i < len; i++)
-         gFFTBitTable[b - 1][i] = ReverseBits(i, b);
+         table[b - 1][i] = ReverseBits(i, b);
 
       len <<= 1;
    }
+
+   /* only publish the table when it's complete */
+   gFFTBitTable = table;
 }
 
 void DeinitFFT()
 {
+   wxCriticalSectionLocker locker(gFFTTablesLock);
    if (gFFTBitTable) {
       for (int b = 1; b <= MaxFastBits; b++) {
          delete[] gFFTBitTable[b-1];
       }
       delete[] gFFTBitTable;
+      gFFTBitTable = NULL;
    }
+   gWindowTables.clear();
+   gTwiddleTables.clear();
 }
 
 inline int FastReverseBits(int i, int NumBits)
@@ -146,8 +169,8 @@ void FFT(int NumSamples,
       exit(1);
    }
 
-   if (!gFFTBitTable)
-      InitFFT();
+   /* checked under the lock since the workers can get here at the same time */
+   InitFFT();
 
    if (!InverseTransform)
       angle_numerator = -angle_numerator;
@@ -372,6 +395,153 @@ void PowerSpectrum(int NumSamples, double *In, double *Out)
    delete[]ImagOut;
 }
 
+/*
+ * Twiddle factors for a forward complex FFT of size NumSamples.
+ * The factors for the stage with half block size m are stored
+ * contiguously from index m - 1, real parts first then imaginary
+ * parts from index NumSamples - 1.
+ */
+
+static const float *GetTwiddleTable(int NumSamples)
+{
+   wxCriticalSectionLocker locker(gFFTTablesLock);
+
+   std::map<int, std::vector<float> >::iterator it = gTwiddleTables.find(NumSamples);
+   if (it != gTwiddleTables.end())
+      return &it->second[0];
+
+   std::vector<float> &table = gTwiddleTables[NumSamples];
+   table.resize(2 * NumSamples);
+   for (int m = 1; m < NumSamples; m <<= 1) {
+      for (int n = 0; n < m; n++) {
+         table[m - 1 + n] = (float) cos(-M_PI * n / m);
+         table[NumSamples - 1 + m - 1 + n] = (float) sin(-M_PI * n / m);
+      }
+   }
+   return &table[0];
+}
+
+/*
+ * Forward complex FFT in single precision
+ */
+
+static void FFTFloat(int NumSamples,
+                     float *RealIn, float *ImagIn, float *RealOut, float *ImagOut)
+{
+   int NumBits;
+   int i, j, n;
+   int BlockEnd;
+
+   /* checked under the lock since the workers can get here at the same time */
+   InitFFT();
+
+   NumBits = NumberOfBitsNeeded(NumSamples);
+
+   for (i = 0; i < NumSamples; i++) {
+      j = FastReverseBits(i, NumBits);
+      RealOut[j] = RealIn[i];
+      ImagOut[j] = ImagIn[i];
+   }
+
+   const float *twiddles = GetTwiddleTable(NumSamples);
+
+   for (BlockEnd = 1; BlockEnd < NumSamples; BlockEnd <<= 1) {
+      const float *wr = twiddles + BlockEnd - 1;
+      const float *wi = twiddles + NumSamples - 1 + BlockEnd - 1;
+
+      for (i = 0; i < NumSamples; i += 2 * BlockEnd) {
+         float *re0 = RealOut + i;
+         float *im0 = ImagOut + i;
+         float *re1 = re0 + BlockEnd;
+         float *im1 = im0 + BlockEnd;
+
+         /* no loop carried dependency so this loop vectorizes */
+         for (n = 0; n < BlockEnd; n++) {
+            float tr = wr[n] * re1[n] - wi[n] * im1[n];
+            float ti = wr[n] * im1[n] + wi[n] * re1[n];
+
+            re1[n] = re0[n] - tr;
+            im1[n] = im0[n] - ti;
+
+            re0[n] += tr;
+            im0[n] += ti;
+         }
+      }
+   }
+}
+
+void PowerSpectrum(int NumSamples, float *In, float *Out)
+{
+   int Half = NumSamples / 2;
+   int i;
+
+   if (!IsPowerOfTwo(NumSamples) || NumSamples > MaxFloatFFTSize) {
+      fprintf(stderr, "%d is not a valid single precision FFT size\n", NumSamples);
+      exit(1);
+   }
+
+   double theta = M_PI / Half;
+
+   /* one allocation for all the temporary arrays */
+   float *scratch = new float[4 * Half];
+   float *tmpReal = scratch;
+   float *tmpImag = scratch + Half;
+   float *RealOut = scratch + 2 * Half;
+   float *ImagOut = scratch + 3 * Half;
+
+   for (i = 0; i < Half; i++) {
+      tmpReal[i] = In[2 * i];
+      tmpImag[i] = In[2 * i + 1];
+   }
+
+   FFTFloat(Half, tmpReal, tmpImag, RealOut, ImagOut);
+
+   /* the recurrence is kept in double so it doesn't drift */
+   double wtemp = double (sin(0.5 * theta));
+
+   double wpr = -2.0 * wtemp * wtemp;
+   double wpi = -1.0 * double (sin(theta));
+   double wr = 1.0 + wpr;
+   double wi = wpi;
+
+   int i3;
+
+   float h1r, h1i, h2r, h2i, rt, it;
+
+   for (i = 1; i < Half / 2; i++) {
+
+      i3 = Half - i;
+
+      h1r = 0.5f * (RealOut[i] + RealOut[i3]);
+      h1i = 0.5f * (ImagOut[i] - ImagOut[i3]);
+      h2r = 0.5f * (ImagOut[i] + ImagOut[i3]);
+      h2i = -0.5f * (RealOut[i] - RealOut[i3]);
+
+      rt = h1r + wr * h2r - wi * h2i;
+      it = h1i + wr * h2i + wi * h2r;
+
+      Out[i] = rt * rt + it * it;
+
+      rt = h1r - wr * h2r + wi * h2i;
+      it = -h1i + wr * h2i + wi * h2r;
+
+      Out[i3] = rt * rt + it * it;
+
+      wr = (wtemp = wr) * wpr - wi * wpi + wr;
+      wi = wi * wpr + wtemp * wpi + wi;
+   }
+
+   rt = (h1r = RealOut[0]) + ImagOut[0];
+   it = h1r - ImagOut[0];
+   Out[0] = rt * rt + it * it;
+
+   rt = RealOut[Half / 2];
+   it = ImagOut[Half / 2];
+   Out[Half / 2] = rt * rt + it * it;
+
+   delete[]scratch;
+}
+
 /*
  * Windowing Functions
  */
@@ -485,6 +655,22 @@ void WindowFunc(int whichFunction, int NumSamples, double *in)
    }
 }
 
+const double *GetWindow(int whichFunction, int NumSamples)
+{
+   wxCriticalSectionLocker locker(gFFTTablesLock);
+
+   std::pair<int, int> key(whichFunction, NumSamples);
+   std::map<std::pair<int, int>, std::vector<double> >::iterator it = gWindowTables.find(key);
+   if (it != gWindowTables.end())
+      return &it->second[0];
+
+   std::vector<double> &table = gWindowTables[key];
+   table.assign(NumSamples, 1.0);
+   if (whichFunction > 0)
+      WindowFunc(whichFunction, NumSamples, &table[0]);
+   return &table[0];
+}
+
 // Indentation settings for Vim and Emacs and unique identifier for Arch, a
 // version control system. Please do not modify past this point.
 //
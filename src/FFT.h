@@ -64,6 +64,17 @@
 
 void PowerSpectrum(int NumSamples, double *In, double *Out);
 
+/*
+ * Single precision version of PowerSpectrum for interactive use
+ * where throughput matters more than accuracy. The twiddle factors
+ * are precomputed per size so the butterflies vectorize. Only use
+ * it for NumSamples up to MaxFloatFFTSize.
+ */
+
+#define MaxFloatFFTSize 16384
+
+void PowerSpectrum(int NumSamples, float *In, float *Out);
+
 /*
  * Computes an FFT when the input data is real but you still
  * want complex data as output.  The output arrays are the
@@ -101,6 +112,14 @@ void FFT(int NumSamples,
 
 void WindowFunc(int whichFunction, int NumSamples, double *data);
 
+/*
+ * Returns a cached table with the coefficients of a window function
+ * (0 gives all ones). The table is calculated on first request for
+ * each (function, size) and stays valid until DeinitFFT is called.
+ */
+
+const double *GetWindow(int whichFunction, int NumSamples);
+
 /*
  * Returns the name of the windowing function (for UI display)
  */
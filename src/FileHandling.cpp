@@ -20,11 +20,23 @@
 
 #include "FileHandling.h"
 #include "FFT.h"
+#include "AnalysisCache.h"
+#include "WaveformSummary.h"
+#include "ZeroCrossingIndex.h"
 #include <cfloat>
+#include <algorithm>
 
-FileHandling::FileHandling(wxString fileName, wxString path) : m_loops(NULL), m_cues(NULL), shortAudioData(NULL), intAudioData(NULL), floatAudioData(NULL), doubleAudioData(NULL), fileOpenWasSuccessful(false), m_fftPitch(0), m_fftHPS(0), m_timeDomainPitch(0), m_autoSustainStart(0),
-m_autoSustainEnd(0), m_sliderSustainStart(0), m_sliderSustainEnd(0) {
+// Keys of cached analysis results end with a version that is raised when the algorithm changes what it returns
+#define TD_PITCH_CACHE_KEY wxT("TDPitchV2")
+#define PITCH_STABILITY_CACHE_KEY wxT("PitchStabilityV1")
+
+unsigned FileHandling::m_streamingThreshold = 256;
+unsigned FileHandling::m_defaultHPSHarmonics = 5;
+
+FileHandling::FileHandling(wxString fileName, wxString path) : m_loops(NULL), m_cues(NULL), shortAudioData(NULL), intAudioData(NULL), floatAudioData(NULL), doubleAudioData(NULL), fileOpenWasSuccessful(false), m_fftPitch(0), m_fftHPS(0), m_hpsHarmonics(m_defaultHPSHarmonics), m_timeDomainPitch(0), m_autoSustainStart(0),
+m_autoSustainEnd(0), m_autoSustainIsKnown(false), m_sliderSustainStart(0), m_sliderSustainEnd(0), m_strongestChannel(-1), m_summary(NULL), m_zeroCrossings(NULL) {
   m_fileName = fileName;
+  m_filePath = path;
   m_loops = new LoopMarkers();
   m_cues = new CueMarkers();
   wxString filePath;
@@ -130,27 +142,34 @@ m_autoSustainEnd(0), m_sliderSustainStart(0), m_sliderSustainEnd(0) {
       // remember to "rewind" file before read
       sfHandle.seek(0, SEEK_SET);
 
+      unsigned long frames = ArrayLength / m_channels;
       for (int i = 0; i < m_channels; i++) {
         WAVETRACK track;
         waveTracks.push_back(track);
+        waveTracks[i].waveData.resize(frames);
       }
-      double *buffer = new double[ArrayLength];
-      sfHandle.read(buffer, ArrayLength);
 
-      int index = 0;
-      for (unsigned i = 0; i < ArrayLength; i++) {
-        // de-interleaving
-        waveTracks[index].waveData.push_back(buffer[i]);
-        index++;
-
-        if (index == m_channels)
-          index = 0;
+      // read and de-interleave a block at a time instead of keeping a second copy of everything
+      std::vector<double> buffer(FILEHANDLING_DECODE_FRAMES * m_channels);
+      unsigned long done = 0;
+      while (done < frames) {
+        sf_count_t got = sfHandle.readf(&buffer[0], std::min((unsigned long) FILEHANDLING_DECODE_FRAMES, frames - done));
+        if (got <= 0)
+          break;
+        for (int ch = 0; ch < m_channels; ch++) {
+          double *dest = &waveTracks[ch].waveData[done];
+          for (sf_count_t i = 0; i < got; i++)
+            dest[i] = buffer[i * m_channels + ch];
+        }
+        done += got;
       }
-      delete[] buffer;
       
-      if (m_minorFormat != SF_FORMAT_FLOAT) {
+      bool streamed = m_streamingThreshold > 0 &&
+        (ArrayLength * sizeof(float)) / (1024 * 1024) >= m_streamingThreshold;
+      if (m_minorFormat != SF_FORMAT_FLOAT && !streamed) {
         // if the format is something else than floats we also need data as
-        // floats for audio playback reasons
+        // floats for audio playback reasons, unless it's big enough to be
+        // streamed from the file instead
         sfHandle.seek(0, SEEK_SET);
         floatAudioData = new float[ArrayLength];
         sfHandle.read(floatAudioData, ArrayLength);
@@ -191,19 +210,24 @@ m_autoSustainEnd(0), m_sliderSustainStart(0), m_sliderSustainEnd(0) {
       m_info.creation_date = wxDateTime::Now();
     }
     
-    // Auto calculate the sustainsection too
-    if (fileOpenWasSuccessful)
-      CalculateSustainStartAndEnd();
-    
     // set a default, this will be set when the file is already opened from MyFrame
     m_useAutoSustain = true;
 
+    // quick results are cached for the file as it is on disk
+    if (fileOpenWasSuccessful)
+      m_fileStamp = AnalysisCache::GetFileStamp(filePath);
+
   } else { // if file open didn't succeed we make a note of that
     fileOpenWasSuccessful = false;
   }
 }
 
 FileHandling::~FileHandling() {
+  // stops the summary from reading the wave data
+  delete m_summary;
+
+  delete m_zeroCrossings;
+
   delete m_loops;
 
   delete m_cues;
@@ -300,6 +324,7 @@ int FileHandling::GetSampleRate() {
 
 void FileHandling::SetSampleRate(unsigned s_rate) {
   m_samplerate = s_rate;
+  InvalidateAnalysis();
 }
 
 int FileHandling::GetAudioFormat() {
@@ -319,10 +344,21 @@ bool FileHandling::FileCouldBeOpened() {
 }
 
 bool FileHandling::GetFFTPitch(double pitches[]) {
+  AnalysisCache cache(m_filePath, GetContentHash());
+  wxString key = wxString::Format(wxT("FFTPitchH%u"), m_hpsHarmonics);
+  if (cache.Read(key, &m_fftPitch) && cache.Read(key + wxT("HPS"), &m_fftHPS)) {
+    pitches[0] = m_fftPitch;
+    pitches[1] = m_fftHPS;
+
+    return true;
+  }
+
   bool gotPitch = DetectPitchByFFT();
   if (gotPitch) {
     pitches[0] = m_fftPitch;
     pitches[1] = m_fftHPS;
+    cache.Write(key, m_fftPitch);
+    cache.Write(key + wxT("HPS"), m_fftHPS);
 
     return true;
   } else
@@ -333,8 +369,9 @@ bool FileHandling::GetFFTPitch(double pitches[]) {
  * GetSpectrum needs an array of doubles that is the size of (fftSize / 2) for the total output in dB for each bin
  * fftSize must be a power of 2
  * windowType must be in range 0 to 9
+ * allowSinglePrecision lets sizes up to MaxFloatFFTSize use the faster float FFT, use it for display only
  */
-bool FileHandling::GetSpectrum(double *outInDb, unsigned fftSize, int windowType) {
+bool FileHandling::GetSpectrum(double *outInDb, unsigned fftSize, int windowType, bool allowSinglePrecision) {
   if (!waveTracks.empty()) {
     unsigned numberOfSamples = waveTracks[0].waveData.size();
     if (fftSize > numberOfSamples) {
@@ -343,21 +380,13 @@ bool FileHandling::GetSpectrum(double *outInDb, unsigned fftSize, int windowType
 
     unsigned nbrWindows = 0;
     unsigned halfFFTsize = fftSize / 2;
-    double *input = new double[fftSize];
-    double *output = new double[fftSize];
     double *fftData = new double[fftSize];
-    double *window = new double[fftSize];
 
-    for (unsigned i = 0; i < fftSize; i++) {
-      input[i] = 0.0f;
-      output[i] = 0.0f;
+    for (unsigned i = 0; i < fftSize; i++)
       fftData[i] = 0.0f;
-      window[i] = 1.0f;
-    }
 
-    // Create a window that will be applied to the in data later
-    if (windowType > 0)
-      WindowFunc(windowType, fftSize, window);
+    // The window that will be applied to the in data is only calculated once for each type and size
+    const double *window = GetWindow(windowType, fftSize);
 
     // Scale window so an amplitude of 1.0 equals to 0 dB
     double winScale = 0;
@@ -368,24 +397,61 @@ bool FileHandling::GetSpectrum(double *outInDb, unsigned fftSize, int windowType
     else
       winScale = 1.0;
 
-    for (unsigned i = 0; i < waveTracks.size(); i++) {
-      unsigned currentStartIdx = 0;
-      while (currentStartIdx + fftSize < waveTracks[i].waveData.size()) {
-        // Fill this input window with audio data from current channel
-        for (unsigned j = 0; j < fftSize; j++) {
-          input[j] = window[j] * waveTracks[i].waveData[currentStartIdx + j];
+    if (allowSinglePrecision && fftSize <= MaxFloatFFTSize) {
+      float *input = new float[fftSize];
+      float *output = new float[fftSize];
+
+      for (unsigned i = 0; i < waveTracks.size(); i++) {
+        const double *data = &waveTracks[i].waveData[0];
+        unsigned currentStartIdx = 0;
+        while (currentStartIdx + fftSize < waveTracks[i].waveData.size()) {
+          for (unsigned j = 0; j < fftSize; j++)
+            input[j] = (float) (window[j] * data[currentStartIdx + j]);
+
+          PowerSpectrum(fftSize, input, output);
+
+          // the sum over all windows is kept in double precision
+          for (unsigned j = 0; j < halfFFTsize; j++)
+            fftData[j] += output[j];
+
+          currentStartIdx += halfFFTsize;
+          nbrWindows++;
         }
+      }
+
+      delete[] input;
+      delete[] output;
+    } else {
+      double *input = new double[fftSize];
+      double *output = new double[fftSize];
 
-        // Perform the FFT
-        PowerSpectrum(fftSize, input, output);
+      for (unsigned i = 0; i < waveTracks.size(); i++) {
+        unsigned currentStartIdx = 0;
+        while (currentStartIdx + fftSize < waveTracks[i].waveData.size()) {
+          // Fill this input window with audio data from current channel
+          for (unsigned j = 0; j < fftSize; j++) {
+            input[j] = window[j] * waveTracks[i].waveData[currentStartIdx + j];
+          }
 
-        for (unsigned j = 0; j < halfFFTsize; j++)
-          fftData[j] += output[j];
+          // Perform the FFT
+          PowerSpectrum(fftSize, input, output);
 
-        // Overlap each window 50%
-        currentStartIdx += halfFFTsize;
-        nbrWindows++;
+          for (unsigned j = 0; j < halfFFTsize; j++)
+            fftData[j] += output[j];
+
+          // Overlap each window 50%
+          currentStartIdx += halfFFTsize;
+          nbrWindows++;
+        }
       }
+
+      delete[] input;
+      delete[] output;
+    }
+
+    if (nbrWindows == 0) {
+      delete[] fftData;
+      return false;
     }
 
     double scale = winScale / (double) nbrWindows;
@@ -398,10 +464,7 @@ bool FileHandling::GetSpectrum(double *outInDb, unsigned fftSize, int windowType
         outInDb[i] = -145;
     }
 
-    delete[] input;
-    delete[] output;
     delete[] fftData;
-    delete[] window;
     return true;
   } else {
     return false;
@@ -536,76 +599,48 @@ bool FileHandling::DetectPitchByFFT() {
     }
     m_fftPitch = allPeaks[possibleF0].m_pitch;
 
-    // now try detecting pitch with HPS using 5 harmonics
+    // now try detecting pitch with HPS, the spectrum is already in dB so the
+    // product of the harmonics becomes a sum which cannot underflow
+    unsigned hpsLength = CalculateLogHPS(pwrSpec, halfSize);
+    const double *hps = hpsLength ? &m_hpsSpectrum[0] : NULL;
     unsigned maxBin = 0;
-    double *original = new double[halfSize];
-    double *downSampled = new double[halfSize];
-    double *hps = new double[halfSize];
 
-    for (unsigned i = 0; i < halfSize; i++) {
-      original[i] = pow(10, (pwrSpec[i] / 10));
-      hps[i] = original[i];
-    }
-
-    for (unsigned i = 2; i < 6; i++) {
-      for (unsigned j = 0; j < halfSize; j++)
-        downSampled[j] = 0;
-      for (unsigned j = 0; j < halfSize / i; j++)
-        downSampled[j] = original[j * i];
-      for (unsigned j = 0; j < halfSize; j++)
-        hps[j] *= downSampled[j];
-    }
-
-    for (unsigned i = 0; i < halfSize; i++) {
+    for (unsigned i = 0; i < hpsLength; i++) {
       if (hps[i] > hps[maxBin])
         maxBin = i;
     }
 
-    double hpsSum = 0;
-	double hpsAverage = 0;
-    for (unsigned i = 0; i < maxBin; i++) {
-      hpsSum += hps[i];
-    }
-    hpsAverage = hpsSum / maxBin;
-
-    // try fixing possible lower fundamental errors
-    // get first peak below that's at least twice above the average value
-    int correctMaxBin = 0;
-    bool alternativeFound = false;
-    for (unsigned i = 1; i < maxBin; i++) {
-      if ((hps[i] > hps[i - 1]) && hps[i] > hps[i + 1]) {
-        if (hps[i] > hpsAverage * 2) {
-          alternativeFound = true;
-          correctMaxBin = i;
-          break;
+    if (maxBin > 0) {
+      // the average is taken of the linear values, relative to the max bin
+      double hpsSum = 0;
+      for (unsigned i = 0; i < maxBin; i++) {
+        hpsSum += pow(10, ((hps[i] - hps[maxBin]) / 10.0));
+      }
+      double hpsAverageDb = hps[maxBin] + 10 * log10(hpsSum / maxBin);
+
+      // try fixing possible lower fundamental errors
+      // get first peak below that's at least twice above the average value
+      double thresholdDb = hpsAverageDb + 10 * log10(2.0);
+      for (unsigned i = 1; i < maxBin; i++) {
+        if ((hps[i] > hps[i - 1]) && hps[i] > hps[i + 1]) {
+          if (hps[i] > thresholdDb) {
+            maxBin = i;
+            break;
+          }
         }
       }
     }
 
-    if (alternativeFound)
-      maxBin = correctMaxBin;
-
-    m_fftHPS = TranslateIndexToPitch(
-      maxBin,
-      original[maxBin - 1],
-      original[maxBin],
-      original[maxBin + 1],
-      fftSize
-    );
-
-    if (original) {
-      delete[] original;
-      original = NULL;
-    }
-
-    if (downSampled) {
-      delete[] downSampled;
-      downSampled = NULL;
-    }
-
-    if (hps) {
-      delete[] hps;
-      hps = NULL;
+    if (maxBin > 0 && maxBin + 1 < halfSize) {
+      m_fftHPS = TranslateIndexToPitch(
+        maxBin,
+        pow(10, (pwrSpec[maxBin - 1] / 10)),
+        pow(10, (pwrSpec[maxBin] / 10)),
+        pow(10, (pwrSpec[maxBin + 1] / 10)),
+        fftSize
+      );
+    } else {
+      m_fftHPS = 0;
     }
 
     if (pwrSpec) {
@@ -641,6 +676,92 @@ double FileHandling::TranslateIndexToPitch(
   return pitchToReturn;
 }
 
+/*
+ * Adds every stride:th bin of the log spectrum to the hps array. The stride is
+ * a template parameter so that the compiler can turn the reads into shuffled
+ * vector loads instead of a scalar gather.
+ */
+template <unsigned Stride>
+static void AccumulateHarmonic(double *hps, const double *logSpectrum, unsigned length) {
+  for (unsigned j = 0; j < length; j++)
+    hps[j] += logSpectrum[j * Stride];
+}
+
+static void AccumulateHarmonic(double *hps, const double *logSpectrum, unsigned length, unsigned stride) {
+  switch (stride) {
+    case 2:
+      AccumulateHarmonic<2>(hps, logSpectrum, length);
+      break;
+    case 3:
+      AccumulateHarmonic<3>(hps, logSpectrum, length);
+      break;
+    case 4:
+      AccumulateHarmonic<4>(hps, logSpectrum, length);
+      break;
+    case 5:
+      AccumulateHarmonic<5>(hps, logSpectrum, length);
+      break;
+    case 6:
+      AccumulateHarmonic<6>(hps, logSpectrum, length);
+      break;
+    case 7:
+      AccumulateHarmonic<7>(hps, logSpectrum, length);
+      break;
+    case 8:
+      AccumulateHarmonic<8>(hps, logSpectrum, length);
+      break;
+    default:
+      for (unsigned j = 0; j < length; j++)
+        hps[j] += logSpectrum[j * stride];
+  }
+}
+
+/*
+ * CalculateLogHPS builds the harmonic product spectrum from a spectrum in dB
+ * into m_hpsSpectrum. Only bins where all m_hpsHarmonics harmonics are inside
+ * the spectrum are calculated and that number of bins is returned.
+ */
+unsigned FileHandling::CalculateLogHPS(const double *logSpectrum, unsigned length) {
+  unsigned hpsLength = length / m_hpsHarmonics;
+  if (!hpsLength)
+    return 0;
+
+  // the buffer is kept between calls so it's only re-allocated if it grows
+  m_hpsSpectrum.resize(hpsLength);
+  double *hps = &m_hpsSpectrum[0];
+
+  for (unsigned j = 0; j < hpsLength; j++)
+    hps[j] = logSpectrum[j];
+
+  for (unsigned i = 2; i <= m_hpsHarmonics; i++)
+    AccumulateHarmonic(hps, logSpectrum, hpsLength, i);
+
+  return hpsLength;
+}
+
+void FileHandling::SetHPSHarmonics(unsigned harmonics) {
+  m_hpsHarmonics = ValidHPSHarmonics(harmonics);
+}
+
+unsigned FileHandling::GetHPSHarmonics() {
+  return m_hpsHarmonics;
+}
+
+void FileHandling::SetDefaultHPSHarmonics(unsigned harmonics) {
+  m_defaultHPSHarmonics = ValidHPSHarmonics(harmonics);
+}
+
+unsigned FileHandling::GetDefaultHPSHarmonics() {
+  return m_defaultHPSHarmonics;
+}
+
+unsigned FileHandling::ValidHPSHarmonics(unsigned harmonics) {
+  if (harmonics >= 2 && harmonics <= 16)
+    return harmonics;
+  else
+    return 5;
+}
+
 bool FileHandling::DetectPitchInTimeDomain() {
   unsigned numberOfSamples = waveTracks[0].waveData.size();
   if (!numberOfSamples)
@@ -648,14 +769,13 @@ bool FileHandling::DetectPitchInTimeDomain() {
   std::pair <unsigned, unsigned> sustainStartAndEnd;
   sustainStartAndEnd.first = 0;
   sustainStartAndEnd.second = 0;
-  double *channel_data = new double[numberOfSamples];
 
   // Get channel data
-  SeparateStrongestChannel(channel_data);
+  int strongestChannel = GetStrongestChannel();
+  const double *channel_data = &waveTracks[strongestChannel].waveData[0];
 
   // Get sustainsection start and end
-  sustainStartAndEnd.first = m_autoSustainStart;
-  sustainStartAndEnd.second = m_autoSustainEnd;
+  sustainStartAndEnd = GetAutoSustainsection();
   
   // Check if sustainsection is not valid and if so just set the whole channel as sustain
   if (sustainStartAndEnd.first == 0 && sustainStartAndEnd.second == 0) {
@@ -673,55 +793,55 @@ bool FileHandling::DetectPitchInTimeDomain() {
     sustainStartAndEnd.second = sustainStartAndEnd.first + m_samplerate * 2;
 
   std::vector<double> allDetectedPitches;
-  double prev = channel_data[sustainStartAndEnd.second]; // Last sample
   unsigned end_point = 0; // Preliminary value of the last sample of period
+  double exact_end_point = 0;
+
+  /* We are interested in the last positive sample before a zero crossing, working backwards */
+  std::vector<ZERO_CROSSING> crossings;
+  GetZeroCrossingIndex()->GetCrossings(strongestChannel, ZERO_CROSSING_FALLING, sustainStartAndEnd.first + 2, sustainStartAndEnd.second - 1, crossings);
+
+  for (unsigned c = crossings.size(); c > 0; c--) {
+    unsigned i = crossings[c - 1].index - 1;
+    double exact_i = ZeroCrossingIndex::GetPosition(crossings[c - 1]);
+    if (!end_point) {
+      end_point = i;
+      exact_end_point = exact_i;
+    } else {
+      /* Found the next zero crossing - is this a good loop? */
+      unsigned len = end_point - i; /* no +1 as we don't want to look at the second crossover point */
+      if (i > len) {
+        unsigned prev_start_point = i - len;
+
+        /* Find the RMS of the first signal and compute the error of the second signal. */
+        double rms = 0.0;
+        double error_rms = 0.0;
+
+        for (unsigned j = 0; j < len; j++) {
+          double error = channel_data[j + prev_start_point] - channel_data[j + i];
+          double d     = channel_data[j + prev_start_point];
+
+          error *= error;
+          d *= d;
+          error_rms = error_rms * j / ((double)(j + 1)) + error / ((double)(j + 1));
+          rms = rms * j / ((double)(j + 1)) + d / ((double)(j + 1));
+        }
 
-  for (unsigned i = sustainStartAndEnd.second - 2; i > sustainStartAndEnd.first; i--) {
-    double v = channel_data[i];
-
-    /* We are interested in positive zero crossings */
-    if ((v > 0.0) && (prev <= 0.0)) {
-      if (!end_point) {
-        end_point = i;
-      } else {
-        /* Found the next zero crossing - is this a good loop? */
-        unsigned len = end_point - i; /* no +1 as we don't want to look at the second crossover point */
-        if (i > len) {
-          unsigned prev_start_point = i - len;
-
-          /* Find the RMS of the first signal and compute the error of the second signal. */
-          double rms = 0.0;
-          double error_rms = 0.0;
-
-          for (unsigned j = 0; j < len; j++) {
-            double error = channel_data[j + prev_start_point] - channel_data[j + i];
-            double d     = channel_data[j + prev_start_point];
-
-            error *= error;
-            d *= d;
-            error_rms = error_rms * j / ((double)(j + 1)) + error / ((double)(j + 1));
-            rms = rms * j / ((double)(j + 1)) + d / ((double)(j + 1));
-          }
-
-          if ((error_rms > 0.0) && (rms > 0.0)) {
-            error_rms = sqrt(error_rms);
-            rms = sqrt(rms);
+        if ((error_rms > 0.0) && (rms > 0.0)) {
+          error_rms = sqrt(error_rms);
+          rms = sqrt(rms);
 
-            if ((error_rms / rms) < 0.55) {
-              // store pitch
-              allDetectedPitches.push_back( ((double) m_samplerate) / (double) len );
-              // set endpoint for next period
-              end_point = i;
-            }
+          if ((error_rms / rms) < 0.55) {
+            // store pitch, the interpolated crossings give the period with sub sample precision
+            allDetectedPitches.push_back( ((double) m_samplerate) / (exact_end_point - exact_i) );
+            // set endpoint for next period
+            end_point = i;
+            exact_end_point = exact_i;
           }
         }
       }
     }
-    prev = v;
   }
 
-  delete[] channel_data;
-
   if (!allDetectedPitches.empty() && allDetectedPitches.size() > 1) {
     double pitchSum = 0.0;
     for (unsigned i = 0; i < allDetectedPitches.size(); i++)
@@ -763,14 +883,114 @@ bool FileHandling::DetectPitchInTimeDomain() {
 }
 
 double FileHandling::GetTDPitch() {
+  AnalysisCache cache(m_filePath, GetContentHash());
+  if (cache.Read(TD_PITCH_CACHE_KEY, &m_timeDomainPitch))
+    return m_timeDomainPitch;
+
   bool gotPitch = DetectPitchInTimeDomain();
-  if (gotPitch)
+  if (gotPitch) {
+    cache.Write(TD_PITCH_CACHE_KEY, m_timeDomainPitch);
     return m_timeDomainPitch;
-  else
+  } else
     return 0;
 }
 
+bool FileHandling::GetPitchTrack(std::vector<PITCH_TRACK_POINT> &track, double windowLength) {
+  track.clear();
+  if (waveTracks.empty() || waveTracks[0].waveData.empty())
+    return false;
+
+  // the channel is fed in blocks so the tracker never needs more than a few periods of memory
+  const std::vector<double> &channel = waveTracks[GetStrongestChannel()].waveData;
+  PitchTracker tracker(m_samplerate, windowLength);
+  unsigned blockSize = 4096;
+  for (unsigned i = 0; i < channel.size(); i += blockSize) {
+    unsigned length = blockSize;
+    if (i + length > channel.size())
+      length = channel.size() - i;
+    tracker.Process(&channel[i], length);
+  }
+  tracker.Finish();
+
+  track = tracker.GetTrack();
+  for (unsigned i = 0; i < track.size(); i++) {
+    if (track[i].pitch > 0)
+      return true;
+  }
+  return false;
+}
+
+bool FileHandling::GetPitchStability(PITCH_STABILITY &result) {
+  AnalysisCache cache(m_filePath, GetContentHash());
+  wxString cached;
+  if (cache.Read(PITCH_STABILITY_CACHE_KEY, &cached)) {
+    // stored as "meanPitch drift stdDev points startTime endTime"
+    wxArrayString values = wxSplit(cached, wxT(' '));
+    double points;
+    if (values.GetCount() == 6 &&
+        values[0].ToCDouble(&result.meanPitch) &&
+        values[1].ToCDouble(&result.driftCents) &&
+        values[2].ToCDouble(&result.centsStdDev) &&
+        values[3].ToCDouble(&points) &&
+        values[4].ToCDouble(&result.startTime) &&
+        values[5].ToCDouble(&result.endTime)) {
+      result.points = (unsigned) points;
+      return true;
+    }
+  }
+
+  std::vector<PITCH_TRACK_POINT> track;
+  if (!GetPitchTrack(track))
+    return false;
+
+  // the auto detected sustainsection is used so the result doesn't depend on slider settings
+  double startTime = 0;
+  double endTime = (double) waveTracks[0].waveData.size() / (double) m_samplerate;
+  std::pair<unsigned, unsigned> autoSustain = GetAutoSustainsection();
+  if (autoSustain.second > autoSustain.first) {
+    startTime = (double) autoSustain.first / (double) m_samplerate;
+    endTime = (double) autoSustain.second / (double) m_samplerate;
+  }
+
+  if (!PitchTracker::CalculateStability(track, startTime, endTime, result))
+    return false;
+
+  cache.Write(
+    PITCH_STABILITY_CACHE_KEY,
+    wxString::FromCDouble(result.meanPitch) + wxT(" ") +
+    wxString::FromCDouble(result.driftCents) + wxT(" ") +
+    wxString::FromCDouble(result.centsStdDev) + wxT(" ") +
+    wxString::Format(wxT("%u "), result.points) +
+    wxString::FromCDouble(result.startTime) + wxT(" ") +
+    wxString::FromCDouble(result.endTime)
+  );
+  return true;
+}
+
+double FileHandling::CrossfadeCurve(int fadeType, double linear) {
+  switch(fadeType) {
+    case 1:
+      // S curve
+      return 0.5 * (1.0 + cos((1.0 - linear) * M_PI));
+
+    case 2:
+      // equal power/gain
+      return linear / sqrt( pow(linear, 2) + pow((1 - linear), 2) );
+
+    case 3:
+      // sine curve
+      return sin(M_PI / 2 * linear);
+
+    default:
+      // linear
+      return linear;
+  }
+}
+
 void FileHandling::PerformCrossfade(int loopNumber, double fadeLength, int fadeType) {
+  // edited audio can no longer be streamed from the file
+  EnsurePlaybackData();
+
   // get the audio data as doubles
   double *audioData = new double[ArrayLength];
   bool gotData = GetDoubleAudioData(audioData);
@@ -800,58 +1020,10 @@ void FileHandling::PerformCrossfade(int loopNumber, double fadeLength, int fadeT
   double *fadeData = new double[samplesToFade];
   double *fadeOutData = new double[samplesToFadeOut];
 
-  switch(fadeType) {
-    case 0:
-      // linear data from 0 to 1
-      for (unsigned i = 0; i < samplesToFade; i++)
-        fadeData[i] = i * 1.0 / (samplesToFade - 1);
-      for (unsigned i = 0; i < samplesToFadeOut; i++)
-        fadeOutData[i] = i * 1.0 / (samplesToFadeOut - 1);
-      break;
-
-    case 1:
-      // create a S curve table from 0 to 1
-      for (unsigned i = 0; i < samplesToFade; i++) {
-        double linear = i * 1.0 / (samplesToFade - 1);
-        fadeData[i] = 0.5 * (1.0 + cos((1.0 - linear) * M_PI));
-      }
-      for (unsigned i = 0; i < samplesToFadeOut; i++) {
-        double linear = i * 1.0 / (samplesToFadeOut - 1);
-        fadeOutData[i] = 0.5 * (1.0 + cos((1.0 - linear) * M_PI));
-      }
-      break;
-
-    case 2:
-      // create a curve from 0 to 1 with equal power/gain
-      for (unsigned i = 0; i < samplesToFade; i++) {
-        double linear = i * 1.0 / (samplesToFade - 1);
-        fadeData[i] = linear / sqrt( pow(linear, 2) + pow((1 - linear), 2) );
-      }
-      for (unsigned i = 0; i < samplesToFadeOut; i++) {
-        double linear = i * 1.0 / (samplesToFadeOut - 1);
-        fadeOutData[i] = linear / sqrt( pow(linear, 2) + pow((1 - linear), 2) );
-      }
-      break;
-
-    case 3:
-       // create a sine curve table from 0 to 1
-      for (unsigned i = 0; i < samplesToFade; i++) {
-        double linear = i * 1.0 / (samplesToFade - 1);
-        fadeData[i] = sin(M_PI / 2 * linear);
-      }
-      for (unsigned i = 0; i < samplesToFadeOut; i++) {
-        double linear = i * 1.0 / (samplesToFadeOut - 1);
-        fadeOutData[i] = sin(M_PI / 2 * linear);
-      }
-      break;
-
-    default:
-      // linear data from 0 to 1
-      for (unsigned i = 0; i < samplesToFade; i++)
-        fadeData[i] = i * 1.0 / (samplesToFade - 1);
-      for (unsigned i = 0; i < samplesToFadeOut; i++)
-        fadeOutData[i] = i * 1.0 / (samplesToFadeOut - 1);
-  }
+  for (unsigned i = 0; i < samplesToFade; i++)
+    fadeData[i] = CrossfadeCurve(fadeType, i * 1.0 / (samplesToFade - 1));
+  for (unsigned i = 0; i < samplesToFadeOut; i++)
+    fadeOutData[i] = CrossfadeCurve(fadeType, i * 1.0 / (samplesToFadeOut - 1));
 
   // crossfade around the endpoint so that the audio won't click
   // the new loopEnd will be identical to the sample before loopStart
@@ -878,8 +1050,8 @@ void FileHandling::PerformCrossfade(int loopNumber, double fadeLength, int fadeT
     secondSourceIdx += m_channels;
   }
   
-  // update the waveform data with the new data
-  UpdateWaveTracks(audioData);
+  // update the waveform data with the new data, only around the loop end changed
+  UpdateWaveTracks(audioData, loopToCrossfade.dwEnd + 1 - samplesToFade, loopToCrossfade.dwEnd + samplesToFadeOut);
 
   // change the current audiodata stored after crossfade is done
   if (shortAudioData != NULL) {
@@ -904,33 +1076,9 @@ void FileHandling::PerformCrossfade(int loopNumber, double fadeLength, int fadeT
 
 void FileHandling::SeparateStrongestChannel(double outData[]) {
   if (!waveTracks.empty()) {
-    if (m_channels > 1) {
-      // we have more than one channel so deal with that
-      double maxRMS = 0.0;
-      unsigned strongestChannelIdx = 0;
-      for (unsigned i = 0; i < waveTracks.size(); i++) {
-        // this is done for each channel
-        double channelRMS = 0.0;
-        double totalValues = 0.0;
-        for (unsigned j = 0; j < waveTracks[i].waveData.size(); j++) {
-          double currentValue = pow(waveTracks[i].waveData[j], 2);
-          totalValues += currentValue;
-        }
-        channelRMS = sqrt((totalValues / waveTracks[i].waveData.size()));
-
-        if (channelRMS > maxRMS) {
-          maxRMS = channelRMS;
-          strongestChannelIdx = i;
-        }
-      }
-      // now we should know which channel has the highest RMS
-      for (unsigned i = 0; i < waveTracks[strongestChannelIdx].waveData.size(); i++)
-        outData[i] = waveTracks[strongestChannelIdx].waveData[i];
-    } else {
-      // there's just one channel so copy that double data
-      for (unsigned i = 0; i < waveTracks[0].waveData.size(); i++)
-        outData[i] = waveTracks[0].waveData[i];
-    }
+    int strongestChannelIdx = GetStrongestChannel();
+    for (unsigned i = 0; i < waveTracks[strongestChannelIdx].waveData.size(); i++)
+      outData[i] = waveTracks[strongestChannelIdx].waveData[i];
   } else {
     // for some reason there's no data in the waveTracks!
     // for safety we then fill the outData array with zeros
@@ -939,6 +1087,41 @@ void FileHandling::SeparateStrongestChannel(double outData[]) {
   }
 }
 
+int FileHandling::GetStrongestChannel() {
+  if (m_strongestChannel >= 0 && m_strongestChannel < (int) waveTracks.size())
+    return m_strongestChannel;
+
+  m_strongestChannel = 0;
+  if (waveTracks.size() > 1) {
+    AnalysisCache cache(m_filePath, m_fileName, m_fileStamp);
+    long cachedChannel;
+    if (cache.Read(wxT("StrongestChannel"), &cachedChannel) && cachedChannel >= 0 && cachedChannel < (long) waveTracks.size()) {
+      m_strongestChannel = cachedChannel;
+      return m_strongestChannel;
+    }
+
+    // we have more than one channel so find the one with highest RMS
+    double maxRMS = 0.0;
+    for (unsigned i = 0; i < waveTracks.size(); i++) {
+      // this is done for each channel
+      double channelRMS = 0.0;
+      double totalValues = 0.0;
+      for (unsigned j = 0; j < waveTracks[i].waveData.size(); j++) {
+        double currentValue = pow(waveTracks[i].waveData[j], 2);
+        totalValues += currentValue;
+      }
+      channelRMS = sqrt((totalValues / waveTracks[i].waveData.size()));
+
+      if (channelRMS > maxRMS) {
+        maxRMS = channelRMS;
+        m_strongestChannel = i;
+      }
+    }
+    cache.Write(wxT("StrongestChannel"), (long) m_strongestChannel);
+  }
+  return m_strongestChannel;
+}
+
 void FileHandling::CalculateSustainStartAndEnd() {
   // prepare array for a single channel of audio data
   unsigned numberOfSamples = ArrayLength / m_channels;
@@ -1168,6 +1351,11 @@ void FileHandling::CalculateSustainStartAndEnd() {
 }
 
 void FileHandling::TrimExcessData() {
+  // edited audio can no longer be streamed from the file
+  EnsurePlaybackData();
+
+  InvalidateAnalysis();
+
   // Remove data between last loop and first cue larger than last loop
   // First get last loop sample
   unsigned lastEndSample = 0;
@@ -1281,6 +1469,9 @@ void FileHandling::TrimExcessData() {
 }
 
 bool FileHandling::TrimStart(unsigned timeToTrim) {
+  // edited audio can no longer be streamed from the file
+  EnsurePlaybackData();
+
   // convert time to samples
   unsigned samples = (timeToTrim / 1000.0) * m_samplerate;
   unsigned samplesToCut = samples * m_channels;
@@ -1388,6 +1579,9 @@ bool FileHandling::TrimStart(unsigned timeToTrim) {
 }
 
 bool FileHandling::TrimEnd(unsigned timeToTrim) {
+  // edited audio can no longer be streamed from the file
+  EnsurePlaybackData();
+
   // convert time to samples
   unsigned samples = (timeToTrim / 1000.0) * m_samplerate;
   unsigned samplesToCut = samples * m_channels;
@@ -1491,6 +1685,11 @@ bool FileHandling::TrimEnd(unsigned timeToTrim) {
  * cue marker existing in file and export it to a (new) file
  */
 bool FileHandling::TrimAsRelease() {
+  // edited audio can no longer be streamed from the file
+  EnsurePlaybackData();
+
+  InvalidateAnalysis();
+
   // There must be at least one cue point existing to use this function
   if (!m_cues->GetNumberOfCues())
     return false;
@@ -1582,6 +1781,11 @@ bool FileHandling::TrimAsRelease() {
  * the file to slightly after last loop and export it to a (new) file.
  */
 bool FileHandling::TrimAsAttack() {
+  // edited audio can no longer be streamed from the file
+  EnsurePlaybackData();
+
+  InvalidateAnalysis();
+
   // There must be at least one loop existing to use this function
   if (!m_loops->GetNumberOfLoops())
     return false;
@@ -1665,6 +1869,9 @@ bool FileHandling::TrimAsAttack() {
 }
 
 void FileHandling::PerformFade(unsigned fadeLength, int fadeType) {
+  // edited audio can no longer be streamed from the file
+  EnsurePlaybackData();
+
   double *audioData = new double[ArrayLength];
   bool gotData = GetDoubleAudioData(audioData);
 
@@ -1715,7 +1922,11 @@ void FileHandling::PerformFade(unsigned fadeLength, int fadeType) {
       }
     }
   }
-  UpdateWaveTracks(audioData);
+  unsigned long frames = ArrayLength / m_channels;
+  if (fadeType == 0)
+    UpdateWaveTracks(audioData, 0, samplesToFade);
+  else
+    UpdateWaveTracks(audioData, frames > samplesToFade + 1 ? frames - samplesToFade - 1 : 0, frames - 1);
   delete[] audioData;
   delete[] fadeData;
 }
@@ -1738,7 +1949,31 @@ bool FileHandling::GetDoubleAudioData(double audio[]) {
   }
 }
 
-void FileHandling::UpdateWaveTracks(double audio[]) {
+void FileHandling::GetChannelWindow(unsigned channel, long first, unsigned count, double dest[]) {
+  if (channel >= waveTracks.size()) {
+    std::fill(dest, dest + count, 0.0);
+    return;
+  }
+
+  const std::vector<double> &data = waveTracks[channel].waveData;
+  long length = data.size();
+  for (unsigned i = 0; i < count; i++) {
+    long frame = first + (long) i;
+    if (frame >= 0 && frame < length)
+      dest[i] = data[frame];
+    else
+      dest[i] = 0;
+  }
+}
+
+void FileHandling::UpdateWaveTracks(double audio[], unsigned long first, unsigned long last) {
+  // the audio is changed so earlier analysis results don't apply
+  InvalidateAnalysis();
+  if (m_summary)
+    m_summary->Stop();
+  if (m_zeroCrossings)
+    m_zeroCrossings->Invalidate();
+
   // first empty old wavetracks
   for (unsigned i = 0; i < waveTracks.size(); i++)
     waveTracks[i].waveData.clear();
@@ -1753,14 +1988,28 @@ void FileHandling::UpdateWaveTracks(double audio[]) {
     if (index == m_channels)
       index = 0;
   }
+
+  if (m_summary)
+    m_summary->Update(first, last);
+}
+
+WaveformSummary* FileHandling::GetWaveformSummary() {
+  if (!m_summary)
+    m_summary = new WaveformSummary(this);
+  return m_summary;
+}
+
+ZeroCrossingIndex* FileHandling::GetZeroCrossingIndex() {
+  if (!m_zeroCrossings)
+    m_zeroCrossings = new ZeroCrossingIndex(this);
+  return m_zeroCrossings;
 }
 
 std::pair<unsigned, unsigned> FileHandling::GetSustainsection() {
   std::pair <unsigned, unsigned> sustainStartAndEnd;
   
   if (m_useAutoSustain) {
-    sustainStartAndEnd.first = m_autoSustainStart;
-    sustainStartAndEnd.second = m_autoSustainEnd;
+    sustainStartAndEnd = GetAutoSustainsection();
   } else {
     sustainStartAndEnd.first = m_sliderSustainStart;
     sustainStartAndEnd.second = m_sliderSustainEnd;
@@ -1781,25 +2030,32 @@ bool FileHandling::GetAutoSustainSearch() {
   return m_useAutoSustain;
 }
 
+// the auto sustainsection is detected the first time it's needed
+std::pair<unsigned, unsigned> FileHandling::GetAutoSustainsection() {
+  if (!m_autoSustainIsKnown && fileOpenWasSuccessful) {
+    AnalysisCache cache(m_filePath, m_fileName, m_fileStamp);
+    long cachedStart, cachedEnd;
+    if (cache.Read(wxT("SustainStart"), &cachedStart) && cache.Read(wxT("SustainEnd"), &cachedEnd)) {
+      m_autoSustainStart = cachedStart;
+      m_autoSustainEnd = cachedEnd;
+    } else {
+      CalculateSustainStartAndEnd();
+      cache.Write(wxT("SustainStart"), (long) m_autoSustainStart);
+      cache.Write(wxT("SustainEnd"), (long) m_autoSustainEnd);
+    }
+    m_autoSustainIsKnown = true;
+  }
+  return std::make_pair(m_autoSustainStart, m_autoSustainEnd);
+}
+
 bool FileHandling::AutoCreateReleaseCue() {
   // from auto sustain end we back until we find a zero crossing in strongest channel
   unsigned nbrSamples = ArrayLength / m_channels;
-  double *data = new double[nbrSamples];
-  SeparateStrongestChannel(data);
-  unsigned cueSampleOffset = m_autoSustainEnd;
-  if (cueSampleOffset < nbrSamples) {
-    if (data[cueSampleOffset] > 0) {
-      while (data[cueSampleOffset] > 0) {
-        cueSampleOffset--;
-      }
-    } else {
-      while (data[cueSampleOffset] < 0) {
-        cueSampleOffset--;
-      }
-    }
-    if (fabs(data[cueSampleOffset]) > fabs(data[cueSampleOffset + 1])) {
-      cueSampleOffset += 1;
-    }
+  unsigned sustainEnd = GetAutoSustainsection().second;
+  ZERO_CROSSING crossing;
+  if (sustainEnd < nbrSamples && GetZeroCrossingIndex()->FindPrevious(GetStrongestChannel(), ZERO_CROSSING_ANY, sustainEnd, crossing)) {
+    // the sample closest to zero of the two around the crossing
+    unsigned cueSampleOffset = ZeroCrossingIndex::GetClosestSample(crossing);
 
     CUEPOINT newCue;
     newCue.dwName = m_cues->GetNumberOfCues(); // this should be the new cues index
@@ -1811,10 +2067,8 @@ bool FileHandling::AutoCreateReleaseCue() {
     newCue.keepThisCue = true;
 
     m_cues->AddCue(newCue); // add the cue to the file cue vector
-    delete[] data;
     return true;
   } else {
-    delete[] data;
     return false;
   }
 }
@@ -1823,3 +2077,54 @@ wxString FileHandling::GetFileName() {
   return m_fileName;
 }
 
+wxString FileHandling::GetFilePath() {
+  return m_filePath;
+}
+
+/*
+ * The content hash identifies the audio data (and its format) for the
+ * analysis cache, it's calculated when needed and cleared on any change
+ */
+wxString FileHandling::GetContentHash() {
+  if (m_contentHash.IsEmpty() && !waveTracks.empty()) {
+    wxUint64 hash = AnalysisCache::HashData(&m_samplerate, sizeof(m_samplerate));
+    hash = AnalysisCache::HashData(&m_channels, sizeof(m_channels), hash);
+    for (unsigned i = 0; i < waveTracks.size(); i++) {
+      if (!waveTracks[i].waveData.empty())
+        hash = AnalysisCache::HashData(&waveTracks[i].waveData[0], waveTracks[i].waveData.size() * sizeof(double), hash);
+    }
+    m_contentHash = AnalysisCache::HashToString(hash);
+  }
+  return m_contentHash;
+}
+
+void FileHandling::InvalidateAnalysis() {
+  m_contentHash = wxEmptyString;
+  m_fileStamp = wxEmptyString;
+  m_strongestChannel = -1;
+}
+
+void FileHandling::SetStreamingThreshold(unsigned megabytes) {
+  m_streamingThreshold = megabytes;
+}
+
+unsigned FileHandling::GetStreamingThreshold() {
+  return m_streamingThreshold;
+}
+
+bool FileHandling::IsPlaybackStreamed() {
+  return fileOpenWasSuccessful && floatAudioData == NULL;
+}
+
+void FileHandling::EnsurePlaybackData() {
+  if (!IsPlaybackStreamed())
+    return;
+
+  double *audioData = new double[ArrayLength];
+  if (GetDoubleAudioData(audioData)) {
+    floatAudioData = new float[ArrayLength];
+    for (unsigned i = 0; i < ArrayLength; i++)
+      floatAudioData[i] = (float) audioData[i];
+  }
+  delete[] audioData;
+}
@@ -25,14 +25,21 @@
 #include "sndfile.hh"
 #include "LoopMarkers.h"
 #include "CueMarkers.h"
+#include "PitchTracker.h"
 #include <vector>
 #include "RtAudio.h"
 #include <wx/datetime.h>
 
+// Frames read from the file at a time when de-interleaving the audio
+#define FILEHANDLING_DECODE_FRAMES 65536
+
 typedef struct {
   std::vector<double> waveData;
 } WAVETRACK;
 
+class WaveformSummary;
+class ZeroCrossingIndex;
+
 typedef struct {
   // LIST INFO string data
   wxString artist;
@@ -72,9 +79,21 @@ public:
   int GetWholeFormat();
   bool FileCouldBeOpened();
   bool GetFFTPitch(double pitches[]);
-  bool GetSpectrum(double *output, unsigned fftSize, int windowType);
+  bool GetSpectrum(double *output, unsigned fftSize, int windowType, bool allowSinglePrecision = false);
   double GetTDPitch();
+  // Pitch per window (in seconds) over the whole strongest channel
+  bool GetPitchTrack(std::vector<PITCH_TRACK_POINT> &track, double windowLength = 0.05);
+  // Drift and variance in cents of the pitch over the sustainsection
+  bool GetPitchStability(PITCH_STABILITY &result);
+  // Number of harmonics (2-16) used for the HPS pitch detection
+  void SetHPSHarmonics(unsigned harmonics);
+  unsigned GetHPSHarmonics();
+  // Number of harmonics new files start with, the Pitch/HPSHarmonics setting
+  static void SetDefaultHPSHarmonics(unsigned harmonics);
+  static unsigned GetDefaultHPSHarmonics();
   void PerformCrossfade(int loopNumber, double fadeLength, int fadeType);
+  // Value (0 to 1) of the crossfade curve of fadeType at linear (0 to 1)
+  static double CrossfadeCurve(int fadeType, double linear);
   void TrimExcessData();
   bool TrimStart(unsigned timeToTrim);
   bool TrimEnd(unsigned timeToTrim);
@@ -83,20 +102,40 @@ public:
   void PerformFade(unsigned fadeLength, int fadeType);
   // Get audio data as doubles
   bool GetDoubleAudioData(double audio[]);
-  // Update the wave data vector if audio is changed
-  void UpdateWaveTracks(double audio[]);
+  // Copies count frames of a channel starting at first from the wave data,
+  // frames outside of the audio are given as 0
+  void GetChannelWindow(unsigned channel, long first, unsigned count, double dest[]);
+  // Update the wave data vector if audio is changed, first and last are the
+  // frames that changed when the length is the same
+  void UpdateWaveTracks(double audio[], unsigned long first = 0, unsigned long last = (unsigned long) -1);
+  // Min/max pyramid of the wave data, created on first request
+  WaveformSummary* GetWaveformSummary();
+  // Zero crossings of every channel, indexed on first request
+  ZeroCrossingIndex* GetZeroCrossingIndex();
   void SetAutoSustainSearch(bool choice);
   bool GetAutoSustainSearch();
   std::pair<unsigned, unsigned> GetSustainsection();
   void SetSliderSustainsection(int start, int end);
   // Get strongest channel of audio data as doubles
   void SeparateStrongestChannel(double outData[]);
+  int GetStrongestChannel();
   bool AutoCreateReleaseCue();
   wxString GetFileName();
+  wxString GetFilePath();
+  // Hash of the audio data used as key for cached analysis results
+  wxString GetContentHash();
+  // Files with more float playback data than this (in MB) are played from
+  // disk until they're edited, 0 always keeps the data in memory
+  static void SetStreamingThreshold(unsigned megabytes);
+  static unsigned GetStreamingThreshold();
+  // True if floatAudioData wasn't read and playback should stream the file
+  bool IsPlaybackStreamed();
+  // Creates floatAudioData from the audio data if it wasn't read
+  void EnsurePlaybackData();
 
   short *shortAudioData;
   int *intAudioData;
-  float *floatAudioData; // always read and used for playback!
+  float *floatAudioData; // used for playback, NULL if the file is streamed
   double *doubleAudioData;
   std::vector<WAVETRACK> waveTracks;
   WAV_LIST_INFO m_info;
@@ -111,21 +150,31 @@ private:
   SF_CUES cues;
 
   wxString m_fileName;
+  wxString m_filePath;
+  wxString m_contentHash;
+  wxString m_fileStamp; // empty once the audio differs from the file
   int m_format;
   int m_minorFormat;
   unsigned m_samplerate;
   bool fileOpenWasSuccessful;
   double m_fftPitch;
   double m_fftHPS;
+  unsigned m_hpsHarmonics;
+  std::vector<double> m_hpsSpectrum;
   double m_timeDomainPitch;
   unsigned m_autoSustainStart;
   unsigned m_autoSustainEnd;
+  bool m_autoSustainIsKnown;
   unsigned m_sliderSustainStart;
   unsigned m_sliderSustainEnd;
+  int m_strongestChannel;
   bool m_useAutoSustain;
+  WaveformSummary *m_summary;
+  ZeroCrossingIndex *m_zeroCrossings;
 
   bool DetectPitchByFFT();
   bool DetectPitchInTimeDomain();
+  unsigned CalculateLogHPS(const double *logSpectrum, unsigned length);
   double TranslateIndexToPitch(
     int idxAtPeak,
     double valueBeforePeak,
@@ -134,6 +183,13 @@ private:
     unsigned wSize
   );
   void CalculateSustainStartAndEnd();
+  std::pair<unsigned, unsigned> GetAutoSustainsection();
+  void InvalidateAnalysis();
+
+  static unsigned m_streamingThreshold;
+  static unsigned m_defaultHPSHarmonics;
+
+  static unsigned ValidHPSHarmonics(unsigned harmonics);
 
 };
 
@@ -0,0 +1,251 @@
+/*
+ * FileListScanner.cpp is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#include "FileListScanner.h"
+#include "AnalysisCache.h"
+#include "sndfile.hh"
+#include <wx/filename.h>
+#include <algorithm>
+#include <cmath>
+
+// Level given to silent files
+#define FILELIST_SILENCE_DB -200.0
+
+class FileListScannerWorker : public wxThread {
+public:
+  FileListScannerWorker(FileListScanner *scanner) : wxThread(wxTHREAD_JOINABLE), m_scanner(scanner) {}
+
+protected:
+  virtual ExitCode Entry() {
+    m_scanner->WorkerLoop();
+    return (ExitCode) 0;
+  }
+
+private:
+  FileListScanner *m_scanner;
+};
+
+FileListScanner::FileListScanner(wxEvtHandler *listener, int eventId) : m_listener(listener), m_eventId(eventId), m_hasWork(m_lock), m_generation(0), m_stop(false) {
+  int nbrWorkers = wxThread::GetCPUCount();
+  if (nbrWorkers > FILELIST_MAX_WORKERS)
+    nbrWorkers = FILELIST_MAX_WORKERS;
+  if (nbrWorkers < 1)
+    nbrWorkers = 1;
+  for (int i = 0; i < nbrWorkers; i++) {
+    FileListScannerWorker *worker = new FileListScannerWorker(this);
+    if (worker->Run() == wxTHREAD_NO_ERROR)
+      m_workers.push_back(worker);
+    else
+      delete worker;
+  }
+}
+
+FileListScanner::~FileListScanner() {
+  {
+    wxMutexLocker locker(m_lock);
+    m_stop = true;
+    m_queue.clear();
+    m_hasWork.Broadcast();
+  }
+  for (unsigned i = 0; i < m_workers.size(); i++) {
+    m_workers[i]->Wait();
+    delete m_workers[i];
+  }
+  m_workers.clear();
+}
+
+void FileListScanner::Clear() {
+  wxMutexLocker locker(m_lock);
+  m_queue.clear();
+  m_finished.clear();
+  m_generation++;
+}
+
+void FileListScanner::Request(long item, wxString filePath) {
+  wxMutexLocker locker(m_lock);
+  m_queue.push_back(std::make_pair(item, filePath));
+  m_hasWork.Signal();
+}
+
+bool FileListScanner::CollectFinishedFiles(std::vector<FILELIST_STATS> &stats) {
+  stats.clear();
+  wxMutexLocker locker(m_lock);
+  stats.swap(m_finished);
+  return !stats.empty();
+}
+
+void FileListScanner::WorkerLoop() {
+  while (true) {
+    std::pair<long, wxString> job;
+    unsigned generation;
+    {
+      wxMutexLocker locker(m_lock);
+      while (m_queue.empty() && !m_stop)
+        m_hasWork.Wait();
+      if (m_stop)
+        return;
+      job = m_queue.front();
+      m_queue.pop_front();
+      generation = m_generation;
+    }
+
+    FILELIST_STATS stats;
+    stats.item = job.first;
+    if (!ReadFromCache(job.second, stats)) {
+      ScanFile(job.second, stats);
+      if (stats.ok)
+        WriteToCache(job.second, stats);
+    }
+
+    bool queueIsEmpty;
+    {
+      wxMutexLocker locker(m_lock);
+      if (m_stop)
+        return;
+      queueIsEmpty = m_queue.empty();
+      // the list was filled again while this file was read
+      if (generation != m_generation)
+        continue;
+      m_finished.push_back(stats);
+    }
+    wxQueueEvent(m_listener, new wxThreadEvent(wxEVT_THREAD, m_eventId));
+
+    // all files of the list are done, keep the results
+    if (queueIsEmpty)
+      AnalysisCache::Flush(wxFileName(job.second).GetPath());
+  }
+}
+
+void FileListScanner::ScanFile(wxString filePath, FILELIST_STATS &stats) {
+  stats.ok = false;
+  stats.duration = 0;
+  stats.peak = FILELIST_SILENCE_DB;
+  stats.rms = FILELIST_SILENCE_DB;
+  stats.thumbnail.assign(FILELIST_THUMBNAIL_COLUMNS * 2, 128);
+
+  SndfileHandle sfh(((const char*)filePath.mb_str()));
+  if (!sfh || sfh.frames() <= 0 || sfh.channels() <= 0 || sfh.samplerate() <= 0)
+    return;
+
+  unsigned channels = sfh.channels();
+  unsigned long frames = sfh.frames();
+  std::vector<float> buffer(FILELIST_READ_FRAMES * channels);
+  std::vector<float> columnMin(FILELIST_THUMBNAIL_COLUMNS, 0.0f);
+  std::vector<float> columnMax(FILELIST_THUMBNAIL_COLUMNS, 0.0f);
+  double peak = 0;
+  double sumOfSquares = 0;
+  unsigned long position = 0;
+
+  while (position < frames) {
+    sf_count_t got = sfh.readf(&buffer[0], FILELIST_READ_FRAMES);
+    if (got <= 0)
+      break;
+
+    for (sf_count_t i = 0; i < got; i++) {
+      unsigned column = (unsigned) ((unsigned long long) (position + i) * FILELIST_THUMBNAIL_COLUMNS / frames);
+      if (column >= FILELIST_THUMBNAIL_COLUMNS)
+        column = FILELIST_THUMBNAIL_COLUMNS - 1;
+      const float *frame = &buffer[i * channels];
+      for (unsigned ch = 0; ch < channels; ch++) {
+        float value = frame[ch];
+        if (value < columnMin[column])
+          columnMin[column] = value;
+        if (value > columnMax[column])
+          columnMax[column] = value;
+        if (fabs(value) > peak)
+          peak = fabs(value);
+        sumOfSquares += (double) value * value;
+      }
+    }
+    position += got;
+
+    // don't keep reading if the list is closing
+    wxMutexLocker locker(m_lock);
+    if (m_stop)
+      return;
+  }
+  if (position == 0)
+    return;
+
+  stats.ok = true;
+  stats.duration = (double) frames / (double) sfh.samplerate();
+  if (peak > 0)
+    stats.peak = std::max(20 * log10(peak), FILELIST_SILENCE_DB);
+  if (sumOfSquares > 0)
+    stats.rms = std::max(10 * log10(sumOfSquares / ((double) position * channels)), FILELIST_SILENCE_DB);
+  for (unsigned i = 0; i < FILELIST_THUMBNAIL_COLUMNS; i++) {
+    stats.thumbnail[i * 2] = (unsigned char) std::min(std::max((columnMin[i] + 1.0) * 127.5, 0.0), 255.0);
+    stats.thumbnail[i * 2 + 1] = (unsigned char) std::min(std::max((columnMax[i] + 1.0) * 127.5, 0.0), 255.0);
+  }
+}
+
+/*
+ * Everything is kept in one string so that each file is a single entry in
+ * the cache. The levels are stored in hundredths of a dB and the length in
+ * milliseconds so that the numbers don't depend on the locale.
+ */
+bool FileListScanner::ReadFromCache(wxString filePath, FILELIST_STATS &stats) {
+  wxString cached;
+  wxFileName file(filePath);
+  AnalysisCache cache(file.GetPath(), file.GetFullName(), AnalysisCache::GetFileStamp(filePath));
+  if (!cache.Read(wxT("ListStats"), &cached))
+    return false;
+
+  long duration, peak, rms;
+  if (!cached.BeforeFirst(wxT(' ')).ToLong(&duration))
+    return false;
+  cached = cached.AfterFirst(wxT(' '));
+  if (!cached.BeforeFirst(wxT(' ')).ToLong(&peak))
+    return false;
+  cached = cached.AfterFirst(wxT(' '));
+  if (!cached.BeforeFirst(wxT(' ')).ToLong(&rms))
+    return false;
+  cached = cached.AfterFirst(wxT(' '));
+  if (cached.length() != FILELIST_THUMBNAIL_COLUMNS * 4)
+    return false;
+
+  stats.thumbnail.resize(FILELIST_THUMBNAIL_COLUMNS * 2);
+  for (unsigned i = 0; i < stats.thumbnail.size(); i++) {
+    unsigned long value;
+    if (!cached.Mid(i * 2, 2).ToULong(&value, 16))
+      return false;
+    stats.thumbnail[i] = (unsigned char) value;
+  }
+  stats.ok = true;
+  stats.duration = duration / 1000.0;
+  stats.peak = peak / 100.0;
+  stats.rms = rms / 100.0;
+  return true;
+}
+
+void FileListScanner::WriteToCache(wxString filePath, const FILELIST_STATS &stats) {
+  wxString value = wxString::Format(
+    wxT("%ld %ld %ld "),
+    lround(stats.duration * 1000.0),
+    lround(stats.peak * 100.0),
+    lround(stats.rms * 100.0)
+  );
+  for (unsigned i = 0; i < stats.thumbnail.size(); i++)
+    value += wxString::Format(wxT("%02x"), stats.thumbnail[i]);
+
+  wxFileName file(filePath);
+  AnalysisCache cache(file.GetPath(), file.GetFullName(), AnalysisCache::GetFileStamp(filePath));
+  cache.Write(wxT("ListStats"), value);
+}
@@ -0,0 +1,94 @@
+/*
+ * FileListScanner.h is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#ifndef FILELISTSCANNER_H
+#define FILELISTSCANNER_H
+
+#include <wx/wx.h>
+#include <wx/thread.h>
+#include <vector>
+#include <deque>
+
+// Number of min/max pairs in the waveform thumbnail of a file
+#define FILELIST_THUMBNAIL_COLUMNS 64
+// The files are read from disk so more workers than this only compete for it
+#define FILELIST_MAX_WORKERS 2
+// Frames read from a file at a time
+#define FILELIST_READ_FRAMES 65536
+
+typedef struct {
+  long item;
+  bool ok;
+  double duration; // seconds
+  double peak; // dBFS of the largest sample of any channel
+  double rms; // dBFS over all channels
+  // min and max of each thumbnail column, 0 is -1.0 and 255 is +1.0
+  std::vector<unsigned char> thumbnail;
+} FILELIST_STATS;
+
+class FileListScannerWorker;
+
+/*
+ * FileListScanner reads the files of the file list on a few worker threads
+ * and works out the length, peak and RMS level and a small waveform overview
+ * of each. The results are kept in the analysis cache grouped by the name,
+ * size and modification time of the file since hashing the audio content
+ * would need the whole file to be read anyway. The cache is written to disk
+ * every time the queue runs empty.
+ *
+ * All public functions must be called from the GUI thread. The listener gets
+ * a wxThreadEvent with the id given in the constructor every time a file is
+ * done, it should then call CollectFinishedFiles().
+ */
+class FileListScanner {
+public:
+  FileListScanner(wxEvtHandler *listener, int eventId);
+  ~FileListScanner();
+
+  // Drops everything queued or finished, results for earlier files never show up after this
+  void Clear();
+  void Request(long item, wxString filePath);
+  // Moves the finished results to stats, returns true if there were any
+  bool CollectFinishedFiles(std::vector<FILELIST_STATS> &stats);
+
+  // Called by the worker threads only
+  void WorkerLoop();
+
+private:
+  wxEvtHandler *m_listener;
+  int m_eventId;
+
+  // shared with the workers, protected by m_lock
+  wxMutex m_lock;
+  wxCondition m_hasWork;
+  std::deque<std::pair<long, wxString> > m_queue;
+  std::vector<FILELIST_STATS> m_finished;
+  unsigned m_generation;
+  bool m_stop;
+
+  std::vector<FileListScannerWorker*> m_workers;
+
+  void ScanFile(wxString filePath, FILELIST_STATS &stats);
+  bool ReadFromCache(wxString filePath, FILELIST_STATS &stats);
+  void WriteToCache(wxString filePath, const FILELIST_STATS &stats);
+
+};
+
+#endif
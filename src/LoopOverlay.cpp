@@ -27,6 +27,9 @@ BEGIN_EVENT_TABLE(LoopOverlay, wxDialog)
   EVT_SPINCTRL(ID_LOOPBEGIN, LoopOverlay::OnLoopStartChange)
   EVT_SPINCTRL(ID_LOOPSTOP, LoopOverlay::OnLoopEndChange)
   EVT_SPINCTRL(ID_WAVELENGTH, LoopOverlay::OnWaveLengthChange)
+  EVT_BUTTON(ID_SNAP_START, LoopOverlay::OnSnapStart)
+  EVT_BUTTON(ID_SNAP_END, LoopOverlay::OnSnapEnd)
+  EVT_LISTBOX(ID_MATCH_LIST, LoopOverlay::OnMatchSelected)
 END_EVENT_TABLE()
 
 LoopOverlay::LoopOverlay(
@@ -41,6 +44,8 @@ LoopOverlay::LoopOverlay(
 
   m_fileReference = fh;
   m_hasChanged = false;
+  m_matchesForEnd = false;
+  m_matchOrigin = 0;
 
   m_drawingPanel = new LoopOverlayPanel(m_fileReference, selectedLoop, this);
 
@@ -127,6 +132,17 @@ LoopOverlay::LoopOverlay(
     );
     loopStartSizer->Add(loopStartSpin, 0, wxALIGN_CENTER_HORIZONTAL|wxALIGN_TOP|wxTOP|wxLEFT|wxRIGHT, 2);
 
+    // The button searching for the best loop start
+    m_snapStart = new wxButton(
+      this,
+      ID_SNAP_START,
+      wxT("Best start"),
+      wxDefaultPosition,
+      wxDefaultSize,
+      0
+    );
+    loopStartSizer->Add(m_snapStart, 0, wxALIGN_CENTER_HORIZONTAL|wxALIGN_TOP|wxTOP|wxLEFT|wxRIGHT, 2);
+
     loopStartSizer->AddStretchSpacer();
 
     // Label for the number of samples in waveform
@@ -186,6 +202,17 @@ LoopOverlay::LoopOverlay(
     );
     loopEndSizer->Add(loopEndSpin, 0, wxALIGN_CENTER_HORIZONTAL|wxALIGN_TOP|wxTOP|wxLEFT|wxRIGHT, 2);
 
+    // The button searching for the best loop end
+    m_snapEnd = new wxButton(
+      this,
+      ID_SNAP_END,
+      wxT("Best end"),
+      wxDefaultPosition,
+      wxDefaultSize,
+      0
+    );
+    loopEndSizer->Add(m_snapEnd, 0, wxALIGN_CENTER_HORIZONTAL|wxALIGN_TOP|wxTOP|wxLEFT|wxRIGHT, 2);
+
     loopEndSizer->AddStretchSpacer();
 
     // The loopchange storage button
@@ -200,6 +227,60 @@ LoopOverlay::LoopOverlay(
     m_storeChanges->Enable(false);
     loopEndSizer->Add(m_storeChanges, 0, wxALIGN_CENTER_HORIZONTAL|wxALIGN_TOP|wxTOP|wxLEFT|wxRIGHT, 2);
 
+    // Label for the seam metrics of each channel
+    m_seamLabel = new wxStaticText(
+      this,
+      wxID_STATIC,
+      wxEmptyString,
+      wxDefaultPosition,
+      wxDefaultSize,
+      0
+    );
+    UpdateSeamMetrics();
+
+    // Sizer for the bottom row
+    wxBoxSizer *bottomRow = new wxBoxSizer(wxHORIZONTAL);
+    boxSizer->Add(bottomRow, 0, wxEXPAND|wxALL, 5);
+    bottomRow->Add(m_seamLabel, 1, wxALIGN_TOP|wxALL, 2);
+
+    // Sizer for the best match search items
+    wxBoxSizer *searchSizer = new wxBoxSizer(wxVERTICAL);
+    bottomRow->Add(searchSizer, 0, wxEXPAND|wxALL, 0);
+
+    // Label for the search radius
+    wxStaticText *searchRadiusLabel = new wxStaticText(
+      this,
+      wxID_ANY,
+      wxT("Search radius"),
+      wxDefaultPosition,
+      wxDefaultSize,
+      0
+    );
+    searchSizer->Add(searchRadiusLabel, 0, wxALIGN_CENTER_HORIZONTAL|wxBOTTOM|wxLEFT|wxRIGHT, 2);
+
+    // A spin control for the number of samples searched on each side of a loop point
+    m_searchRadius = new wxSpinCtrl (
+      this,
+      ID_SEARCH_RADIUS,
+      wxEmptyString,
+      wxDefaultPosition,
+      wxDefaultSize,
+      wxSP_ARROW_KEYS,
+      10,
+      SEAM_SEARCH_MAX_RADIUS,
+      SEAM_SEARCH_RADIUS
+    );
+    searchSizer->Add(m_searchRadius, 0, wxALIGN_CENTER_HORIZONTAL|wxALL, 2);
+
+    // The ranked matches of the last search, selecting one uses it
+    m_matchList = new wxListBox(
+      this,
+      ID_MATCH_LIST,
+      wxDefaultPosition,
+      wxSize(260, 90)
+    );
+    searchSizer->Add(m_matchList, 1, wxEXPAND|wxALL, 2);
+
     SetMinSize(wxSize(640, 480));
     SetAutoLayout(true);
     SetSizer(topSizer);
@@ -241,6 +322,8 @@ void LoopOverlay::OnPrevButton(wxCommandEvent& WXUNUSED(event)) {
     m_drawingPanel->UpdateAudioTracks();
     UpdateSpinners();
     SetSaveButtonState();
+    UpdateSeamMetrics();
+    ClearMatches();
 
     m_drawingPanel->PaintNow();
   }
@@ -256,6 +339,8 @@ void LoopOverlay::OnNextButton(wxCommandEvent& WXUNUSED(event)) {
     m_drawingPanel->UpdateAudioTracks();
     UpdateSpinners();
     SetSaveButtonState();
+    UpdateSeamMetrics();
+    ClearMatches();
 
     m_drawingPanel->PaintNow();
   }
@@ -272,6 +357,8 @@ void LoopOverlay::OnLoopStartChange(wxSpinEvent& WXUNUSED(event)) {
   m_drawingPanel->SetCurrentLoopStart(loopStartSpin->GetValue());
   m_drawingPanel->UpdateAudioTracks();
   SetSaveButtonState();
+  UpdateSeamMetrics();
+  ClearMatches();
   m_drawingPanel->PaintNow();
 }
 
@@ -279,6 +366,8 @@ void LoopOverlay::OnLoopEndChange(wxSpinEvent& WXUNUSED(event)) {
   m_drawingPanel->SetCurrentLoopEnd(loopEndSpin->GetValue());
   m_drawingPanel->UpdateAudioTracks();
   SetSaveButtonState();
+  UpdateSeamMetrics();
+  ClearMatches();
   m_drawingPanel->PaintNow();
 }
 
@@ -313,6 +402,108 @@ void LoopOverlay::SetSaveButtonState() {
     m_storeChanges->Enable(true);
 }
 
+void LoopOverlay::UpdateSeamMetrics() {
+  wxString metricsString;
+  for (unsigned i = 0; i < m_fileReference->waveTracks.size(); i++) {
+    SEAM_METRICS metrics;
+    CalculateSeamMetrics(
+      m_fileReference,
+      i,
+      m_drawingPanel->GetCurrentLoopStart(),
+      m_drawingPanel->GetCurrentLoopEnd(),
+      metrics
+    );
+    if (i > 0)
+      metricsString += wxT("\n");
+    metricsString += wxString::Format(
+      wxT("Channel %u: jump %.5f, slope jump %.5f, correlation %.4f, spectral difference %.2f dB"),
+      i + 1,
+      metrics.sampleJump,
+      metrics.slopeJump,
+      metrics.correlation,
+      metrics.spectralDifference
+    );
+  }
+  m_seamLabel->SetLabel(metricsString);
+}
+
+void LoopOverlay::OnSnapStart(wxCommandEvent& WXUNUSED(event)) {
+  FindMatches(false);
+}
+
+void LoopOverlay::OnSnapEnd(wxCommandEvent& WXUNUSED(event)) {
+  FindMatches(true);
+}
+
+void LoopOverlay::OnMatchSelected(wxCommandEvent& WXUNUSED(event)) {
+  ApplyMatch(m_matchList->GetSelection());
+}
+
+void LoopOverlay::FindMatches(bool moveEnd) {
+  m_matchesForEnd = moveEnd;
+  if (moveEnd)
+    m_matchOrigin = m_drawingPanel->GetCurrentLoopEnd();
+  else
+    m_matchOrigin = m_drawingPanel->GetCurrentLoopStart();
+
+  FindBestSeamMatches(
+    m_fileReference,
+    m_drawingPanel->GetCurrentLoopStart(),
+    m_drawingPanel->GetCurrentLoopEnd(),
+    moveEnd,
+    m_searchRadius->GetValue(),
+    LOOPOVERLAY_LISTED_MATCHES,
+    m_matches
+  );
+
+  m_matchList->Clear();
+  for (unsigned i = 0; i < m_matches.size(); i++) {
+    m_matchList->Append(wxString::Format(
+      wxT("%u. %s %lu (%+ld), error %.5f"),
+      i + 1,
+      moveEnd ? wxT("End") : wxT("Start"),
+      m_matches[i].position,
+      (long) m_matches[i].position - (long) m_matchOrigin,
+      m_matches[i].error
+    ));
+  }
+
+  // the best match is used right away, the others can be tried from the list
+  if (!m_matches.empty()) {
+    m_matchList->SetSelection(0);
+    ApplyMatch(0);
+  }
+}
+
+void LoopOverlay::ApplyMatch(int index) {
+  if (index < 0 || index >= (int) m_matches.size())
+    return;
+
+  if (m_matchesForEnd)
+    m_drawingPanel->SetCurrentLoopEnd((int) m_matches[index].position);
+  else
+    m_drawingPanel->SetCurrentLoopStart((int) m_matches[index].position);
+
+  UpdateSpinners();
+  m_drawingPanel->UpdateAudioTracks();
+  SetSaveButtonState();
+  UpdateSeamMetrics();
+  m_drawingPanel->PaintNow();
+}
+
+void LoopOverlay::ClearMatches() {
+  m_matches.clear();
+  m_matchList->Clear();
+}
+
 bool LoopOverlay::GetHasChanged() {
   return m_hasChanged;
 }
+
+void LoopOverlay::SetSearchRadius(int radius) {
+  m_searchRadius->SetValue(radius);
+}
+
+int LoopOverlay::GetSearchRadius() {
+  return m_searchRadius->GetValue();
+}
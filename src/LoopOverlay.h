@@ -26,6 +26,10 @@
 #include <wx/spinctrl.h>
 #include "FileHandling.h"
 #include "LoopOverlayPanel.h"
+#include "SeamMetrics.h"
+
+// Number of ranked matches listed by a best match search
+#define LOOPOVERLAY_LISTED_MATCHES 10
 
 // Identifiers
 enum {
@@ -34,7 +38,11 @@ enum {
   ID_LOOPBEGIN = wxID_HIGHEST + 352,
   ID_LOOPSTOP = wxID_HIGHEST + 353,
   ID_WAVELENGTH = wxID_HIGHEST + 354,
-  ID_STORE_CHANGES = wxID_HIGHEST + 355
+  ID_STORE_CHANGES = wxID_HIGHEST + 355,
+  ID_SNAP_START = wxID_HIGHEST + 356,
+  ID_SNAP_END = wxID_HIGHEST + 357,
+  ID_SEARCH_RADIUS = wxID_HIGHEST + 358,
+  ID_MATCH_LIST = wxID_HIGHEST + 359
 };
 
 class LoopOverlay : public wxDialog {
@@ -53,16 +61,26 @@ public:
 
   bool GetHasChanged();
   void SetSampleSpinnerValues();
+  void SetSearchRadius(int radius);
+  int GetSearchRadius();
 
 private:
   LoopOverlayPanel *m_drawingPanel;
   wxButton *m_prevLoop;
   wxButton *m_nextLoop;
   wxButton *m_storeChanges;
+  wxButton *m_snapStart;
+  wxButton *m_snapEnd;
   wxStaticText *m_loopLabel;
+  wxStaticText *m_seamLabel;
   wxSpinCtrl* loopStartSpin;
   wxSpinCtrl* loopEndSpin;
   wxSpinCtrl* m_waveLength;
+  wxSpinCtrl* m_searchRadius;
+  wxListBox *m_matchList;
+  std::vector<SEAM_MATCH> m_matches;
+  bool m_matchesForEnd;
+  unsigned long m_matchOrigin; // the loop point when the matches were searched
   FileHandling *m_fileReference;
   bool m_hasChanged;
 
@@ -76,6 +94,13 @@ private:
   void OnWaveLengthChange(wxSpinEvent& event);
   void OnStoreChanges(wxCommandEvent& event);
   void SetSaveButtonState();
+  void UpdateSeamMetrics();
+  void OnSnapStart(wxCommandEvent& event);
+  void OnSnapEnd(wxCommandEvent& event);
+  void OnMatchSelected(wxCommandEvent& event);
+  void FindMatches(bool moveEnd);
+  void ApplyMatch(int index);
+  void ClearMatches();
 
   // handle events
   DECLARE_EVENT_TABLE()
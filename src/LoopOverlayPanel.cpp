@@ -20,6 +20,7 @@
 
 #include "LoopOverlayPanel.h"
 #include "LoopOverlay.h"
+#include <algorithm>
 
 BEGIN_EVENT_TABLE(LoopOverlayPanel, wxPanel)
   EVT_SIZE(LoopOverlayPanel::OnSize)
@@ -41,15 +42,12 @@ LoopOverlayPanel::LoopOverlayPanel(
   m_fileRef = fh;
   m_selectedLoop = selectedLoop;
 
-  // get the audio data as doubles from
-  audioData = new double[m_fileRef->ArrayLength];
-  bool gotData = m_fileRef->GetDoubleAudioData(audioData);
-
   SetBackgroundColour(wxColour(244,242,239));
   SetMinSize(wxSize(400, 380));
   SetBackgroundStyle(wxBG_STYLE_PAINT);
 
-  if (gotData) {
+  // the frames to show are read from the wave data when needed
+  if (!m_fileRef->waveTracks.empty()) {
     ReadLoopData();
     UpdateAudioTracks();
   } else {
@@ -58,8 +56,7 @@ LoopOverlayPanel::LoopOverlayPanel(
 }
 
 LoopOverlayPanel::~LoopOverlayPanel() {
-  if (audioData)
-    delete[] audioData;
+
 }
 
 int LoopOverlayPanel::GetCurrentLoopEnd() {
@@ -169,7 +166,7 @@ void LoopOverlayPanel::OnPaint(wxDC& dc) {
       wxPoint *startWave = new wxPoint[m_numberOfSamples];
       for (int j = 0; j < m_numberOfSamples; j++) {
         int x_value = leftMargin + (m_trackWidth / (m_numberOfSamples - 1)) * j;
-        double y = m_startTracks[i].startData[j]; // real value from audio data
+        double y = m_startTracks[i][j]; // real value from audio data
         y = (y - m_minValue) / m_valueRange; // normalized between min and max
         int y_value = topMargin + trackHeight - trackHeight * y + trackHeight * i;
         startWave[j] = wxPoint(x_value, y_value);
@@ -189,7 +186,7 @@ void LoopOverlayPanel::OnPaint(wxDC& dc) {
       wxPoint *endWave = new wxPoint[m_numberOfSamples];
       for (int j = 0; j < m_numberOfSamples; j++) {
         int x_value = leftMargin + (m_trackWidth / (m_numberOfSamples - 1)) * j;
-        double y = m_endTracks[i].endData[j]; // real value from audio data
+        double y = m_endTracks[i][j]; // real value from audio data
         y = (y - m_minValue) / m_valueRange; // normalized between min and max
         int y_value = topMargin + trackHeight - trackHeight * y + trackHeight * i;
         endWave[j] = wxPoint(x_value, y_value);
@@ -213,54 +210,26 @@ void LoopOverlayPanel::OnPaint(wxDC& dc) {
 }
 
 void LoopOverlayPanel::UpdateAudioTracks() {
-  if (!m_startTracks.empty())
-    m_startTracks.clear();
-  if (!m_endTracks.empty())
-    m_endTracks.clear();
+  unsigned channels = m_fileRef->waveTracks.size();
+  m_startTracks.resize(channels);
+  m_endTracks.resize(channels);
 
-  // prepare to transfer data to internal storage
+  // max and min values will be used to scale the waveform
   m_maxValue = -1.0;
   m_minValue = 1.0;
 
-  for (int i = 0; i < m_fileRef->m_channels; i++) {
-    STARTAUDIO start;
-    m_startTracks.push_back(start);
-    ENDAUDIO end;
-    m_endTracks.push_back(end);
-  }
-
-  // get the necessary data
-  int index = 0;
+  // the frame after the loop end is the loop start so they're shown one sample apart
   int halfOfSamples = m_numberOfSamples / 2;
-  for (int i = 0; i < m_numberOfSamples * m_fileRef->m_channels; i++) {
-    double startValue = 0;
-    double endValue = 0;
-    int startIdx = currentLoopstart * m_fileRef->m_channels - halfOfSamples * m_fileRef->m_channels + i;
-    int endIdx = currentLoopend * m_fileRef->m_channels - (halfOfSamples - 1) * m_fileRef->m_channels + i;
-    if (startIdx > 0)
-      startValue = audioData[startIdx];
-    if ((unsigned) endIdx < m_fileRef->ArrayLength - 1)
-      endValue = audioData[endIdx];
-    // de-interleaving
-    m_startTracks[index].startData.push_back(startValue);
-    m_endTracks[index].endData.push_back(endValue);
-    index++;
-
-    if (index == m_fileRef->m_channels)
-      index = 0;
-
-    // max and min values will be used to scale the waveform
-    if (startValue > m_maxValue)
-      m_maxValue = startValue;
-
-    if (startValue < m_minValue)
-      m_minValue = startValue;
-
-    if (endValue > m_maxValue)
-      m_maxValue = endValue;
-
-    if (endValue < m_minValue)
-      m_minValue = endValue;
+  for (unsigned i = 0; i < channels; i++) {
+    m_startTracks[i].resize(m_numberOfSamples);
+    m_endTracks[i].resize(m_numberOfSamples);
+    m_fileRef->GetChannelWindow(i, (long) currentLoopstart - halfOfSamples, m_numberOfSamples, &m_startTracks[i][0]);
+    m_fileRef->GetChannelWindow(i, (long) currentLoopend - (halfOfSamples - 1), m_numberOfSamples, &m_endTracks[i][0]);
+
+    for (int j = 0; j < m_numberOfSamples; j++) {
+      m_maxValue = std::max(m_maxValue, std::max(m_startTracks[i][j], m_endTracks[i][j]));
+      m_minValue = std::min(m_minValue, std::min(m_startTracks[i][j], m_endTracks[i][j]));
+    }
   }
 
   m_valueRange = m_maxValue - m_minValue;
@@ -25,14 +25,6 @@
 #include <vector>
 #include "FileHandling.h"
 
-typedef struct {
-  std::vector<double> startData;
-} STARTAUDIO;
-
-typedef struct {
-  std::vector<double> endData;
-} ENDAUDIO;
-
 class LoopOverlayPanel : public wxPanel {
 public:
   LoopOverlayPanel(
@@ -62,8 +54,9 @@ public:
   void PaintNow();
 
 private:
-  std::vector<STARTAUDIO> m_startTracks;
-  std::vector<ENDAUDIO> m_endTracks;
+  // the frames around the loop points of each channel
+  std::vector<std::vector<double> > m_startTracks;
+  std::vector<std::vector<double> > m_endTracks;
   double m_maxValue;
   double m_minValue;
   double m_valueRange;
@@ -73,7 +66,6 @@ private:
   int m_trackWidth;
   int m_maxSamplesSpinner;
   FileHandling *m_fileRef;
-  double *audioData;
   int m_selectedLoop;
 
   void OnPaintEvent(wxPaintEvent& event);
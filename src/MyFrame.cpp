@@ -28,17 +28,19 @@
 #include "LoopParametersDialog.h"
 #include <climits>
 #include "PitchDialog.h"
+#include "AnalysisCache.h"
 #include "LoopOverlay.h"
+#include "SeamMetrics.h"
+#include "ZeroCrossingIndex.h"
 #include <wx/busyinfo.h>
 #include "sndfile.hh"
 #include <wx/settings.h>
 #include <wx/filename.h>
+#include <wx/display.h>
 #include "ListInfoDialog.h"
 #include "AudioSettingsDialog.h"
 #include "FreePixelIcons.h"
 
-bool MyFrame::loopPlay = true; // default to loop play
-int MyFrame::volumeMultiplier = 1; // default value
 
 // Event table
 BEGIN_EVENT_TABLE(MyFrame, wxFrame)
@@ -49,6 +51,8 @@ BEGIN_EVENT_TABLE(MyFrame, wxFrame)
   EVT_MENU(wxID_SAVE, MyFrame::OnSaveFile)
   EVT_MENU(wxID_SAVEAS, MyFrame::OnSaveFileAs)
   EVT_MENU(EDIT_LOOP, MyFrame::OnEditLoop)
+  EVT_MENU(SNAP_LOOP_START, MyFrame::OnSnapLoop)
+  EVT_MENU(SNAP_LOOP_END, MyFrame::OnSnapLoop)
   EVT_TOOL(VIEW_LOOPPOINTS, MyFrame::OnViewLoop)
   EVT_MENU(LOOP_ONLY, MyFrame::OnLoopPlayback)
   EVT_MENU(SAVE_AND_OPEN_NEXT, MyFrame::OnSaveOpenNext)
@@ -76,6 +80,10 @@ BEGIN_EVENT_TABLE(MyFrame, wxFrame)
   EVT_TOOL(PITCH_SETTINGS, MyFrame::OnPitchSettings)
   EVT_TOOL(ZOOM_IN_AMP, MyFrame::OnZoomInAmplitude)
   EVT_TOOL(ZOOM_OUT_AMP, MyFrame::OnZoomOutAmplitude)
+  EVT_MENU(ZOOM_IN_TIME, MyFrame::OnZoomInTime)
+  EVT_MENU(ZOOM_OUT_TIME, MyFrame::OnZoomOutTime)
+  EVT_MENU(ZOOM_ALL_TIME, MyFrame::OnZoomAllTime)
+  EVT_THREAD(FILELIST_STATS_READY, MyFrame::OnFileStatsReady)
   EVT_TIMER(TIMER_ID, MyFrame::UpdatePlayPosition)
   EVT_SLIDER(ID_VOLUME_SLIDER, MyFrame::OnVolumeSlider)
   EVT_TOOL(X_FADE, MyFrame::OnCrossfade)
@@ -130,6 +138,7 @@ void MyFrame::OnClose(wxCloseEvent& WXUNUSED(event)) {
   config->Write(wxT("General/FrameWidth"), m_frameWidth);
   config->Write(wxT("General/FrameHeight"), m_frameHeight);
   config->Write(wxT("General/FrameMaximized"), m_frameMaximized);
+  config->Write(wxT("General/UseAnalysisCache"), AnalysisCache::IsEnabled());
   config->Write(wxT("BatchProcess/LastSource"), m_batchProcess->GetLastSource());
   config->Write(wxT("BatchProcess/LastTarget"), m_batchProcess->GetLastTarget());
   config->Write(wxT("LoopSettings/AutoSearchSustain"), m_autoloopSettings->GetAutosearch());
@@ -143,12 +152,17 @@ void MyFrame::OnClose(wxCloseEvent& WXUNUSED(event)) {
   config->Write(wxT("LoopSettings/Candidates"), m_autoloopSettings->GetCandidates());
   config->Write(wxT("LoopSettings/LoopsToReturn"), m_autoloopSettings->GetNrLoops());
   config->Write(wxT("LoopSettings/LoopPoolMultiple"), m_autoloopSettings->GetMultiple());
+  config->Write(wxT("LoopSettings/SeamSearchRadius"), m_seamSearchRadius);
   config->Write(wxT("Audio/Api"), m_sound->GetApi());
   config->Write(wxT("Audio/Device"), m_sound->GetDevice());
+  config->Write(wxT("Audio/StreamingThresholdMB"), (long) FileHandling::GetStreamingThreshold());
+  config->Write(wxT("Audio/LowLatency"), m_sound->IsLowLatency());
+  config->Write(wxT("Audio/LowLatencyBufferFrames"), (long) m_sound->GetLowLatencyBufferFrames());
   config->Write(wxT("Pitch/PitchMethod"), m_pitchMethod);
   config->Write(wxT("Pitch/SpectrumFftSize"), m_spectrumFftSize);
   config->Write(wxT("Pitch/SpectrumWindow"), m_spectrumWindow);
   config->Write(wxT("Pitch/SpectrumInterpolatePitch"), m_spectrumInterpolatePitch);
+  config->Write(wxT("Pitch/HPSHarmonics"), (long) FileHandling::GetDefaultHPSHarmonics());
   
   config->Flush();
 
@@ -225,7 +239,7 @@ void MyFrame::OpenAudioFile() {
     wxFileName fullFilePath(filePath);
     m_panel->SetFileNameLabel(fullFilePath);
 
-    SetStatusText(wxString::Format(wxT("Zoom level: x %i"), m_waveform->GetAmplitudeZoomLevel()), 1);
+    UpdateZoomStatus();
 
     UpdateLoopsAndCuesDisplay();
 
@@ -248,6 +262,9 @@ void MyFrame::OpenAudioFile() {
     toolBar->EnableTool(ZOOM_OUT_AMP, true);
     viewMenu->Enable(ZOOM_IN_AMP, true);
     viewMenu->Enable(ZOOM_OUT_AMP, true);
+    viewMenu->Enable(ZOOM_IN_TIME, true);
+    viewMenu->Enable(ZOOM_OUT_TIME, true);
+    viewMenu->Enable(ZOOM_ALL_TIME, true);
     toolBar->EnableTool(CUT_N_FADE, true);
     toolMenu->Enable(CUT_N_FADE, true);
     toolBar->EnableTool(LIST_INFO, true);
@@ -267,18 +284,6 @@ void MyFrame::OpenAudioFile() {
       toolMenu->Enable(VIEW_LOOPPOINTS, true);
       SetLoopPlayback(true);
     }
-
-    if (m_sound->StreamNeedsResampling()) {
-      // initialize samplerate converter
-      m_resampler = new MyResampler(m_audiofile->m_channels);
-      // fill resample data struct with values
-      double src_ratio = (1.0 * m_sound->GetSampleRateToUse()) / (1.0 * m_audiofile->GetSampleRate());
-      m_resampler->SetDataEndOfInput(0); // Set this later
-      m_resampler->SetDataInputFrames(m_audiofile->ArrayLength / m_audiofile->m_channels);
-      m_resampler->SetDataIn(m_audiofile->floatAudioData);
-      m_resampler->SetDataSrcRatio(src_ratio);
-      m_resampler->SimpleResample(m_audiofile->m_channels);
-    }
   } else {
     // libsndfile couldn't open the file or no audio data in file
     wxString message = wxT("Sorry, libsndfile couldn't open selected file:\n");
@@ -309,12 +314,6 @@ void MyFrame::CloseOpenAudioFile() {
     DoStopPlay();
   }
 
-  // Cleanup samplerate converter
-  if (m_resampler != NULL) {
-    delete m_resampler;
-    m_resampler = 0;
-  }
-
   toolBar->EnableTool(START_PLAYBACK, false);
   transportMenu->Enable(START_PLAYBACK, false);
 
@@ -338,6 +337,9 @@ void MyFrame::CloseOpenAudioFile() {
   toolBar->EnableTool(ZOOM_OUT_AMP, false);
   viewMenu->Enable(ZOOM_IN_AMP, false);
   viewMenu->Enable(ZOOM_OUT_AMP, false);
+  viewMenu->Enable(ZOOM_IN_TIME, false);
+  viewMenu->Enable(ZOOM_OUT_TIME, false);
+  viewMenu->Enable(ZOOM_ALL_TIME, false);
   toolBar->EnableTool(X_FADE, false);
   toolMenu->Enable(X_FADE, false);
   toolBar->EnableTool(VIEW_LOOPPOINTS, false);
@@ -352,6 +354,8 @@ void MyFrame::CloseOpenAudioFile() {
   if (m_audiofile)
     m_panel->EmptyTable();
   if (m_audiofile != NULL) {
+    // keep the analysis results of the closed file
+    AnalysisCache::Flush(m_audiofile->GetFilePath());
     delete m_audiofile;
     m_audiofile = 0;
   }
@@ -385,13 +389,13 @@ void MyFrame::OnGridCellClick(wxGridEvent& event) {
     LOOPDATA currentLoop;
     m_audiofile->m_loops->GetLoopData(event.GetRow(), currentLoop);
     if (!m_loopOnly)
-      m_sound->SetLoopPosition(0, currentLoop.dwStart, currentLoop.dwEnd, m_audiofile->m_channels);
+      m_sound->SetLoopPosition(0, currentLoop.dwStart, currentLoop.dwEnd);
     else {
       if (((double) (currentLoop.dwEnd - currentLoop.dwStart)) / (double) m_audiofile->GetSampleRate() > 0.5) {
         unsigned pos = currentLoop.dwEnd - (m_audiofile->GetSampleRate() / 2);
-        m_sound->SetLoopPosition(pos, currentLoop.dwStart, currentLoop.dwEnd, m_audiofile->m_channels);
+        m_sound->SetLoopPosition(pos, currentLoop.dwStart, currentLoop.dwEnd);
       } else {
-        m_sound->SetLoopPosition(currentLoop.dwStart, currentLoop.dwStart, currentLoop.dwEnd, m_audiofile->m_channels);
+        m_sound->SetLoopPosition(currentLoop.dwStart, currentLoop.dwStart, currentLoop.dwEnd);
       }
     }
 
@@ -441,7 +445,7 @@ void MyFrame::OnCueGridCellClick(wxGridEvent& event) {
     // set the current position for the selected cue
     CUEPOINT currentCue;
     m_audiofile->m_cues->GetCuePoint(event.GetRow(), currentCue);
-    m_sound->SetLoopPosition(currentCue.dwSampleOffset, currentCue.dwSampleOffset, currentCue.dwSampleOffset, m_audiofile->m_channels);
+    m_sound->SetLoopPosition(currentCue.dwSampleOffset, currentCue.dwSampleOffset, currentCue.dwSampleOffset);
 
     SetLoopPlayback(false); // set the playback to not be for loops
 
@@ -497,6 +501,9 @@ void MyFrame::UpdateCurrentFileInfo() {
   double cents = (double) m_audiofile->m_loops->GetMIDIPitchFraction() / (double)UINT_MAX * 100.0;
   wxString fraction = wxString::Format(wxT("%.2f"), cents);
   m_fileListCtrl->SetItem(currentOpenFileIdx, 4, fraction);
+
+  // the audio may have been edited so the file is scanned again
+  m_listScanner->Request(currentOpenFileIdx, workingDir + wxFILE_SEP_PATH + fileToOpen);
 }
 
 void MyFrame::OnSaveFile(wxCommandEvent& WXUNUSED(event)) {
@@ -586,7 +593,55 @@ void MyFrame::OnSaveFileAs(wxCommandEvent& WXUNUSED(event)) {
 void MyFrame::OnStartPlay(wxCommandEvent& WXUNUSED(event)) {
   m_sound->OpenAudioStream();
   if (m_sound->IsStreamAvailable()) {
-    m_timer.Start(50);
+    // the data must not change while the stream runs, if the device uses
+    // another samplerate the engine resamples while playing
+    double ratio = 1.0;
+    if (m_sound->StreamNeedsResampling())
+      ratio = (1.0 * m_sound->GetSampleRateToUse()) / (1.0 * m_audiofile->GetSampleRate());
+    bool streaming = false;
+    if (m_audiofile->IsPlaybackStreamed()) {
+      wxString filePath = m_audiofile->GetFilePath() + wxFILE_SEP_PATH + m_audiofile->GetFileName();
+      streaming = m_sound->GetPlaybackEngine()->SetStreamedAudio(
+        filePath,
+        m_audiofile->ArrayLength / m_audiofile->m_channels,
+        m_audiofile->m_channels,
+        m_audiofile->GetSampleRate(),
+        ratio
+      );
+      // if the file can't be read again it's played from memory after all
+      if (!streaming)
+        m_audiofile->EnsurePlaybackData();
+    }
+    if (!streaming) {
+      bool audioIsSet = m_sound->GetPlaybackEngine()->SetAudioData(
+        m_audiofile->floatAudioData,
+        m_audiofile->ArrayLength / m_audiofile->m_channels,
+        m_audiofile->m_channels,
+        ratio
+      );
+      // rather nothing than playing at the wrong speed
+      if (!audioIsSet) {
+        m_sound->CloseAudioStream();
+        wxMessageDialog dialog(
+          this,
+          m_sound->GetPlaybackEngine()->GetLastError(),
+          wxT("Playback is not possible!"),
+          wxOK | wxICON_ERROR
+        );
+        dialog.ShowModal();
+        return;
+      }
+    }
+    // the cursor follows at the refresh rate of the display
+    int refreshRate = 60;
+    int displayIdx = wxDisplay::GetFromWindow(this);
+    if (displayIdx != wxNOT_FOUND) {
+      wxVideoMode mode = wxDisplay(displayIdx).GetCurrentMode();
+      if (mode.refresh > 0)
+        refreshRate = mode.refresh;
+    }
+    m_waveform->SetPlaybackActive(true);
+    m_timer.Start(1000 / refreshRate);
     // if it's a loop make sure start position is set to start of data
     // or to within the loop if that option is ticked
     if (m_panel->m_grid->IsSelection()) {
@@ -595,23 +650,17 @@ void MyFrame::OnStartPlay(wxCommandEvent& WXUNUSED(event)) {
       wxArrayInt selectedRows = m_panel->m_grid->GetSelectedRows();
       int firstSelected = selectedRows[0];
       m_audiofile->m_loops->GetLoopData(firstSelected, currentLoop);
-      m_sound->SetLoopPosition(0, currentLoop.dwStart, currentLoop.dwEnd, m_audiofile->m_channels);
+      m_sound->SetLoopPosition(0, currentLoop.dwStart, currentLoop.dwEnd);
       if (!m_loopOnly) {
-        m_sound->SetStartPosition(0, m_audiofile->m_channels);
+        m_sound->SetStartPosition(0);
         m_waveform->SetPlayPosition(0);
       } else {
         if (((double) (currentLoop.dwEnd - currentLoop.dwStart)) / (double) m_audiofile->GetSampleRate() > 0.5) {
           unsigned pos = currentLoop.dwEnd - (m_audiofile->GetSampleRate() / 2);
-          if (m_sound->StreamNeedsResampling())
-            m_sound->SetStartPosition(pos * m_resampler->GetRatioUsed(), m_audiofile->m_channels);
-          else
-            m_sound->SetStartPosition(pos, m_audiofile->m_channels);
+          m_sound->SetStartPosition(pos);
           m_waveform->SetPlayPosition(pos);
         } else {
-          if (m_sound->StreamNeedsResampling())
-            m_sound->SetStartPosition(currentLoop.dwStart * m_resampler->GetRatioUsed(), m_audiofile->m_channels);
-          else
-            m_sound->SetStartPosition(currentLoop.dwStart, m_audiofile->m_channels);
+          m_sound->SetStartPosition(currentLoop.dwStart);
           m_waveform->SetPlayPosition(currentLoop.dwStart);
         }
       }
@@ -621,11 +670,7 @@ void MyFrame::OnStartPlay(wxCommandEvent& WXUNUSED(event)) {
     if (m_panel->m_cueGrid->IsSelection()) {
       CUEPOINT currentCue;
       m_audiofile->m_cues->GetCuePoint(m_panel->m_cueGrid->GetGridCursorRow(), currentCue);
-      if (m_sound->StreamNeedsResampling()) {
-        m_sound->SetStartPosition(currentCue.dwSampleOffset * m_resampler->GetRatioUsed(), m_audiofile->m_channels);
-      } else {
-        m_sound->SetStartPosition(currentCue.dwSampleOffset, m_audiofile->m_channels);
-      }
+      m_sound->SetStartPosition(currentCue.dwSampleOffset);
       m_waveform->SetPlayPosition(currentCue.dwSampleOffset);
     }
 
@@ -664,16 +709,17 @@ void MyFrame::DoStopPlay() {
   transportMenu->Enable(wxID_STOP, false);
 
   m_waveform->SetPlayPosition(0);
-  m_waveform->paintNow();
+  m_waveform->SetPlaybackActive(false);
 
   m_sound->CloseAudioStream();
+  m_sound->GetPlaybackEngine()->ReleaseAudio();
 
 }
 
 MyFrame::MyFrame(const wxString& title) : wxFrame(NULL, wxID_ANY, title), m_timer(this, TIMER_ID) {
   m_audiofile = NULL;
   m_waveform = NULL;
-  m_resampler = NULL;
+  m_listScanner = NULL;
   m_autoloopSettings = new AutoLoopDialog(this);
   m_autoloop = new AutoLooping();
   m_crossfades = new CrossfadeDialog(this);
@@ -720,9 +766,16 @@ MyFrame::MyFrame(const wxString& title) : wxFrame(NULL, wxID_ANY, title), m_time
   // Add view menu items
   viewMenu->Append(ZOOM_IN_AMP, wxT("Zoom &in\tCtrl++"), wxT("Zoom in on amplitude"));
   viewMenu->Append(ZOOM_OUT_AMP, wxT("Zoom &out\tCtrl+-"), wxT("Zoom out on amplitude"));
+  viewMenu->AppendSeparator();
+  viewMenu->Append(ZOOM_IN_TIME, wxT("Zoom in on &time\tCtrl+Alt++"), wxT("Zoom in on time (also Ctrl + mouse wheel)"));
+  viewMenu->Append(ZOOM_OUT_TIME, wxT("Zoom out on ti&me\tCtrl+Alt+-"), wxT("Zoom out on time (also Ctrl + mouse wheel)"));
+  viewMenu->Append(ZOOM_ALL_TIME, wxT("Show &whole file\tCtrl+Alt+0"), wxT("Zoom out to show the whole file"));
 
   viewMenu->Enable(ZOOM_IN_AMP, false);
   viewMenu->Enable(ZOOM_OUT_AMP, false);
+  viewMenu->Enable(ZOOM_IN_TIME, false);
+  viewMenu->Enable(ZOOM_OUT_TIME, false);
+  viewMenu->Enable(ZOOM_ALL_TIME, false);
 
   // Create a transport menu
   transportMenu = new wxMenu();
@@ -779,10 +832,12 @@ MyFrame::MyFrame(const wxString& title) : wxFrame(NULL, wxID_ANY, title), m_time
   m_loopPopupMenu->Append(EDIT_LOOP, wxT("&Edit loop"), wxT("Edit the currently selected loop"));
   m_loopPopupMenu->Append(X_FADE, wxT("&Crossfade loop"), wxT("Crossfade the currently selected loop"));
   m_loopPopupMenu->Append(VIEW_LOOPPOINTS, wxT("&View looppoints"), wxT("Closeup view of overlayed looppoints"));
+  m_loopPopupMenu->Append(SNAP_LOOP_START, wxT("Snap &start to best match"), wxT("Move the loop start to where the seam matches best"));
+  m_loopPopupMenu->Append(SNAP_LOOP_END, wxT("Snap e&nd to best match"), wxT("Move the loop end to where the seam matches best"));
 
   // Create Status bar
   CreateStatusBar(3);
-  int statusWidths[3] = { -1, 150, -2 };
+  int statusWidths[3] = { -1, 200, -2 };
   SetStatusWidths(3, statusWidths);
   SetStatusText(wxT("Ready"), 0);
 
@@ -878,6 +933,7 @@ MyFrame::MyFrame(const wxString& title) : wxFrame(NULL, wxID_ANY, title), m_time
     ID_LISTCTRL
   );
   m_fileListCtrl->SetMinSize(wxSize(385,150));
+  m_listScanner = new FileListScanner(this, FILELIST_STATS_READY);
   hbox->Add(m_fileListCtrl, 1, wxEXPAND | wxLEFT | wxTOP, 10);
 
   m_panel = new MyPanel(this);
@@ -894,13 +950,17 @@ MyFrame::MyFrame(const wxString& title) : wxFrame(NULL, wxID_ANY, title), m_time
   SetMinSize(wxSize(1000,560));
 
   // adjust width of the list control columns
-  int colWidth = m_fileListCtrl->GetClientSize().GetWidth() / 5;
+  int colWidth = m_fileListCtrl->GetClientSize().GetWidth() / 9;
 
   m_fileListCtrl->InsertColumn(0, wxT("File name"), wxLIST_FORMAT_LEFT, colWidth);
   m_fileListCtrl->InsertColumn(1, wxT("Loops"), wxLIST_FORMAT_CENTRE, colWidth);
   m_fileListCtrl->InsertColumn(2, wxT("Cues"), wxLIST_FORMAT_CENTRE, colWidth);
   m_fileListCtrl->InsertColumn(3, wxT("Note"), wxLIST_FORMAT_CENTRE, colWidth);
   m_fileListCtrl->InsertColumn(4, wxT("Fraction"), wxLIST_FORMAT_CENTRE, colWidth);
+  m_fileListCtrl->InsertColumn(5, wxT("Waveform"), wxLIST_FORMAT_LEFT, LISTCTRL_THUMBNAIL_WIDTH + 8);
+  m_fileListCtrl->InsertColumn(6, wxT("Length (s)"), wxLIST_FORMAT_RIGHT, colWidth);
+  m_fileListCtrl->InsertColumn(7, wxT("Peak (dB)"), wxLIST_FORMAT_RIGHT, colWidth);
+  m_fileListCtrl->InsertColumn(8, wxT("RMS (dB)"), wxLIST_FORMAT_RIGHT, colWidth);
 
   // create sound output
   wxString apiStr;
@@ -916,8 +976,18 @@ MyFrame::MyFrame(const wxString& title) : wxFrame(NULL, wxID_ANY, title), m_time
     // we set it too high so that the default device will be used instead
     deviceId = INT_MAX;
   }
+  long streamingThreshold;
+  if (config->Read(wxT("Audio/StreamingThresholdMB"), &streamingThreshold) && streamingThreshold >= 0)
+    FileHandling::SetStreamingThreshold((unsigned) streamingThreshold);
+
   m_sound = new MySound(apiStr, (unsigned) deviceId);
 
+  bool lowLatency = false;
+  long lowLatencyFrames = 128;
+  config->Read(wxT("Audio/LowLatency"), &lowLatency);
+  config->Read(wxT("Audio/LowLatencyBufferFrames"), &lowLatencyFrames);
+  m_sound->SetLowLatency(lowLatency, (unsigned) lowLatencyFrames);
+
   if (config->Read(wxT("General/LastWorkingDir"), &workingDir)) {
     // if value was found it's now in the variable workingDir
   } else {
@@ -929,7 +999,7 @@ MyFrame::MyFrame(const wxString& title) : wxFrame(NULL, wxID_ANY, title), m_time
   if (config->Read(wxT("General/LastVolume"), &readInt)) {
     wxSlider *volumeSl = (wxSlider*) FindWindow(ID_VOLUME_SLIDER);
     volumeSl->SetValue(readInt);
-    volumeMultiplier = (int) (pow(2, (double) readInt));
+    m_sound->GetPlaybackEngine()->SetGain((float) pow(2, (double) readInt));
   }
 
   bool b;
@@ -956,6 +1026,9 @@ MyFrame::MyFrame(const wxString& title) : wxFrame(NULL, wxID_ANY, title), m_time
   if (config->Read(wxT("General/FrameMaximized"), &b))
     m_frameMaximized = b;
 
+  if (config->Read(wxT("General/UseAnalysisCache"), &b))
+    AnalysisCache::SetEnabled(b);
+
   wxString str;
   if (config->Read(wxT("BatchProcess/LastSource"), &str))
     m_batchProcess->SetLastSource(str);
@@ -1013,6 +1086,12 @@ MyFrame::MyFrame(const wxString& title) : wxFrame(NULL, wxID_ANY, title), m_time
     m_autoloop->SetMultiple(readInt);
   }
 
+  if (config->Read(wxT("LoopSettings/SeamSearchRadius"), &readInt)) {
+    SetSeamSearchRadius(readInt);
+  } else {
+    SetSeamSearchRadius(SEAM_SEARCH_RADIUS);
+  }
+
   if (config->Read(wxT("Pitch/PitchMethod"), &readInt)) {
     SetPitchMethod(readInt);
   } else {
@@ -1037,6 +1116,12 @@ MyFrame::MyFrame(const wxString& title) : wxFrame(NULL, wxID_ANY, title), m_time
     SetSpectrumInterpolatePitch(false);
   }
 
+  if (config->Read(wxT("Pitch/HPSHarmonics"), &readInt)) {
+    SetHPSHarmonics(readInt);
+  } else {
+    SetHPSHarmonics(5);
+  }
+
   if (m_frameMaximized)
     Maximize();
   else if (m_xPosition != 0 && m_yPosition != 0)
@@ -1049,14 +1134,15 @@ MyFrame::MyFrame(const wxString& title) : wxFrame(NULL, wxID_ANY, title), m_time
 MyFrame::~MyFrame() {
   delete config;
 
-  if (m_resampler) {
-    delete m_resampler;
-    m_resampler = 0;
-  }
+  // the workers must be stopped before the list they report to goes away
+  if (m_listScanner)
+    delete m_listScanner;
+
   if (m_audiofile) {
     delete m_audiofile;
     m_audiofile = 0;
   }
+  AnalysisCache::FlushAll();
   if (m_sound) {
     m_sound->StopAudioStream();
     m_sound->CloseAudioStream();
@@ -1118,95 +1204,8 @@ void MyFrame::PopulateListOfFileNames() {
   }
 }
 
-int MyFrame::AudioCallback(void *outputBuffer,
-                           void *inputBuffer,
-                           unsigned nBufferFrames,
-                           double streamTime,
-                           RtAudioStreamStatus status,
-                           void *userData ) {
-  (void)inputBuffer;
-  (void)streamTime;
-  (void)status;
-  unsigned nChannels = (unsigned) ::wxGetApp().frame->m_audiofile->m_channels;
-  unsigned useChannels = ::wxGetApp().frame->m_sound->GetChannelsUsed();
-  unsigned excessChannels = 0;
-  if (nChannels > useChannels)
-    excessChannels = nChannels - useChannels;
-
-  float *buffer = static_cast<float*>(outputBuffer);
-
-  // keep track of position, see pos in MySound.h
-  unsigned *position = (unsigned *) userData;
-
-  if (::wxGetApp().frame->m_sound->StreamNeedsResampling()) {
-    // audio stream uses the resampled audio data
-    if (position[0] < ::wxGetApp().frame->m_resampler->m_resampledDataLength) {
-      for (unsigned i = 0; i < nBufferFrames; i++) {
-        for (unsigned j = 0; j < useChannels; j++) {
-          *buffer++ = ::wxGetApp().frame->m_resampler->resampledAudioData[(position[0])] * volumeMultiplier;
-          position[0] += 1;
-        }
-
-        if (excessChannels)
-          position[0] += excessChannels;
-
-        if (loopPlay) {
-          // Check to control loop playback, see MySound.h pos member and MyFrame.h loopPlay member
-          if (position[0] > lround(position[2] / nChannels * ::wxGetApp().frame->m_resampler->GetRatioUsed()) * nChannels )
-            position[0] = lround(position[1] / nChannels * ::wxGetApp().frame->m_resampler->GetRatioUsed()) * nChannels;
-        }
-
-        // stop if end of file data is reached and reset current position to start of the cue
-        if (position[0] > ::wxGetApp().frame->m_resampler->m_resampledDataLength - 1) {
-          wxCommandEvent evt(wxEVT_COMMAND_TOOL_CLICKED, wxID_STOP);
-          ::wxGetApp().frame->AddPendingEvent(evt);
-
-          return 0;
-        }
-      }
-    } else {
-      // we end up here until buffer is drained?
-    }
-  } else {
-    // Loop that feeds the outputBuffer with data when no resampling is needed
-    if (position[0] < ::wxGetApp().frame->m_audiofile->ArrayLength) {
-      for (unsigned i = 0; i < nBufferFrames; i++) {
-        for (unsigned j = 0; j < useChannels; j++) {
-          *buffer++ = ::wxGetApp().frame->m_audiofile->floatAudioData[(position[0])] * volumeMultiplier;
-          position[0] += 1;
-        }
-
-        if (excessChannels)
-          position[0] += excessChannels;
-
-        if (loopPlay) {
-          // Check to control loop playback, see MySound.h pos member and MyFrame.h loopPlay member
-          if (position[0] > position[2])
-            position[0] = position[1];
-        }
-
-        // stop if end of file data is reached and reset current position to start of the cue
-        if (position[0] > ::wxGetApp().frame->m_audiofile->ArrayLength - 1) {
-          wxCommandEvent evt(wxEVT_COMMAND_TOOL_CLICKED, wxID_STOP);
-          ::wxGetApp().frame->AddPendingEvent(evt);
-
-          return 0;
-        }
-      }
-    } else {
-      // we end up here until buffer is drained?
-    }
-  }
-
-  return 0;
-
-}
-
 void MyFrame::SetLoopPlayback(bool looping) {
-  if (looping)
-    loopPlay = true;
-  else
-    loopPlay = false;
+  m_sound->GetPlaybackEngine()->SetLooping(looping);
 }
 
 void MyFrame::SetPitchMethod(int method) {
@@ -1234,13 +1233,32 @@ void MyFrame::SetSpectrumInterpolatePitch(bool interpolate) {
   m_spectrumInterpolatePitch = interpolate;
 }
 
+void MyFrame::SetHPSHarmonics(int harmonics) {
+  // the batch processes open their files with the same number of harmonics
+  FileHandling::SetDefaultHPSHarmonics(harmonics);
+  if (m_audiofile)
+    m_audiofile->SetHPSHarmonics(harmonics);
+}
+
+void MyFrame::SetSeamSearchRadius(int radius) {
+  if (radius >= 10 && radius <= SEAM_SEARCH_MAX_RADIUS)
+    m_seamSearchRadius = radius;
+  else
+    m_seamSearchRadius = SEAM_SEARCH_RADIUS;
+}
+
 
 void MyFrame::UpdatePlayPosition(wxTimerEvent& WXUNUSED(event)) {
-  if (m_waveform && m_audiofile->m_channels != 0) {
-    if (m_sound->StreamNeedsResampling())
-      m_waveform->SetPlayPosition((m_sound->pos[0] / m_audiofile->m_channels) / m_resampler->GetRatioUsed());
-    else
-      m_waveform->SetPlayPosition(m_sound->pos[0] / m_audiofile->m_channels);
+  // the audio callback only flags the end of data, stopping is done from here
+  if (m_sound->GetPlaybackEngine()->HasReachedEnd()) {
+    DoStopPlay();
+    return;
+  }
+
+  if (m_waveform) {
+    // what is heard now left the callback one output latency ago
+    double heardTime = m_sound->GetStreamTime() - m_sound->GetStreamLatency();
+    m_waveform->SetPlayPosition(m_sound->GetPlaybackEngine()->GetPlayPositionAt(heardTime, m_audiofile->GetSampleRate()));
     m_waveform->paintNow();
   }
 }
@@ -1282,39 +1300,21 @@ void MyFrame::OnAddLoop(wxCommandEvent& WXUNUSED(event)) {
   std::pair<unsigned, unsigned> currentSustain = m_audiofile->GetSustainsection();
   unsigned start = currentSustain.first;
   unsigned end = currentSustain.second;
-  // get audio data to analyze
-  unsigned nbrOfSmpls = m_audiofile->ArrayLength / m_audiofile->m_channels;
-  double *audioData = new double[nbrOfSmpls];
-  m_audiofile->SeparateStrongestChannel(audioData);
-  // adjust to reasonable loop points
+  // adjust to reasonable loop points in the strongest channel
+  int strongestChannel = m_audiofile->GetStrongestChannel();
+  ZeroCrossingIndex *zeroCrossings = m_audiofile->GetZeroCrossingIndex();
+  ZERO_CROSSING crossing;
   // search for closest (going towards positive) zero crossing
   unsigned startIdx = start;
-  for (unsigned i = start; i < end; i++) {
-    if (signbit(audioData[i])) {
-      if (!signbit(audioData[i + 1]) != !signbit(audioData[i])) {
-        // which is closer to zero
-        if (fabs(audioData[i]) < fabs(audioData[i + 1])) {
-          startIdx = i;
-          break;
-        } else {
-          startIdx = i + 1;
-          break;
-        }
-      }
-    }
+  if (zeroCrossings->FindNext(strongestChannel, ZERO_CROSSING_RISING, start + 1, crossing) && crossing.index <= end) {
+    // which is closer to zero
+    startIdx = ZeroCrossingIndex::GetClosestSample(crossing);
   }
   // find a suitable match from end
   unsigned endIdx = end;
-  for (unsigned i = end; i > startIdx; i--) {
-    if (!signbit(audioData[i])) {
-      if (signbit(audioData[i - 1]) != signbit(audioData[i])) {
-        endIdx = i - 1;
-          break;
-      }
-    }
+  if (zeroCrossings->FindPrevious(strongestChannel, ZERO_CROSSING_RISING, end, crossing) && crossing.index > startIdx) {
+    endIdx = crossing.index - 1;
   }
-  // clean up
-  delete[] audioData;
   LoopParametersDialog loopDialog(startIdx, endIdx, m_audiofile->ArrayLength / m_audiofile->m_channels, this);
 
   if (loopDialog.ShowModal() == wxID_OK) {
@@ -1580,8 +1580,15 @@ void MyFrame::OnPitchSettings(wxCommandEvent& WXUNUSED(event)) {
   dialog.SetPreferredFftSize(m_spectrumFftSize);
   dialog.SetPreferredWindow(m_spectrumWindow);
   dialog.SetPreferredInterpolatePitch(m_spectrumInterpolatePitch);
+  if (m_sound->IsStreamActive())
+    dialog.SetPreviewEngine(m_sound->GetPlaybackEngine());
 
-  if (dialog.ShowModal() == wxID_OK) {
+  int answer = dialog.ShowModal();
+
+  // the preview is only heard while the dialog is open
+  m_sound->GetPlaybackEngine()->SetPitchCorrection(0);
+
+  if (answer == wxID_OK) {
     dialog.TransferSelectedPitchToFile();
     // enable save icon and menu
     toolBar->EnableTool(wxID_SAVE, true);
@@ -1592,25 +1599,49 @@ void MyFrame::OnPitchSettings(wxCommandEvent& WXUNUSED(event)) {
   m_spectrumFftSize = dialog.GetFftSize();
   m_spectrumWindow = dialog.GetWindowType();
   m_spectrumInterpolatePitch = dialog.GetInterpolatePitch();
+  SetHPSHarmonics(dialog.GetHPSHarmonics());
 }
 
 void MyFrame::OnZoomInAmplitude(wxCommandEvent& WXUNUSED(event)) {
   m_waveform->ZoomInAmplitude();
-  SetStatusText(wxString::Format(wxT("Zoom level: x %i"), m_waveform->GetAmplitudeZoomLevel()), 1);
+  UpdateZoomStatus();
   UpdateAllViews();
 }
 
 void MyFrame::OnZoomOutAmplitude(wxCommandEvent& WXUNUSED(event)) {
   m_waveform->ZoomOutAmplitude();
-  SetStatusText(wxString::Format(wxT("Zoom level: x %i"), m_waveform->GetAmplitudeZoomLevel()), 1);
+  UpdateZoomStatus();
+  UpdateAllViews();
+}
+
+void MyFrame::OnZoomInTime(wxCommandEvent& WXUNUSED(event)) {
+  m_waveform->ZoomInTime();
+  UpdateZoomStatus();
+  UpdateAllViews();
+}
+
+void MyFrame::OnZoomOutTime(wxCommandEvent& WXUNUSED(event)) {
+  m_waveform->ZoomOutTime();
+  UpdateZoomStatus();
   UpdateAllViews();
 }
 
+void MyFrame::OnZoomAllTime(wxCommandEvent& WXUNUSED(event)) {
+  m_waveform->ZoomAllTime();
+  UpdateZoomStatus();
+  UpdateAllViews();
+}
+
+void MyFrame::UpdateZoomStatus() {
+  if (m_waveform)
+    SetStatusText(wxString::Format(wxT("Zoom level: x %i, time x %.0f"), m_waveform->GetAmplitudeZoomLevel(), m_waveform->GetTimeZoomFactor()), 1);
+}
+
 void MyFrame::OnVolumeSlider(wxCommandEvent& WXUNUSED(event)) {
   wxSlider *volumeSl = (wxSlider*) FindWindow(ID_VOLUME_SLIDER);
   int value = volumeSl->GetValue();
 
-  volumeMultiplier = (int) (pow(2, (double) value));
+  m_sound->GetPlaybackEngine()->SetGain((float) pow(2, (double) value));
 }
 
 void MyFrame::OnCrossfade(wxCommandEvent& WXUNUSED(event)) {
@@ -1626,26 +1657,27 @@ void MyFrame::OnCrossfade(wxCommandEvent& WXUNUSED(event)) {
   wxString dialogTitle = wxString::Format(wxT("Crossfading parameters for Loop %i"), firstSelected + 1);
   m_crossfades->SetCaption(dialogTitle);
 
+  // let the current settings be heard at the playing loop
+  if (m_sound->IsStreamActive())
+    m_crossfades->SetAuditionEngine(m_sound->GetPlaybackEngine(), m_audiofile->GetSampleRate());
+
   // show the crossfade dialog to get parameters (method and time)
-  if (m_crossfades->ShowModal() == wxID_OK) {
+  int answer = m_crossfades->ShowModal();
+
+  // nothing is auditioned once the dialog is closed
+  m_crossfades->SetAuditionEngine(NULL, 0);
+
+  if (answer == wxID_OK) {
+    // the audio data is about to change under the playback engine
+    if (m_sound->IsStreamActive())
+      DoStopPlay();
+
     double crossfadeTime = m_crossfades->GetFadeduration();
     int crossfadetype = m_crossfades->GetFadetype();
 
     // perform crossfading on the first selected loop with selected method
     m_audiofile->PerformCrossfade(firstSelected, crossfadeTime, crossfadetype);
     
-    // if resampled audio is used it must be updated too!
-    if (m_sound->StreamNeedsResampling()) {
-      m_resampler->ResetState();
-      // fill resample data struct with values
-      double src_ratio = (1.0 * m_sound->GetSampleRateToUse()) / (1.0 * m_audiofile->GetSampleRate());
-      m_resampler->SetDataEndOfInput(0); // Set this later
-      m_resampler->SetDataInputFrames(m_audiofile->ArrayLength / m_audiofile->m_channels);
-      m_resampler->SetDataIn(m_audiofile->floatAudioData);
-      m_resampler->SetDataSrcRatio(src_ratio);
-      m_resampler->SimpleResample(m_audiofile->m_channels);
-    }
-
     // Enable save icon and menu
     toolBar->EnableTool(wxID_SAVE, true);
     fileMenu->Enable(wxID_SAVE, true);
@@ -1698,7 +1730,7 @@ void MyFrame::OnEditLoop(wxCommandEvent& WXUNUSED(event)) {
     m_waveform->ChangeLoopPositions(currentLoop.dwStart, currentLoop.dwEnd, firstSelected);
 
     // Set loops positions for playback
-    m_sound->SetLoopPosition(0, currentLoop.dwStart, currentLoop.dwEnd, m_audiofile->m_channels);
+    m_sound->SetLoopPosition(0, currentLoop.dwStart, currentLoop.dwEnd);
 
     // Enable save icon and menu
     toolBar->EnableTool(wxID_SAVE, true);
@@ -1709,6 +1741,51 @@ void MyFrame::OnEditLoop(wxCommandEvent& WXUNUSED(event)) {
   }
 }
 
+void MyFrame::OnSnapLoop(wxCommandEvent& event) {
+  wxArrayInt selectedRows = m_panel->m_grid->GetSelectedRows();
+  int firstSelected;
+  if (!selectedRows.IsEmpty())
+    firstSelected = selectedRows[0];
+  else {
+    return;
+  }
+
+  bool moveEnd = event.GetId() == SNAP_LOOP_END;
+  LOOPDATA currentLoop;
+  m_audiofile->m_loops->GetLoopData(firstSelected, currentLoop);
+
+  std::vector<SEAM_MATCH> matches;
+  FindBestSeamMatches(m_audiofile, currentLoop.dwStart, currentLoop.dwEnd, moveEnd, m_seamSearchRadius, 1, matches);
+  if (matches.empty()) {
+    SetStatusText(wxT("No matching loop point found"), 0);
+    return;
+  }
+
+  if (moveEnd)
+    m_audiofile->m_loops->SetLoopPositions(currentLoop.dwStart, matches[0].position, firstSelected);
+  else
+    m_audiofile->m_loops->SetLoopPositions(matches[0].position, currentLoop.dwEnd, firstSelected);
+  m_audiofile->m_loops->GetLoopData(firstSelected, currentLoop);
+
+  // Change loop to the grid
+  int sRate = m_audiofile->GetSampleRate();
+  m_panel->ChangeLoopData(currentLoop.dwStart, currentLoop.dwEnd, sRate, firstSelected);
+
+  // Change loop in waveform drawer
+  m_waveform->ChangeLoopPositions(currentLoop.dwStart, currentLoop.dwEnd, firstSelected);
+
+  // Set loops positions for playback
+  m_sound->SetLoopPosition(0, currentLoop.dwStart, currentLoop.dwEnd);
+
+  // Enable save icon and menu
+  toolBar->EnableTool(wxID_SAVE, true);
+  fileMenu->Enable(wxID_SAVE, true);
+  fileMenu->Enable(SAVE_AND_OPEN_NEXT, true);
+
+  UpdateAllViews();
+  SetStatusText(wxString::Format(wxT("Loop %i snapped, seam error %.5f"), firstSelected + 1, matches[0].error), 0);
+}
+
 void MyFrame::OnViewLoop(wxCommandEvent& WXUNUSED(event)) {
   wxArrayInt selectedRows = m_panel->m_grid->GetSelectedRows();
   int firstSelected;
@@ -1727,8 +1804,10 @@ void MyFrame::OnViewLoop(wxCommandEvent& WXUNUSED(event)) {
     wxID_ANY,
     dialogTitle
   );
+  lpo.SetSearchRadius(m_seamSearchRadius);
 
   lpo.ShowModal();
+  m_seamSearchRadius = lpo.GetSearchRadius();
 
   // Update menus and views if loops are changed
   if (lpo.GetHasChanged()) {
@@ -1748,6 +1827,10 @@ void MyFrame::OnViewLoop(wxCommandEvent& WXUNUSED(event)) {
 void MyFrame::OnCutFade(wxCommandEvent& WXUNUSED(event)) {
   // show the cut & fade dialog to get parameters
   if (m_cutNFade->ShowModal() == wxID_OK) {
+    // the audio data is about to change under the playback engine
+    if (m_sound->IsStreamActive())
+      DoStopPlay();
+
     // update values
     m_cutNFade->TransferDataFromWindow();
 
@@ -1799,18 +1882,6 @@ void MyFrame::OnCutFade(wxCommandEvent& WXUNUSED(event)) {
 
     UpdateLoopsAndCuesDisplay();
 
-    // if resampled audio is used it must be updated too!
-    if (m_sound->StreamNeedsResampling()) {
-      m_resampler->ResetState();
-      // fill resample data struct with values
-      double src_ratio = (1.0 * m_sound->GetSampleRateToUse()) / (1.0 * m_audiofile->GetSampleRate());
-      m_resampler->SetDataEndOfInput(0); // Set this later
-      m_resampler->SetDataInputFrames(m_audiofile->ArrayLength / m_audiofile->m_channels);
-      m_resampler->SetDataIn(m_audiofile->floatAudioData);
-      m_resampler->SetDataSrcRatio(src_ratio);
-      m_resampler->SimpleResample(m_audiofile->m_channels);
-    }
-
     // then we should make sure to update the views
     UpdateAllViews();
   } else {
@@ -1852,6 +1923,7 @@ void MyFrame::OnAudioSettings(wxCommandEvent& WXUNUSED(event)) {
     audioDlg.TransferDataFromWindow();
     m_sound->SetApiToUse(RtAudio::getCompiledApiByName(std::string(audioDlg.GetSoundApi().mb_str())));
     m_sound->SetAudioDevice(audioDlg.GetSoundDeviceId());
+    m_sound->SetLowLatency(audioDlg.GetLowLatency(), audioDlg.GetLowLatencyBufferFrames());
     if (m_audiofile) {
       // if a file already is open we must adjust device parameters to it
       m_sound->SetSampleRate(m_audiofile->GetSampleRate());
@@ -1941,13 +2013,13 @@ void MyFrame::OnKeyboardInput(wxKeyEvent& event) {
           LOOPDATA currentLoop;
           m_audiofile->m_loops->GetLoopData(firstSelected - 1, currentLoop);
           if (!m_loopOnly)
-            m_sound->SetLoopPosition(0, currentLoop.dwStart, currentLoop.dwEnd, m_audiofile->m_channels);
+            m_sound->SetLoopPosition(0, currentLoop.dwStart, currentLoop.dwEnd);
           else {
             if (((double) (currentLoop.dwEnd - currentLoop.dwStart)) / (double) m_audiofile->GetSampleRate() > 0.5) {
               unsigned pos = currentLoop.dwEnd - (m_audiofile->GetSampleRate() / 2);
-              m_sound->SetLoopPosition(pos, currentLoop.dwStart, currentLoop.dwEnd, m_audiofile->m_channels);
+              m_sound->SetLoopPosition(pos, currentLoop.dwStart, currentLoop.dwEnd);
             } else {
-              m_sound->SetLoopPosition(currentLoop.dwStart, currentLoop.dwStart, currentLoop.dwEnd, m_audiofile->m_channels);
+              m_sound->SetLoopPosition(currentLoop.dwStart, currentLoop.dwStart, currentLoop.dwEnd);
             }
           }
         }
@@ -1964,13 +2036,13 @@ void MyFrame::OnKeyboardInput(wxKeyEvent& event) {
         LOOPDATA currentLoop;
         m_audiofile->m_loops->GetLoopData(0, currentLoop);
         if (!m_loopOnly)
-          m_sound->SetLoopPosition(0, currentLoop.dwStart, currentLoop.dwEnd, m_audiofile->m_channels);
+          m_sound->SetLoopPosition(0, currentLoop.dwStart, currentLoop.dwEnd);
         else {
           if (((double) (currentLoop.dwEnd - currentLoop.dwStart)) / (double) m_audiofile->GetSampleRate() > 0.5) {
             unsigned pos = currentLoop.dwEnd - (m_audiofile->GetSampleRate() / 2);
-            m_sound->SetLoopPosition(pos, currentLoop.dwStart, currentLoop.dwEnd, m_audiofile->m_channels);
+            m_sound->SetLoopPosition(pos, currentLoop.dwStart, currentLoop.dwEnd);
           } else {
-            m_sound->SetLoopPosition(currentLoop.dwStart, currentLoop.dwStart, currentLoop.dwEnd, m_audiofile->m_channels);
+            m_sound->SetLoopPosition(currentLoop.dwStart, currentLoop.dwStart, currentLoop.dwEnd);
           }
         }
         SetLoopPlayback(true);
@@ -2000,13 +2072,13 @@ void MyFrame::OnKeyboardInput(wxKeyEvent& event) {
           LOOPDATA currentLoop;
           m_audiofile->m_loops->GetLoopData(firstSelected + 1, currentLoop);
           if (!m_loopOnly)
-            m_sound->SetLoopPosition(0, currentLoop.dwStart, currentLoop.dwEnd, m_audiofile->m_channels);
+            m_sound->SetLoopPosition(0, currentLoop.dwStart, currentLoop.dwEnd);
           else {
             if (((double) (currentLoop.dwEnd - currentLoop.dwStart)) / (double) m_audiofile->GetSampleRate() > 0.5) {
               unsigned pos = currentLoop.dwEnd - (m_audiofile->GetSampleRate() / 2);
-              m_sound->SetLoopPosition(pos, currentLoop.dwStart, currentLoop.dwEnd, m_audiofile->m_channels);
+              m_sound->SetLoopPosition(pos, currentLoop.dwStart, currentLoop.dwEnd);
             } else {
-              m_sound->SetLoopPosition(currentLoop.dwStart, currentLoop.dwStart, currentLoop.dwEnd, m_audiofile->m_channels);
+              m_sound->SetLoopPosition(currentLoop.dwStart, currentLoop.dwStart, currentLoop.dwEnd);
             }
           }
         }
@@ -2023,13 +2095,13 @@ void MyFrame::OnKeyboardInput(wxKeyEvent& event) {
         LOOPDATA currentLoop;
         m_audiofile->m_loops->GetLoopData(0, currentLoop);
         if (!m_loopOnly)
-          m_sound->SetLoopPosition(0, currentLoop.dwStart, currentLoop.dwEnd, m_audiofile->m_channels);
+          m_sound->SetLoopPosition(0, currentLoop.dwStart, currentLoop.dwEnd);
         else {
           if (((double) (currentLoop.dwEnd - currentLoop.dwStart)) / (double) m_audiofile->GetSampleRate() > 0.5) {
             unsigned pos = currentLoop.dwEnd - (m_audiofile->GetSampleRate() / 2);
-            m_sound->SetLoopPosition(pos, currentLoop.dwStart, currentLoop.dwEnd, m_audiofile->m_channels);
+            m_sound->SetLoopPosition(pos, currentLoop.dwStart, currentLoop.dwEnd);
           } else {
-            m_sound->SetLoopPosition(currentLoop.dwStart, currentLoop.dwStart, currentLoop.dwEnd, m_audiofile->m_channels);
+            m_sound->SetLoopPosition(currentLoop.dwStart, currentLoop.dwStart, currentLoop.dwEnd);
           }
         }
         SetLoopPlayback(true);
@@ -2058,7 +2130,7 @@ void MyFrame::OnKeyboardInput(wxKeyEvent& event) {
           // set/update the currently selected cue position
           CUEPOINT currentCue;
           m_audiofile->m_cues->GetCuePoint(firstSelected - 1, currentCue);
-          m_sound->SetLoopPosition(currentCue.dwSampleOffset, currentCue.dwSampleOffset, currentCue.dwSampleOffset, m_audiofile->m_channels);
+          m_sound->SetLoopPosition(currentCue.dwSampleOffset, currentCue.dwSampleOffset, currentCue.dwSampleOffset);
 
           SetLoopPlayback(false); // set the playback to not be for loops
 
@@ -2075,7 +2147,7 @@ void MyFrame::OnKeyboardInput(wxKeyEvent& event) {
         // set/update the currently selected cue position
         CUEPOINT currentCue;
         m_audiofile->m_cues->GetCuePoint(0, currentCue);
-        m_sound->SetLoopPosition(currentCue.dwSampleOffset, currentCue.dwSampleOffset, currentCue.dwSampleOffset, m_audiofile->m_channels);
+        m_sound->SetLoopPosition(currentCue.dwSampleOffset, currentCue.dwSampleOffset, currentCue.dwSampleOffset);
 
         SetLoopPlayback(false); // set the playback to not be for loops
         toolBar->EnableTool(X_FADE, false);
@@ -2104,7 +2176,7 @@ void MyFrame::OnKeyboardInput(wxKeyEvent& event) {
           // set/update the currently selected cue position
           CUEPOINT currentCue;
           m_audiofile->m_cues->GetCuePoint(firstSelected + 1, currentCue);
-          m_sound->SetLoopPosition(currentCue.dwSampleOffset, currentCue.dwSampleOffset, currentCue.dwSampleOffset, m_audiofile->m_channels);
+          m_sound->SetLoopPosition(currentCue.dwSampleOffset, currentCue.dwSampleOffset, currentCue.dwSampleOffset);
 
           SetLoopPlayback(false); // set the playback to not be for loops
 
@@ -2121,7 +2193,7 @@ void MyFrame::OnKeyboardInput(wxKeyEvent& event) {
         // set/update the currently selected cue position
         CUEPOINT currentCue;
         m_audiofile->m_cues->GetCuePoint(0, currentCue);
-        m_sound->SetLoopPosition(currentCue.dwSampleOffset, currentCue.dwSampleOffset, currentCue.dwSampleOffset, m_audiofile->m_channels);
+        m_sound->SetLoopPosition(currentCue.dwSampleOffset, currentCue.dwSampleOffset, currentCue.dwSampleOffset);
 
         SetLoopPlayback(false); // set the playback to not be for loops
         toolBar->EnableTool(X_FADE, false);
@@ -2257,13 +2329,15 @@ void MyFrame::OnCueGridCellSelect(wxGridEvent& event) {
 }
 
 void MyFrame::PopulateListCtrl() {
+  m_listScanner->Clear();
   m_fileListCtrl->DeleteAllItems();
+  m_fileListCtrl->ClearFileStats();
 
   m_fileListCtrl->Hide();
 
   if (!fileNames.IsEmpty()) {
     for (unsigned i = 0; i < fileNames.GetCount(); i++) {
-      m_fileListCtrl->InsertItem(i, fileNames[i]);
+      m_fileListCtrl->InsertItem(i, fileNames[i], -1);
 
       SF_INSTRUMENT instr;
       SF_CUES cues;
@@ -2299,14 +2373,17 @@ void MyFrame::PopulateListCtrl() {
           m_fileListCtrl->SetItem(i, 2, wxT("0"));
         }
       }
+
+      // the waveform, length and levels are filled in as the files are scanned
+      m_listScanner->Request(i, filePath);
     }
   }
 
   m_fileListCtrl->SetColumnWidth(0, wxLIST_AUTOSIZE);
-  m_fileListCtrl->SetColumnWidth(1, wxLIST_AUTOSIZE_USEHEADER);
-  m_fileListCtrl->SetColumnWidth(2, wxLIST_AUTOSIZE_USEHEADER);
-  m_fileListCtrl->SetColumnWidth(3, wxLIST_AUTOSIZE_USEHEADER);
-  m_fileListCtrl->SetColumnWidth(4, wxLIST_AUTOSIZE_USEHEADER);
+  for (int col = 1; col < m_fileListCtrl->GetColumnCount(); col++) {
+    if (col != 5)
+      m_fileListCtrl->SetColumnWidth(col, wxLIST_AUTOSIZE_USEHEADER);
+  }
 
   int availableWidth;
 
@@ -2316,18 +2393,11 @@ void MyFrame::PopulateListCtrl() {
     availableWidth = m_fileListCtrl->GetClientSize().GetWidth();
 
   // adjust width of the list control columns
-  if (m_fileListCtrl->GetColumnWidth(0) +
-    m_fileListCtrl->GetColumnWidth(1) +
-    m_fileListCtrl->GetColumnWidth(2) +
-    m_fileListCtrl->GetColumnWidth(3) +
-    m_fileListCtrl->GetColumnWidth(4) < availableWidth
-  ) {
-    int sizeLeft = availableWidth - (
-      m_fileListCtrl->GetColumnWidth(1) +
-      m_fileListCtrl->GetColumnWidth(2) +
-      m_fileListCtrl->GetColumnWidth(3) +
-      m_fileListCtrl->GetColumnWidth(4)
-    );
+  int otherColumns = 0;
+  for (int col = 1; col < m_fileListCtrl->GetColumnCount(); col++)
+    otherColumns += m_fileListCtrl->GetColumnWidth(col);
+  if (m_fileListCtrl->GetColumnWidth(0) + otherColumns < availableWidth) {
+    int sizeLeft = availableWidth - otherColumns;
     if (sizeLeft > m_fileListCtrl->GetColumnWidth(0))
       m_fileListCtrl->SetColumnWidth(0, sizeLeft);
   }
@@ -2335,6 +2405,15 @@ void MyFrame::PopulateListCtrl() {
   m_fileListCtrl->Show();
 }
 
+void MyFrame::OnFileStatsReady(wxThreadEvent& WXUNUSED(event)) {
+  std::vector<FILELIST_STATS> stats;
+  if (!m_listScanner->CollectFinishedFiles(stats))
+    return;
+
+  for (unsigned i = 0; i < stats.size(); i++)
+    m_fileListCtrl->ShowFileStats(stats[i]);
+}
+
 void MyFrame::OnHelp(wxCommandEvent& WXUNUSED(event)) {
   ::wxGetApp().m_helpController->DisplayContents();
 }
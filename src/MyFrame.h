@@ -33,8 +33,8 @@
 #include "CrossfadeDialog.h"
 #include "CutNFadeDialog.h"
 #include "BatchProcessDialog.h"
+#include "FileListScanner.h"
 #include <wx/fileconf.h>
-#include "MyResampler.h"
 
 class MyFrame : public wxFrame {
 public:
@@ -72,16 +72,21 @@ public:
   void OnPitchSettings(wxCommandEvent& event);
   void OnZoomInAmplitude(wxCommandEvent& event);
   void OnZoomOutAmplitude(wxCommandEvent& event);
+  void OnZoomInTime(wxCommandEvent& event);
+  void OnZoomOutTime(wxCommandEvent& event);
+  void OnZoomAllTime(wxCommandEvent& event);
   void OnVolumeSlider(wxCommandEvent& event);
   void OnCrossfade(wxCommandEvent& event);
   void OnEditLoop(wxCommandEvent& event);
   void OnViewLoop(wxCommandEvent& event);
+  void OnSnapLoop(wxCommandEvent& event);
   void OnCutFade(wxCommandEvent& event);
   void OnLoopPlayback(wxCommandEvent& event);
   void OnKeyboardInput(wxKeyEvent& event);
   void OnSize(wxSizeEvent& event);
   void OnListInfo(wxCommandEvent& event);
   void OnAudioSettings(wxCommandEvent& event);
+  void OnFileStatsReady(wxThreadEvent& event);
 
   void EmptyListOfFileNames();
   void AddFileName(wxString fileName);
@@ -91,15 +96,15 @@ public:
   void ChangeCuePosition(unsigned int offset, int index);
   void UpdateLoopsAndCuesDisplay();
   void UpdateAutoloopSliderSustainsection(int start, int end);
+  void UpdateZoomStatus();
 
-  static int AudioCallback(void *outputBuffer, void *inputBuffer, unsigned int nBufferFrames,
-                    double streamTime, RtAudioStreamStatus status, void *userData );
-
-  static void SetLoopPlayback(bool looping);
+  void SetLoopPlayback(bool looping);
   void SetPitchMethod(int method);
   void SetSpectrumFftSize(int size);
   void SetSpectrumWindow(int type);
   void SetSpectrumInterpolatePitch(bool interpolate);
+  void SetHPSHarmonics(int harmonics);
+  void SetSeamSearchRadius(int radius);
 
 private:
   // This class handles events
@@ -114,6 +119,7 @@ private:
   wxBoxSizer *lowerBox;
   wxTimer m_timer;
   MyListCtrl *m_fileListCtrl;
+  FileListScanner *m_listScanner;
   MyPanel *m_panel;
   wxToolBar *toolBar;
   wxMenu *fileMenu;
@@ -138,20 +144,17 @@ private:
   int m_frameWidth;
   int m_frameHeight;
   bool m_frameMaximized;
-  MyResampler *m_resampler;
   int m_pitchMethod;
   int m_spectrumFftSize;
   int m_spectrumWindow;
   bool m_spectrumInterpolatePitch;
+  int m_seamSearchRadius;
 
   void PopulateListOfFileNames();
   void PopulateListCtrl();
   void UpdateAllViews();
   void UpdateCurrentFileInfo();
   void GetCurrentFrameSizes();
-
-  static bool loopPlay;
-  static int volumeMultiplier;
 };
 
 #endif
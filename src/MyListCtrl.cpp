@@ -20,6 +20,7 @@
 
 #include "MyListCtrl.h"
 #include "MyFrame.h"
+#include <wx/dcmemory.h>
 
 // Event table
 BEGIN_EVENT_TABLE(MyListCtrl, wxListCtrl)
@@ -53,6 +54,9 @@ bool MyListCtrl::Create(
   if (!wxListCtrl::Create(parent, id, pos, size, style))
     return false;
 
+  m_thumbnails.Create(LISTCTRL_THUMBNAIL_WIDTH, LISTCTRL_THUMBNAIL_HEIGHT, false);
+  SetImageList(&m_thumbnails, wxIMAGE_LIST_SMALL);
+
   return true;
 }
 
@@ -60,3 +64,72 @@ void MyListCtrl::OnKeyDown(wxKeyEvent& event) {
   MyFrame *myParent = (MyFrame *) GetParent();
   myParent->OnKeyboardInput(event);
 }
+
+void MyListCtrl::ShowFileStats(const FILELIST_STATS &stats) {
+  if (stats.item < 0 || stats.item >= GetItemCount())
+    return;
+
+  if (!stats.ok) {
+    SetItem(stats.item, 6, wxT("-"));
+    SetItem(stats.item, 7, wxT("-"));
+    SetItem(stats.item, 8, wxT("-"));
+    return;
+  }
+
+  // an item that is scanned again after saving keeps its image slot
+  wxListItem thumbnailItem;
+  thumbnailItem.SetId(stats.item);
+  thumbnailItem.SetColumn(5);
+  thumbnailItem.SetMask(wxLIST_MASK_IMAGE);
+  int image = -1;
+  if (GetItem(thumbnailItem))
+    image = thumbnailItem.GetImage();
+  if (image >= 0 && image < m_thumbnails.GetImageCount())
+    m_thumbnails.Replace(image, DrawThumbnail(stats));
+  else
+    image = m_thumbnails.Add(DrawThumbnail(stats));
+  SetItemColumnImage(stats.item, 5, image);
+
+  SetItem(stats.item, 6, wxString::Format(wxT("%.2f"), stats.duration));
+  if (stats.peak > -200.0)
+    SetItem(stats.item, 7, wxString::Format(wxT("%.1f"), stats.peak));
+  else
+    SetItem(stats.item, 7, wxT("-inf"));
+  if (stats.rms > -200.0)
+    SetItem(stats.item, 8, wxString::Format(wxT("%.1f"), stats.rms));
+  else
+    SetItem(stats.item, 8, wxT("-inf"));
+}
+
+void MyListCtrl::ClearFileStats() {
+  m_thumbnails.RemoveAll();
+}
+
+wxBitmap MyListCtrl::DrawThumbnail(const FILELIST_STATS &stats) {
+  wxBitmap thumbnail(LISTCTRL_THUMBNAIL_WIDTH, LISTCTRL_THUMBNAIL_HEIGHT);
+  wxMemoryDC dc(thumbnail);
+  dc.SetBackground(wxBrush(GetBackgroundColour()));
+  dc.Clear();
+
+  int bottom = LISTCTRL_THUMBNAIL_HEIGHT - 1;
+  dc.SetPen(wxPen(wxColour(211, 211, 211), 1, wxPENSTYLE_SOLID));
+  dc.DrawLine(0, bottom / 2, LISTCTRL_THUMBNAIL_WIDTH, bottom / 2);
+
+  // columns that reach full scale are drawn in red so clipped takes stand out
+  wxPen wavePen(wxColour(wxT("#0d0060")), 1, wxPENSTYLE_SOLID);
+  wxPen clippedPen(wxColour(wxT("#ff0000")), 1, wxPENSTYLE_SOLID);
+  for (int x = 0; x < FILELIST_THUMBNAIL_COLUMNS && (unsigned) x * 2 + 1 < stats.thumbnail.size(); x++) {
+    unsigned char minValue = stats.thumbnail[x * 2];
+    unsigned char maxValue = stats.thumbnail[x * 2 + 1];
+    if (minValue == 0 || maxValue == 255)
+      dc.SetPen(clippedPen);
+    else
+      dc.SetPen(wavePen);
+    int top = (255 - maxValue) * bottom / 255;
+    int low = (255 - minValue) * bottom / 255;
+    dc.DrawLine(x, top, x, low + 1);
+  }
+
+  dc.SelectObject(wxNullBitmap);
+  return thumbnail;
+}
@@ -22,6 +22,12 @@
 #define MYLISTCTRL_H
 
 #include <wx/listctrl.h>
+#include <wx/imaglist.h>
+#include "FileListScanner.h"
+
+// Size of the waveform thumbnails, one pixel per thumbnail column
+#define LISTCTRL_THUMBNAIL_WIDTH FILELIST_THUMBNAIL_COLUMNS
+#define LISTCTRL_THUMBNAIL_HEIGHT 16
 
 class MyListCtrl : public wxListCtrl {
 public:
@@ -48,7 +54,15 @@ public:
   // Event handler
   void OnKeyDown(wxKeyEvent& event);
 
+  // Fills the waveform, length, peak and RMS columns of an item
+  void ShowFileStats(const FILELIST_STATS &stats);
+  void ClearFileStats();
+
 private:
+  wxImageList m_thumbnails;
+
+  wxBitmap DrawThumbnail(const FILELIST_STATS &stats);
+
   // This class handles events
   DECLARE_EVENT_TABLE()
 };
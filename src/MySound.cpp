@@ -19,15 +19,10 @@
  */
 
 #include "MySound.h"
-#include "FileHandling.h"
-#include "MyFrame.h"
 #include <algorithm>
 #include <climits>
 
-MySound::MySound(wxString apiName, unsigned int deviceID) : m_audio(NULL), fmt(RTAUDIO_FLOAT32), bufferFrames(1024), sampleRateToUse(0), m_lastError(wxEmptyString) {
-  for (int i = 0; i < 3; i++)
-    pos[i] = 0;
-
+MySound::MySound(wxString apiName, unsigned int deviceID) : m_audio(NULL), fmt(RTAUDIO_FLOAT32), bufferFrames(MYSOUND_BUFFER_FRAMES), m_lowLatency(false), m_lowLatencyFrames(128), m_streamLatency(0), sampleRateToUse(0), m_lastError(wxEmptyString) {
   RtAudio::getCompiledApi(m_availableApis);
 
   m_isJackUsed = false;
@@ -110,23 +105,46 @@ void MySound::SetAudioFormat(int audioFormat) {
 }
 
 void MySound::OpenAudioStream() {
-  if (
-    m_audio->openStream(
-      &parameters,
-      NULL,
-      fmt,
-      sampleRateToUse,
-      &bufferFrames,
-      &MyFrame::AudioCallback,
-      (void *)&pos,
-      &options
-    ) == RTAUDIO_NO_ERROR) {
-    // All is fine
-    m_lastError = wxEmptyString;
-  } else {
+  // in low latency mode small buffers are asked for and the callback thread
+  // is given realtime priority, the device (or Jack) decides the final size
+  unsigned int requestedFrames = MYSOUND_BUFFER_FRAMES;
+  options.flags = 0;
+  if (m_lowLatency) {
+    requestedFrames = m_lowLatencyFrames;
+    options.flags = RTAUDIO_MINIMIZE_LATENCY | RTAUDIO_SCHEDULE_REALTIME;
+  }
+
+  while (true) {
+    bufferFrames = requestedFrames;
+    if (
+      m_audio->openStream(
+        &parameters,
+        NULL,
+        fmt,
+        sampleRateToUse,
+        &bufferFrames,
+        &PlaybackEngine::AudioCallback,
+        (void *)&m_engine,
+        &options
+      ) == RTAUDIO_NO_ERROR) {
+      // All is fine
+      m_lastError = wxEmptyString;
+      m_streamLatency = 0;
+      if (sampleRateToUse > 0)
+        m_streamLatency = (double) m_audio->getStreamLatency() / (double) sampleRateToUse;
+      return;
+    }
+
+    // a device that refuses a small buffer may still take a larger one
+    if (m_lowLatency && requestedFrames < MYSOUND_BUFFER_FRAMES) {
+      requestedFrames *= 2;
+      continue;
+    }
+
     // Some kind of error has happened
     m_lastError = wxString(m_audio->getErrorText());
     m_audio->abortStream();
+    return;
   }
 }
 
@@ -159,15 +177,18 @@ void MySound::CloseAudioStream() {
     m_audio->closeStream();
 }
 
-void MySound::SetLoopPosition(unsigned int currentPos, unsigned int lStart, unsigned int lEnd, int n_channels) {
-  // positions are all numbers in frames! and we need them in items for the data array
-  pos[0] = currentPos * n_channels;
-  pos[1] = lStart * n_channels;
-  pos[2] = lEnd * n_channels + (n_channels - 1);
+void MySound::SetLoopPosition(unsigned int currentPos, unsigned int lStart, unsigned int lEnd) {
+  // positions are all in frames of the original audio
+  m_engine.SetLoop(lStart, lEnd);
+  m_engine.Seek(currentPos);
+}
+
+void MySound::SetStartPosition(unsigned int startPos) {
+  m_engine.Seek(startPos);
 }
 
-void MySound::SetStartPosition(unsigned int startPos, int n_channels) {
-  pos[0] = startPos * n_channels;
+PlaybackEngine* MySound::GetPlaybackEngine() {
+  return &m_engine;
 }
 
 void MySound::SetChannels(int channels) {
@@ -175,10 +196,12 @@ void MySound::SetChannels(int channels) {
     // we can safely use this number of channels
     parameters.nChannels = channels;
     m_channelsUsed = channels;
+    m_engine.SetOutputChannels(channels);
   } else {
     // the file contain more channels than device can handle
     parameters.nChannels = info.outputChannels;
     m_channelsUsed = info.outputChannels;
+    m_engine.SetOutputChannels(info.outputChannels);
   }
 }
 
@@ -210,6 +233,34 @@ bool MySound::StreamNeedsResampling() {
   return m_needsResampling;
 }
 
+double MySound::GetStreamTime() {
+  if (m_audio->isStreamOpen())
+    return m_audio->getStreamTime();
+  return 0;
+}
+
+double MySound::GetStreamLatency() {
+  return m_streamLatency;
+}
+
+void MySound::SetLowLatency(bool lowLatency, unsigned int bufferSize) {
+  m_lowLatency = lowLatency;
+  if (bufferSize >= 16 && bufferSize <= MYSOUND_BUFFER_FRAMES)
+    m_lowLatencyFrames = bufferSize;
+}
+
+bool MySound::IsLowLatency() {
+  return m_lowLatency;
+}
+
+unsigned int MySound::GetLowLatencyBufferFrames() {
+  return m_lowLatencyFrames;
+}
+
+unsigned int MySound::GetBufferFrames() {
+  return bufferFrames;
+}
+
 unsigned int MySound::GetChannelsUsed() {
   return m_channelsUsed;
 }
@@ -23,8 +23,12 @@
 
 #include <wx/wx.h>
 #include "RtAudio.h"
+#include "PlaybackEngine.h"
 #include <vector>
 
+// Buffer size in frames when not in low latency mode
+#define MYSOUND_BUFFER_FRAMES 1024
+
 class MySound {
 public:
   MySound(wxString apiName, unsigned int deviceID);
@@ -44,13 +48,19 @@ public:
   void StartAudioStream();
   void StopAudioStream();
   void CloseAudioStream();
-  void SetLoopPosition(unsigned int currentPos, unsigned int lStart, unsigned int lEnd, int n_channels);
-  void SetStartPosition(unsigned int startPos, int n_channels);
+  void SetLoopPosition(unsigned int currentPos, unsigned int lStart, unsigned int lEnd);
+  void SetStartPosition(unsigned int startPos);
   bool IsStreamActive();
   bool IsStreamAvailable();
   bool IsJackUsed();
   bool StreamNeedsResampling();
-  unsigned int pos[3]; // Used to keep track of position. [0] = current position, [1] = loop start, [2] = loop end
+  double GetStreamTime();
+  double GetStreamLatency(); // in seconds, of the last opened stream
+  void SetLowLatency(bool lowLatency, unsigned int bufferSize);
+  bool IsLowLatency();
+  unsigned int GetLowLatencyBufferFrames();
+  unsigned int GetBufferFrames(); // as negotiated with the device
+  PlaybackEngine* GetPlaybackEngine();
   std::vector< RtAudio::Api > m_availableApis;
 
 private:
@@ -60,6 +70,9 @@ private:
   RtAudio::DeviceInfo info;
   RtAudioFormat fmt;
   unsigned int bufferFrames;
+  bool m_lowLatency;
+  unsigned int m_lowLatencyFrames;
+  double m_streamLatency;
   unsigned int sampleRateToUse;
   unsigned int m_deviceID;
   unsigned int m_channelsUsed;
@@ -67,6 +80,7 @@ private:
   bool m_needsResampling;
   wxString m_lastError;
   bool m_isJackUsed;
+  PlaybackEngine m_engine;
 };
 
 #endif
@@ -20,15 +20,32 @@
 
 #include "PitchDialog.h"
 #include <wx/choice.h>
+#include <wx/spinctrl.h>
 #include "SpectrumDialog.h"
+#include "SpectrogramDialog.h"
+#include "PitchTrackDialog.h"
 
 IMPLEMENT_CLASS(PitchDialog, wxDialog )
 
+// Deviation in cents from equal temperament for C to B with A kept in place
+static const double temperamentOffsets[4][12] = {
+  { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 }, // Equal
+  { 11.7, 1.9, 3.9, 5.9, 2.0, 9.8, 0.0, 7.8, 3.9, 0.0, 7.8, 3.9 }, // Werckmeister III
+  { 5.9, 0.0, 2.0, 3.9, -2.0, 7.8, -2.0, 3.9, 2.0, 0.0, 5.9, -3.9 }, // Vallotti
+  { 10.3, -13.7, 3.4, 20.5, -3.4, 13.7, -10.3, 6.8, -17.1, 0.0, 17.1, -6.8 } // 1/4 comma meantone
+};
+
 BEGIN_EVENT_TABLE(PitchDialog, wxDialog)
   EVT_RADIOBOX(ID_PITCH_METHOD, PitchDialog::OnAutoDetectionCheck)
   EVT_COMBOBOX(ID_NOTECOMBO, PitchDialog::OnNoteChange)
   EVT_SLIDER(ID_PITCHFRACTION, PitchDialog::OnFractionChange)
   EVT_BUTTON(ID_SPECTRUM_BTN, PitchDialog::OnViewSpectrumButton)
+  EVT_BUTTON(ID_SPECTROGRAM_BTN, PitchDialog::OnViewSpectrogramButton)
+  EVT_BUTTON(ID_PITCH_TRACK_BTN, PitchDialog::OnViewPitchTrackButton)
+  EVT_CHECKBOX(ID_PREVIEW_CHECK, PitchDialog::OnPreviewCheck)
+  EVT_SPINCTRL(ID_PREVIEW_REFERENCE, PitchDialog::OnPreviewChange)
+  EVT_CHOICE(ID_PREVIEW_TEMPERAMENT, PitchDialog::OnPreviewChange)
+  EVT_SPINCTRL(ID_HPS_HARMONICS, PitchDialog::OnHPSHarmonicsChange)
 END_EVENT_TABLE()
 
 PitchDialog::PitchDialog(FileHandling *audioFile) {
@@ -52,7 +69,6 @@ void PitchDialog::Init(FileHandling *audioFile) {
   m_audioFile = audioFile;
 
   double midi_note_pitch;
-  double hps_midi_note_pitch;
   double td_midi_note_pitch;
 
   double fftPitches[2];
@@ -71,21 +87,15 @@ void PitchDialog::Init(FileHandling *audioFile) {
     m_detectedMIDIPitchFraction = 1200 * (log10(fftPitches[0] / midi_note_pitch) / log10(2));
     m_actualMIDIPitchFraction = ((double)UINT_MAX * (m_detectedMIDIPitchFraction / 100.0));
 
-    m_hpsDetectedPitch = fftPitches[1];
-    m_hpsDetectedMIDIUnityNote = (69 + 12 * (log10(fftPitches[1] / 440.0) / log10(2)));
-    hps_midi_note_pitch = 440.0 * pow(2, ((double)(m_hpsDetectedMIDIUnityNote - 69) / 12.0));
-    m_hpsDetectedMIDIPitchFraction = 1200 * (log10(fftPitches[1] / hps_midi_note_pitch) / log10(2));
-    m_actualHpsMIDIPitchFraction = ((double)UINT_MAX * (m_hpsDetectedMIDIPitchFraction / 100.0));
+    CalculateHpsPitch(fftPitches[1]);
   } else {
+    m_detectedPitch = 0;
     m_detectedMIDIUnityNote = 0;
     midi_note_pitch = 0;
     m_detectedMIDIPitchFraction = 0;
     m_actualMIDIPitchFraction = 0;
 
-    m_hpsDetectedMIDIUnityNote = 0;
-    hps_midi_note_pitch = 0;
-    m_hpsDetectedMIDIPitchFraction = 0;
-    m_actualHpsMIDIPitchFraction = 0;
+    CalculateHpsPitch(0);
   }
 
   if (m_TDdetectedPitch != 0) {
@@ -135,6 +145,19 @@ void PitchDialog::Init(FileHandling *audioFile) {
   m_windowTypes.Add(wxT("Gaussian(a=4.5)"));
 
   m_useInterpolatePitch = false;
+
+  hpsPitchLabel = NULL;
+  hpsMidiNoteLabel = NULL;
+  hpsPitchFractionLabel = NULL;
+  m_previewEngine = NULL;
+  previewLabel = NULL;
+  m_preview = true;
+  m_referencePitch = 440;
+  m_temperament = 0;
+  m_temperaments.Add(wxT("Equal"));
+  m_temperaments.Add(wxT("Werckmeister III"));
+  m_temperaments.Add(wxT("Vallotti"));
+  m_temperaments.Add(wxT("1/4 comma meantone"));
 }
 
 bool PitchDialog::Create( 
@@ -228,7 +251,7 @@ void PitchDialog::CreateControls() {
   fftPitchContainer->Add(hpsPitchContainer, 1, wxGROW|wxALL, 5);
 
   // Label for the autodetected pitch frequency
-  wxStaticText *hpsPitchLabel = new wxStaticText ( 
+  hpsPitchLabel = new wxStaticText ( 
     this, 
     wxID_STATIC,
     wxEmptyString, 
@@ -240,7 +263,7 @@ void PitchDialog::CreateControls() {
   hpsPitchContainer->Add(hpsPitchLabel, 1, wxLEFT|wxRIGHT|wxTOP, 2);
 
   // Label for the calculated MIDIUnityNote
-  wxStaticText *hpsMidiNoteLabel = new wxStaticText ( 
+  hpsMidiNoteLabel = new wxStaticText ( 
     this, 
     wxID_STATIC,
     wxEmptyString, 
@@ -252,7 +275,7 @@ void PitchDialog::CreateControls() {
   hpsPitchContainer->Add(hpsMidiNoteLabel, 1, wxLEFT|wxRIGHT|wxTOP, 2);
 
   // Label for the calculated MIDIPitchFraction
-  wxStaticText *hpsPitchFractionLabel = new wxStaticText ( 
+  hpsPitchFractionLabel = new wxStaticText ( 
     this, 
     wxID_STATIC,
     wxEmptyString, 
@@ -353,6 +376,28 @@ void PitchDialog::CreateControls() {
   spectrumRow->Add(windowChoice, 0, wxALL, 5);
   windowChoice->SetSelection(9);
 
+  // The View Spectrogram button uses the same window type
+  wxButton *spectrogramButton = new wxButton(
+    this,
+    ID_SPECTROGRAM_BTN,
+    wxT("View spectrogram"),
+    wxDefaultPosition,
+    wxDefaultSize,
+    0
+  );
+  spectrumRow->Add(spectrogramButton, 0, wxALL, 5);
+
+  // The pitch over time button
+  wxButton *pitchTrackButton = new wxButton(
+    this,
+    ID_PITCH_TRACK_BTN,
+    wxT("View pitch over time"),
+    wxDefaultPosition,
+    wxDefaultSize,
+    0
+  );
+  spectrumRow->Add(pitchTrackButton, 0, wxALL, 5);
+
   // Horizontal sizer for selection row
   wxBoxSizer* selectionRow = new wxBoxSizer(wxHORIZONTAL);
   boxSizer->Add(selectionRow, 0, wxGROW|wxALL, 5);
@@ -371,6 +416,31 @@ void PitchDialog::CreateControls() {
   pitchMethod->Enable(0, true);
   selectionRow->Add(pitchMethod, 1, wxGROW|wxALL, 2);
 
+  // Label for the number of harmonics in the HPS
+  wxStaticText *harmonicsLabel = new wxStaticText (
+    this,
+    wxID_STATIC,
+    wxT("HPS harmonics: "),
+    wxDefaultPosition,
+    wxDefaultSize,
+    0
+  );
+  selectionRow->Add(harmonicsLabel, 0, wxALIGN_CENTER_VERTICAL|wxALL, 5);
+
+  // Spin control for the number of harmonics in the HPS
+  wxSpinCtrl *harmonicsSpin = new wxSpinCtrl(
+    this,
+    ID_HPS_HARMONICS,
+    wxEmptyString,
+    wxDefaultPosition,
+    wxDefaultSize,
+    wxSP_ARROW_KEYS,
+    2,
+    16,
+    m_audioFile->GetHPSHarmonics()
+  );
+  selectionRow->Add(harmonicsSpin, 0, wxALIGN_CENTER_VERTICAL|wxALL, 5);
+
   // Horizontal sizer for second row
   wxBoxSizer *secondRow = new wxBoxSizer(wxHORIZONTAL);
   boxSizer->Add(secondRow, 1, wxGROW|wxALL, 5);
@@ -464,6 +534,78 @@ void PitchDialog::CreateControls() {
   resultingPitchLabel->SetLabel(wxString::Format(wxT("Resulting pitch: %.2f Hz"), m_resultingPitch));
   pitchRow->Add(resultingPitchLabel, 1, wxALIGN_CENTER_VERTICAL|wxALL, 0);
 
+  // Grouping of the tuning correction preview
+  wxStaticBox *previewBox = new wxStaticBox(
+    this,
+    wxID_STATIC,
+    wxT("Preview of tuning correction during playback"),
+    wxDefaultPosition,
+    wxDefaultSize
+  );
+
+  // Horizontal sizer for the preview controls
+  wxStaticBoxSizer *previewContainer = new wxStaticBoxSizer(previewBox, wxHORIZONTAL);
+  boxSizer->Add(previewContainer, 0, wxGROW|wxALL, 5);
+
+  // Checkbox for hearing the selected pitch corrected like a sampler would
+  wxCheckBox *previewCheck = new wxCheckBox(
+    this,
+    ID_PREVIEW_CHECK,
+    wxT("Play corrected"),
+    wxDefaultPosition,
+    wxDefaultSize,
+    0
+  );
+  previewCheck->SetValue(m_preview);
+  previewContainer->Add(previewCheck, 0, wxALIGN_CENTER_VERTICAL|wxALL, 5);
+
+  // Label for the reference pitch
+  wxStaticText *referenceLabel = new wxStaticText (
+    this,
+    wxID_STATIC,
+    wxT("A4 (Hz): "),
+    wxDefaultPosition,
+    wxDefaultSize,
+    0
+  );
+  previewContainer->Add(referenceLabel, 0, wxALIGN_CENTER_VERTICAL|wxALL, 5);
+
+  // Spin control for the reference pitch
+  wxSpinCtrl *referenceSpin = new wxSpinCtrl(
+    this,
+    ID_PREVIEW_REFERENCE,
+    wxEmptyString,
+    wxDefaultPosition,
+    wxDefaultSize,
+    wxSP_ARROW_KEYS,
+    380,
+    480,
+    m_referencePitch
+  );
+  previewContainer->Add(referenceSpin, 0, wxALIGN_CENTER_VERTICAL|wxALL, 5);
+
+  // Choice for the temperament
+  wxChoice *temperamentChoice = new wxChoice(
+    this,
+    ID_PREVIEW_TEMPERAMENT,
+    wxDefaultPosition,
+    wxDefaultSize,
+    m_temperaments
+  );
+  temperamentChoice->SetSelection(m_temperament);
+  previewContainer->Add(temperamentChoice, 0, wxALIGN_CENTER_VERTICAL|wxALL, 5);
+
+  // Label for the resulting correction
+  previewLabel = new wxStaticText (
+    this,
+    wxID_STATIC,
+    wxEmptyString,
+    wxDefaultPosition,
+    wxDefaultSize,
+    0
+  );
+  previewContainer->Add(previewLabel, 1, wxALIGN_CENTER_VERTICAL|wxALL, 5);
+
   // A horizontal box sizer for the third row
   wxBoxSizer* thirdRow = new wxBoxSizer(wxHORIZONTAL);
   boxSizer->Add(thirdRow, 0, wxALIGN_CENTER_HORIZONTAL|wxALL, 5);
@@ -585,6 +727,7 @@ void PitchDialog::OnAutoDetectionCheck(wxCommandEvent& WXUNUSED(event)) {
     midinote->Enable(true);
     pitchFract->Enable(true);
   }
+  UpdatePreview();
 }
 
 void PitchDialog::OnNoteChange(wxCommandEvent& WXUNUSED(event)) {
@@ -593,6 +736,7 @@ void PitchDialog::OnNoteChange(wxCommandEvent& WXUNUSED(event)) {
 
   CalculatingResultingPitch();
   resultingPitchLabel->SetLabel(wxString::Format(wxT("Resulting pitch: %.2f Hz"), m_resultingPitch));
+  UpdatePreview();
 }
 
 void PitchDialog::OnFractionChange(wxCommandEvent& WXUNUSED(event)) {
@@ -602,6 +746,7 @@ void PitchDialog::OnFractionChange(wxCommandEvent& WXUNUSED(event)) {
 
   CalculatingResultingPitch();
   resultingPitchLabel->SetLabel(wxString::Format(wxT("Resulting pitch: %.2f Hz"), m_resultingPitch));
+  UpdatePreview();
 }
 
 void PitchDialog::OnViewSpectrumButton(wxCommandEvent& WXUNUSED(event)) {
@@ -615,10 +760,11 @@ void PitchDialog::OnViewSpectrumButton(wxCommandEvent& WXUNUSED(event)) {
   for (int i = 0; i < half; i++)
     fftResult[i] = 0;
 
-  if (m_audioFile->GetSpectrum(fftResult, fftSize, windowType)) {
+  if (m_audioFile->GetSpectrum(fftResult, fftSize, windowType, true)) {
     // We now have the spectrum in the fftResult array in dB scaled so that 1.0 in amplitude would be 0 dB
     SpectrumDialog spectrumDlg(fftResult, fftSize, m_audioFile->GetFileName(), (unsigned) m_audioFile->GetSampleRate(), this);
     spectrumDlg.SetInterpolatePitchOption(m_useInterpolatePitch);
+    spectrumDlg.SetLiveEngine(m_previewEngine);
     if (spectrumDlg.ShowModal() == wxID_OK) {
       // There should be a pitch to use for the manual pitch
       double pitch = spectrumDlg.GetSelectedPitch();
@@ -640,6 +786,7 @@ void PitchDialog::OnViewSpectrumButton(wxCommandEvent& WXUNUSED(event)) {
       fractionLabel->SetLabel(wxString::Format(wxT("PitchFraction: %.2f cent"), m_fileMIDIPitchFraction));
       CalculatingResultingPitch();
       resultingPitchLabel->SetLabel(wxString::Format(wxT("Resulting pitch: %.2f Hz"), m_resultingPitch));
+      UpdatePreview();
     }
   } else {
     // Notify that it was not possible to get spectrum
@@ -649,6 +796,18 @@ void PitchDialog::OnViewSpectrumButton(wxCommandEvent& WXUNUSED(event)) {
   delete[] fftResult;
 }
 
+void PitchDialog::OnViewSpectrogramButton(wxCommandEvent& WXUNUSED(event)) {
+  wxChoice *windowChoice = (wxChoice*) FindWindow(ID_WINDOW_TYPE_CHOICE);
+
+  SpectrogramDialog spectrogramDlg(m_audioFile, windowChoice->GetSelection(), this);
+  spectrogramDlg.ShowModal();
+}
+
+void PitchDialog::OnViewPitchTrackButton(wxCommandEvent& WXUNUSED(event)) {
+  PitchTrackDialog pitchTrackDlg(m_audioFile, this);
+  pitchTrackDlg.ShowModal();
+}
+
 void PitchDialog::SetPreferredPitchMethod(int method) {
   wxRadioBox *radioBox = (wxRadioBox*) FindWindow(ID_PITCH_METHOD);
   wxComboBox *midinote = (wxComboBox*) FindWindow(ID_NOTECOMBO);
@@ -732,7 +891,101 @@ bool PitchDialog::GetInterpolatePitch() {
 	return m_useInterpolatePitch;
 }
 
+int PitchDialog::GetHPSHarmonics() {
+  wxSpinCtrl *harmonicsSpin = (wxSpinCtrl*) FindWindow(ID_HPS_HARMONICS);
+  return harmonicsSpin->GetValue();
+}
+
+void PitchDialog::OnHPSHarmonicsChange(wxSpinEvent& WXUNUSED(event)) {
+  // the HPS pitch is detected again with the new number of harmonics
+  m_audioFile->SetHPSHarmonics(GetHPSHarmonics());
+  double fftPitches[2];
+  for (int i = 0; i < 2; i++)
+    fftPitches[i] = 0;
+  if (m_audioFile->GetFFTPitch(fftPitches))
+    CalculateHpsPitch(fftPitches[1]);
+  else
+    CalculateHpsPitch(0);
+
+  hpsPitchLabel->SetLabel(wxString::Format(wxT("HPS pitch: %.2f Hz"), m_hpsDetectedPitch));
+  hpsMidiNoteLabel->SetLabel(wxString::Format(wxT("MIDIUnityNote: %d"), m_hpsDetectedMIDIUnityNote));
+  hpsPitchFractionLabel->SetLabel(wxString::Format(wxT("PitchFraction: %.2f cent"), m_hpsDetectedMIDIPitchFraction));
+  UpdatePreview();
+}
+
 void PitchDialog::CalculatingResultingPitch() {
   double midi_note_pitch = 440.0 * pow(2, ((double)(m_fileMIDIUnityNote - 69) / 12.0));
   m_resultingPitch = midi_note_pitch * pow(2, (m_fileMIDIPitchFraction / 1200.0));
 }
+
+void PitchDialog::CalculateHpsPitch(double pitch) {
+  m_hpsDetectedPitch = pitch;
+  if (pitch > 0) {
+    m_hpsDetectedMIDIUnityNote = (69 + 12 * (log10(pitch / 440.0) / log10(2)));
+    double hps_midi_note_pitch = 440.0 * pow(2, ((double)(m_hpsDetectedMIDIUnityNote - 69) / 12.0));
+    m_hpsDetectedMIDIPitchFraction = 1200 * (log10(pitch / hps_midi_note_pitch) / log10(2));
+    m_actualHpsMIDIPitchFraction = ((double)UINT_MAX * (m_hpsDetectedMIDIPitchFraction / 100.0));
+  } else {
+    m_hpsDetectedMIDIUnityNote = 0;
+    m_hpsDetectedMIDIPitchFraction = 0;
+    m_actualHpsMIDIPitchFraction = 0;
+  }
+}
+
+double PitchDialog::GetSelectedPitch(int &note) {
+  int selectedMethod = GetMethodUsed();
+  if (selectedMethod == 0) {
+    note = m_detectedMIDIUnityNote;
+    return m_detectedPitch;
+  } else if (selectedMethod == 1) {
+    note = m_hpsDetectedMIDIUnityNote;
+    return m_hpsDetectedPitch;
+  } else if (selectedMethod == 2) {
+    note = m_TDdetectedMIDIUnityNote;
+    return m_TDdetectedPitch;
+  }
+  note = m_fileMIDIUnityNote;
+  return m_resultingPitch;
+}
+
+void PitchDialog::SetPreviewEngine(PlaybackEngine *engine) {
+  m_previewEngine = engine;
+  UpdatePreview();
+}
+
+void PitchDialog::OnPreviewCheck(wxCommandEvent& event) {
+  m_preview = event.IsChecked();
+  UpdatePreview();
+}
+
+void PitchDialog::OnPreviewChange(wxCommandEvent& WXUNUSED(event)) {
+  wxSpinCtrl *referenceSpin = (wxSpinCtrl*) FindWindow(ID_PREVIEW_REFERENCE);
+  wxChoice *temperamentChoice = (wxChoice*) FindWindow(ID_PREVIEW_TEMPERAMENT);
+
+  m_referencePitch = referenceSpin->GetValue();
+  if (temperamentChoice->GetSelection() != wxNOT_FOUND)
+    m_temperament = temperamentChoice->GetSelection();
+  UpdatePreview();
+}
+
+void PitchDialog::UpdatePreview() {
+  // a sampler plays the unity note at the target pitch whatever the sample is at
+  int note = 0;
+  double pitch = GetSelectedPitch(note);
+  double correction = 0;
+  if (pitch > 0 && note >= 0) {
+    double target = m_referencePitch * pow(2, ((double)(note - 69) / 12.0));
+    target *= pow(2, temperamentOffsets[m_temperament][note % 12] / 1200.0);
+    correction = 1200 * (log10(target / pitch) / log10(2));
+  }
+
+  if (previewLabel) {
+    if (m_previewEngine)
+      previewLabel->SetLabel(wxString::Format(wxT("Correction: %+.2f cent"), correction));
+    else
+      previewLabel->SetLabel(wxString::Format(wxT("Correction: %+.2f cent (start playback to hear it)"), correction));
+  }
+
+  if (m_previewEngine)
+    m_previewEngine->SetPitchCorrection(m_preview ? correction : 0);
+}
@@ -22,7 +22,9 @@
 #define PITCHDIALOG_H
 
 #include <wx/wx.h>
+#include <wx/spinctrl.h>
 #include "FileHandling.h"
+#include "PlaybackEngine.h"
 
 // Identifiers
 enum {
@@ -32,6 +34,12 @@ enum {
   ID_SPECTRUM_BTN = wxID_HIGHEST + 403,
   ID_FFTSIZE_CHOICE = wxID_HIGHEST + 404,
   ID_WINDOW_TYPE_CHOICE = wxID_HIGHEST + 405,
+  ID_SPECTROGRAM_BTN = wxID_HIGHEST + 406,
+  ID_PITCH_TRACK_BTN = wxID_HIGHEST + 407,
+  ID_HPS_HARMONICS = wxID_HIGHEST + 408,
+  ID_PREVIEW_CHECK = wxID_HIGHEST + 416,
+  ID_PREVIEW_REFERENCE = wxID_HIGHEST + 417,
+  ID_PREVIEW_TEMPERAMENT = wxID_HIGHEST + 418
 };
 
 class PitchDialog : public wxDialog {
@@ -74,6 +82,7 @@ public:
   int GetFftSize();
   int GetWindowType();
   bool GetInterpolatePitch();
+  int GetHPSHarmonics();
 
   // Overrides
   bool TransferDataToWindow();
@@ -85,12 +94,19 @@ public:
   void OnNoteChange(wxCommandEvent& event);
   void OnFractionChange(wxCommandEvent& event);
   void OnViewSpectrumButton(wxCommandEvent& event);
+  void OnViewSpectrogramButton(wxCommandEvent& event);
+  void OnViewPitchTrackButton(wxCommandEvent& event);
+  void OnPreviewCheck(wxCommandEvent& event);
+  void OnPreviewChange(wxCommandEvent& event);
+  void OnHPSHarmonicsChange(wxSpinEvent& event);
 
   // Setter functions
   void SetPreferredPitchMethod(int method);
   void SetPreferredFftSize(int size);
   void SetPreferredWindow(int window);
   void SetPreferredInterpolatePitch(bool interpolate);
+  // Engine of the running playback to preview the tuning correction with
+  void SetPreviewEngine(PlaybackEngine *engine);
 
 private:
   double m_detectedPitch;
@@ -118,11 +134,23 @@ private:
   wxArrayString m_notenumbers;
   wxStaticText *fractionLabel;
   wxStaticText *resultingPitchLabel;
+  wxStaticText *hpsPitchLabel;
+  wxStaticText *hpsMidiNoteLabel;
+  wxStaticText *hpsPitchFractionLabel;
   wxArrayString m_fftSizes;
   wxArrayString m_windowTypes;
   bool m_useInterpolatePitch;
+  PlaybackEngine *m_previewEngine;
+  bool m_preview;
+  int m_referencePitch; // A4 in Hz
+  int m_temperament;
+  wxArrayString m_temperaments;
+  wxStaticText *previewLabel;
 
   void CalculatingResultingPitch();
+  void CalculateHpsPitch(double pitch);
+  double GetSelectedPitch(int &note);
+  void UpdatePreview();
 };
 
 #endif
@@ -0,0 +1,110 @@
+/*
+ * PitchTrackDialog.cpp is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#include "PitchTrackDialog.h"
+#include <wx/statline.h>
+
+IMPLEMENT_CLASS(PitchTrackDialog, wxDialog)
+
+PitchTrackDialog::PitchTrackDialog(FileHandling *audioFile) {
+  Init(audioFile);
+}
+
+PitchTrackDialog::PitchTrackDialog(
+  FileHandling *audioFile,
+  wxWindow* parent,
+  wxWindowID id,
+  const wxString& title,
+  const wxPoint& pos,
+  const wxSize& size,
+  long style) {
+  Init(audioFile);
+  Create(parent, id, title, pos, size, style);
+}
+
+PitchTrackDialog::~PitchTrackDialog() {
+
+}
+
+void PitchTrackDialog::Init(FileHandling *audioFile) {
+  m_audioFile = audioFile;
+  m_drawingPanel = NULL;
+
+  wxBusyCursor wait;
+  m_audioFile->GetPitchTrack(m_track);
+  m_hasStability = m_audioFile->GetPitchStability(m_stability);
+  if (!m_hasStability) {
+    m_stability.meanPitch = 0;
+    m_stability.driftCents = 0;
+    m_stability.centsStdDev = 0;
+    m_stability.points = 0;
+    m_stability.startTime = 0;
+    m_stability.endTime = 0;
+  }
+}
+
+bool PitchTrackDialog::Create(
+  wxWindow* parent,
+  wxWindowID id,
+  const wxString& caption,
+  const wxPoint& pos,
+  const wxSize& size,
+  long style) {
+  if (!wxDialog::Create(parent, id, caption, pos, size, style))
+    return false;
+
+  CreateControls();
+  SetTitle(wxT("Pitch over time for ") + m_audioFile->GetFileName());
+
+  GetSizer()->Fit(this);
+  GetSizer()->SetSizeHints(this);
+  Centre();
+
+  return true;
+}
+
+void PitchTrackDialog::CreateControls() {
+  // Create a top level sizer
+  wxBoxSizer *topSizer = new wxBoxSizer(wxVERTICAL);
+
+  double length = 0;
+  if (!m_audioFile->waveTracks.empty())
+    length = (double) m_audioFile->waveTracks[0].waveData.size() / (double) m_audioFile->GetSampleRate();
+
+  // The drawing panel that show the pitch curve in cents from the mean pitch
+  m_drawingPanel = new PitchTrackPanel(m_track, m_hasStability, m_stability, length, this);
+  topSizer->Add(m_drawingPanel, 1, wxEXPAND);
+
+  wxStaticLine *bottomDivider = new wxStaticLine(this);
+  topSizer->Add(bottomDivider, 0, wxEXPAND);
+
+  wxBoxSizer *lastRow = new wxBoxSizer(wxHORIZONTAL);
+  lastRow->AddStretchSpacer();
+  wxButton *closeButton = new wxButton(
+    this,
+    wxID_CANCEL,
+    wxT("Close")
+  );
+  lastRow->Add(closeButton, 0, wxALIGN_CENTER_VERTICAL|wxALL, 5);
+
+  topSizer->Add(lastRow, 0, wxGROW);
+
+  SetSizer(topSizer);
+}
@@ -0,0 +1,71 @@
+/*
+ * PitchTrackDialog.h is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#ifndef PITCHTRACKDIALOG_H
+#define PITCHTRACKDIALOG_H
+
+#include <wx/wx.h>
+#include "FileHandling.h"
+#include "PitchTrackPanel.h"
+
+class PitchTrackDialog : public wxDialog {
+  DECLARE_CLASS(PitchTrackDialog)
+
+public:
+  // Constructors
+  PitchTrackDialog(FileHandling *audioFile);
+  PitchTrackDialog(
+    FileHandling *audioFile,
+    wxWindow* parent,
+    wxWindowID id = wxID_ANY,
+    const wxString& title = wxT("Pitch over time"),
+    const wxPoint& pos = wxDefaultPosition,
+    const wxSize& size = wxDefaultSize,
+    long style = wxDEFAULT_DIALOG_STYLE|wxRESIZE_BORDER|wxCLIP_CHILDREN|wxFULL_REPAINT_ON_RESIZE
+  );
+
+  ~PitchTrackDialog();
+
+  // Initialize our variables
+  void Init(FileHandling *audioFile);
+
+  // Creation
+  bool Create(
+    wxWindow* parent,
+    wxWindowID id = wxID_ANY,
+    const wxString& caption = wxT("Pitch over time"),
+    const wxPoint& pos = wxDefaultPosition,
+    const wxSize& size = wxDefaultSize,
+    long style = wxDEFAULT_DIALOG_STYLE|wxRESIZE_BORDER|wxCLIP_CHILDREN|wxFULL_REPAINT_ON_RESIZE
+  );
+
+  // Creates the controls and sizers
+  void CreateControls();
+
+private:
+  FileHandling *m_audioFile;
+  std::vector<PITCH_TRACK_POINT> m_track;
+  bool m_hasStability;
+  PITCH_STABILITY m_stability;
+  PitchTrackPanel *m_drawingPanel;
+
+};
+
+#endif
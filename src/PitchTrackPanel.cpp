@@ -0,0 +1,175 @@
+/*
+ * PitchTrackPanel.cpp is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#include "PitchTrackPanel.h"
+#include <cmath>
+
+// Event table
+BEGIN_EVENT_TABLE(PitchTrackPanel, wxPanel)
+  EVT_PAINT(PitchTrackPanel::OnPaintEvent)
+END_EVENT_TABLE()
+
+PitchTrackPanel::PitchTrackPanel(
+  const std::vector<PITCH_TRACK_POINT> &track,
+  bool hasStability,
+  PITCH_STABILITY stability,
+  double length,
+  wxWindow *parent) : wxPanel(parent, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxFULL_REPAINT_ON_RESIZE) {
+  m_track = track;
+  m_hasStability = hasStability;
+  m_stability = stability;
+  m_length = length;
+
+  // show at least +/- 25 cents and at most a semitone
+  m_centsRange = 25;
+  if (m_hasStability) {
+    for (unsigned i = 0; i < m_track.size(); i++) {
+      if (m_track[i].pitch <= 0 || m_track[i].time < m_stability.startTime || m_track[i].time > m_stability.endTime)
+        continue;
+      double cents = fabs(1200.0 * log2(m_track[i].pitch / m_stability.meanPitch));
+      if (cents > m_centsRange)
+        m_centsRange = ceil(cents / 25.0) * 25.0;
+    }
+    if (m_centsRange > 100)
+      m_centsRange = 100;
+  }
+
+  SetBackgroundColour(wxColour(244,242,239));
+  SetMinSize(wxSize(800, 400));
+}
+
+PitchTrackPanel::~PitchTrackPanel() {
+
+}
+
+void PitchTrackPanel::OnPaintEvent(wxPaintEvent& WXUNUSED(event)) {
+  wxPaintDC dc(this);
+  RenderPanel(dc);
+}
+
+void PitchTrackPanel::RenderPanel(wxDC& dc) {
+  wxSize panelSize = GetClientSize();
+  // 70 px margin to the left for the cents scale, 40 px at top for info and 30 px at bottom for time
+  wxRect plotArea(70, 40, panelSize.x - 80, panelSize.y - 70);
+  if (plotArea.GetWidth() < 10 || plotArea.GetHeight() < 10 || m_length <= 0)
+    return;
+
+  dc.SetFont(wxFont(8, wxFONTFAMILY_DEFAULT, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_LIGHT));
+  dc.SetBrush(wxBrush(wxColour(*wxWHITE)));
+  dc.SetPen(wxPen(wxColour(*wxBLACK), 1, wxPENSTYLE_SOLID));
+  dc.DrawRectangle(plotArea);
+
+  double pixelsPerSecond = (double) plotArea.GetWidth() / m_length;
+  double pixelsPerCent = (double) plotArea.GetHeight() / (2.0 * m_centsRange);
+  int zeroY = plotArea.GetY() + plotArea.GetHeight() / 2;
+
+  // the section that the statistics are calculated for
+  dc.SetBrush(wxBrush(wxColour(225, 235, 245)));
+  dc.SetPen(*wxTRANSPARENT_PEN);
+  int sustainX = plotArea.GetX() + (int) (m_stability.startTime * pixelsPerSecond);
+  int sustainWidth = (int) ((m_stability.endTime - m_stability.startTime) * pixelsPerSecond);
+  dc.DrawRectangle(sustainX, plotArea.GetY() + 1, sustainWidth, plotArea.GetHeight() - 2);
+
+  // cents scale
+  double centsStep = 5;
+  if (m_centsRange > 50)
+    centsStep = 25;
+  else if (m_centsRange > 25)
+    centsStep = 10;
+  for (double cents = -m_centsRange; cents <= m_centsRange; cents += centsStep) {
+    int y = zeroY - (int) (cents * pixelsPerCent);
+    if (cents == 0)
+      dc.SetPen(wxPen(wxColour(128, 128, 128), 1, wxPENSTYLE_SOLID));
+    else
+      dc.SetPen(wxPen(wxColour(200, 200, 200), 1, wxPENSTYLE_DOT));
+    dc.DrawLine(plotArea.GetX(), y, plotArea.GetRight(), y);
+    wxString label = wxString::Format(wxT("%+.0f cent"), cents);
+    wxSize extent = dc.GetTextExtent(label);
+    dc.DrawText(label, plotArea.GetX() - 5 - extent.x, y - extent.y / 2);
+  }
+
+  // time scale
+  dc.SetPen(wxPen(wxColour(*wxBLACK), 1, wxPENSTYLE_SOLID));
+  const double steps[] = {0.1, 0.2, 0.5, 1, 2, 5, 10, 20, 30, 60};
+  double timeStep = steps[9];
+  for (int i = 0; i < 10; i++) {
+    if (steps[i] * pixelsPerSecond >= 80) {
+      timeStep = steps[i];
+      break;
+    }
+  }
+  for (double t = 0; t <= m_length; t += timeStep) {
+    int x = plotArea.GetX() + (int) (t * pixelsPerSecond);
+    dc.DrawLine(x, plotArea.GetBottom(), x, plotArea.GetBottom() + 5);
+    wxString label = wxString::Format(wxT("%.1f s"), t);
+    wxSize extent = dc.GetTextExtent(label);
+    dc.DrawText(label, x - extent.x / 2, plotArea.GetBottom() + 6);
+  }
+
+  if (!m_hasStability) {
+    wxString noPitch = wxT("No stable pitch could be detected in the sustainsection");
+    wxSize extent = dc.GetTextExtent(noPitch);
+    dc.DrawText(noPitch, plotArea.GetX() + (plotArea.GetWidth() - extent.x) / 2, (40 - extent.y) / 2);
+    return;
+  }
+
+  wxString info = wxString::Format(
+    wxT("Mean pitch %.2f Hz    Drift %+.2f cent    Deviation %.2f cent    (%u windows)"),
+    m_stability.meanPitch,
+    m_stability.driftCents,
+    m_stability.centsStdDev,
+    m_stability.points
+  );
+  wxSize infoExtent = dc.GetTextExtent(info);
+  dc.DrawText(info, plotArea.GetX() + (plotArea.GetWidth() - infoExtent.x) / 2, (40 - infoExtent.y) / 2);
+
+  // the pitch curve, broken where no pitch was found
+  dc.SetClippingRegion(plotArea);
+  dc.SetPen(wxPen(wxColour(0, 0, 160), 2, wxPENSTYLE_SOLID));
+  bool hasLast = false;
+  wxPoint last;
+  for (unsigned i = 0; i < m_track.size(); i++) {
+    if (m_track[i].pitch <= 0) {
+      hasLast = false;
+      continue;
+    }
+    double cents = 1200.0 * log2(m_track[i].pitch / m_stability.meanPitch);
+    wxPoint current(
+      plotArea.GetX() + (int) (m_track[i].time * pixelsPerSecond),
+      zeroY - (int) (cents * pixelsPerCent)
+    );
+    if (hasLast)
+      dc.DrawLine(last, current);
+    else
+      dc.DrawPoint(current);
+    last = current;
+    hasLast = true;
+  }
+
+  // the drift over the sustainsection
+  dc.SetPen(wxPen(wxColour(*wxRED), 1, wxPENSTYLE_SHORT_DASH));
+  dc.DrawLine(
+    sustainX,
+    zeroY + (int) (m_stability.driftCents / 2.0 * pixelsPerCent),
+    sustainX + sustainWidth,
+    zeroY - (int) (m_stability.driftCents / 2.0 * pixelsPerCent)
+  );
+  dc.DestroyClippingRegion();
+}
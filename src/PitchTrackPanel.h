@@ -0,0 +1,53 @@
+/*
+ * PitchTrackPanel.h is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#ifndef PITCHTRACKPANEL_H
+#define PITCHTRACKPANEL_H
+
+#include <wx/wx.h>
+#include <vector>
+#include "PitchTracker.h"
+
+class PitchTrackPanel : public wxPanel {
+public:
+  PitchTrackPanel(
+    const std::vector<PITCH_TRACK_POINT> &track,
+    bool hasStability,
+    PITCH_STABILITY stability,
+    double length,
+    wxWindow *parent
+  );
+  ~PitchTrackPanel();
+
+private:
+	DECLARE_EVENT_TABLE()
+
+  std::vector<PITCH_TRACK_POINT> m_track;
+  bool m_hasStability;
+  PITCH_STABILITY m_stability;
+  double m_length;
+  double m_centsRange;
+
+  void OnPaintEvent(wxPaintEvent& event);
+  void RenderPanel(wxDC& dc);
+
+};
+
+#endif
@@ -0,0 +1,198 @@
+/*
+ * PitchTracker.cpp is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#include "PitchTracker.h"
+#include <algorithm>
+#include <cmath>
+
+PitchTracker::PitchTracker(unsigned samplerate, double windowLength, double lowestPitch) {
+  m_samplerate = samplerate;
+  m_windowSamples = windowLength * samplerate;
+  if (m_windowSamples < 1)
+    m_windowSamples = 1;
+  m_maxPeriod = samplerate / lowestPitch;
+  if (m_maxPeriod < 2)
+    m_maxPeriod = 2;
+  m_historyStart = 0;
+  m_position = 0;
+  m_lastSample = 0;
+  m_hasPeriodStart = false;
+  m_periodStart = 0;
+  m_periodStartExact = 0;
+  m_currentWindow = 0;
+}
+
+PitchTracker::~PitchTracker() {
+
+}
+
+void PitchTracker::Process(const double *data, unsigned length) {
+  for (unsigned i = 0; i < length; i++) {
+    double v = data[i];
+    m_history.push_back(v);
+
+    // We are interested in positive zero crossings
+    if (m_position > 0 && v > 0.0 && m_lastSample <= 0.0) {
+      double exact = (double) (m_position - 1) + (-m_lastSample / (v - m_lastSample));
+      PositiveZeroCrossing(m_position, exact);
+    }
+
+    m_lastSample = v;
+    m_position++;
+  }
+
+  // only the last two periods are ever compared
+  if (m_history.size() > 4 * (m_maxPeriod + 1)) {
+    unsigned toRemove = m_history.size() - 2 * (m_maxPeriod + 1);
+    m_history.erase(m_history.begin(), m_history.begin() + toRemove);
+    m_historyStart += toRemove;
+  }
+}
+
+void PitchTracker::Finish() {
+  CloseWindowsBefore(m_position / m_windowSamples + 1);
+}
+
+const std::vector<PITCH_TRACK_POINT>& PitchTracker::GetTrack() {
+  return m_track;
+}
+
+void PitchTracker::PositiveZeroCrossing(unsigned long index, double exactPosition) {
+  if (!m_hasPeriodStart || index - m_periodStart > m_maxPeriod) {
+    // nothing to compare with yet or the period would be too long
+    m_hasPeriodStart = true;
+    m_periodStart = index;
+    m_periodStartExact = exactPosition;
+    return;
+  }
+
+  unsigned len = index - m_periodStart;
+  if (m_periodStart < m_historyStart + len)
+    return; // the previous period isn't available
+
+  // Find the RMS of the previous period and the error of the candidate period
+  const double *previous = &m_history[m_periodStart - len - m_historyStart];
+  const double *current = &m_history[m_periodStart - m_historyStart];
+  double rms = 0.0;
+  double error_rms = 0.0;
+  for (unsigned j = 0; j < len; j++) {
+    double error = previous[j] - current[j];
+    error_rms += error * error;
+    rms += previous[j] * previous[j];
+  }
+
+  if (error_rms > 0.0 && rms > 0.0 && sqrt(error_rms / rms) < 0.55) {
+    double period = exactPosition - m_periodStartExact;
+    if (period > 0)
+      AddPitch(m_periodStart, (double) m_samplerate / period);
+
+    m_periodStart = index;
+    m_periodStartExact = exactPosition;
+  }
+  // otherwise the crossing was within a period and the next one is tried
+}
+
+void PitchTracker::AddPitch(unsigned long position, double pitch) {
+  unsigned long window = position / m_windowSamples;
+  if (window > m_currentWindow)
+    CloseWindowsBefore(window);
+  m_windowPitches.push_back(pitch);
+}
+
+void PitchTracker::CloseWindowsBefore(unsigned long window) {
+  while (m_currentWindow < window) {
+    PITCH_TRACK_POINT point;
+    point.time = ((double) m_currentWindow + 0.5) * m_windowSamples / (double) m_samplerate;
+    point.pitch = 0;
+    if (!m_windowPitches.empty()) {
+      // the median isn't thrown off by a single bad period
+      std::nth_element(m_windowPitches.begin(), m_windowPitches.begin() + m_windowPitches.size() / 2, m_windowPitches.end());
+      point.pitch = m_windowPitches[m_windowPitches.size() / 2];
+      m_windowPitches.clear();
+    }
+    m_track.push_back(point);
+    m_currentWindow++;
+  }
+}
+
+bool PitchTracker::CalculateStability(const std::vector<PITCH_TRACK_POINT> &track, double startTime, double endTime, PITCH_STABILITY &result) {
+  result.meanPitch = 0;
+  result.driftCents = 0;
+  result.centsStdDev = 0;
+  result.points = 0;
+  result.startTime = startTime;
+  result.endTime = endTime;
+
+  std::vector<PITCH_TRACK_POINT> usable;
+  for (unsigned i = 0; i < track.size(); i++) {
+    if (track[i].pitch > 0 && track[i].time >= startTime && track[i].time <= endTime)
+      usable.push_back(track[i]);
+  }
+  if (usable.size() < 2)
+    return false;
+
+  // octave errors and other windows more than a semitone off the median are ignored
+  std::vector<double> pitches;
+  for (unsigned i = 0; i < usable.size(); i++)
+    pitches.push_back(usable[i].pitch);
+  std::nth_element(pitches.begin(), pitches.begin() + pitches.size() / 2, pitches.end());
+  double median = pitches[pitches.size() / 2];
+
+  std::vector<double> times;
+  std::vector<double> logPitches;
+  for (unsigned i = 0; i < usable.size(); i++) {
+    double cents = 1200.0 * log2(usable[i].pitch / median);
+    if (fabs(cents) <= 100.0) {
+      times.push_back(usable[i].time);
+      logPitches.push_back(log2(usable[i].pitch));
+    }
+  }
+  if (times.size() < 2)
+    return false;
+
+  double n = times.size();
+  double meanLog = 0;
+  double meanTime = 0;
+  for (unsigned i = 0; i < times.size(); i++) {
+    meanLog += logPitches[i];
+    meanTime += times[i];
+  }
+  meanLog /= n;
+  meanTime /= n;
+
+  // variance in cents around the mean and a linear fit of cents over time
+  double variance = 0;
+  double covariance = 0;
+  double timeVariance = 0;
+  for (unsigned i = 0; i < times.size(); i++) {
+    double cents = 1200.0 * (logPitches[i] - meanLog);
+    double dt = times[i] - meanTime;
+    variance += cents * cents;
+    covariance += cents * dt;
+    timeVariance += dt * dt;
+  }
+
+  result.meanPitch = pow(2.0, meanLog);
+  result.centsStdDev = sqrt(variance / n);
+  if (timeVariance > 0)
+    result.driftCents = covariance / timeVariance * (times.back() - times.front());
+  result.points = times.size();
+  return true;
+}
@@ -0,0 +1,81 @@
+/*
+ * PitchTracker.h is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#ifndef PITCHTRACKER_H
+#define PITCHTRACKER_H
+
+#include <vector>
+
+typedef struct {
+  double time;  // center of the window in seconds
+  double pitch; // 0 if no pitch was found in the window
+} PITCH_TRACK_POINT;
+
+typedef struct {
+  double meanPitch;   // in Hz
+  double driftCents;  // change over the analysed section from a linear fit
+  double centsStdDev; // standard deviation around the mean pitch
+  unsigned points;    // number of windows that had a usable pitch
+  double startTime;   // the analysed section in seconds
+  double endTime;
+} PITCH_STABILITY;
+
+/*
+ * PitchTracker uses the same period matching as the time domain pitch
+ * detection but keeps the result per window instead of one mean value. The
+ * audio is fed in blocks of any size and only the last couple of periods are
+ * kept in memory. Zero crossings are interpolated so the periods have sub
+ * sample precision which matters when comparing windows in cents.
+ */
+class PitchTracker {
+public:
+  PitchTracker(unsigned samplerate, double windowLength = 0.05, double lowestPitch = 20.0);
+  ~PitchTracker();
+
+  void Process(const double *data, unsigned length);
+  // Call when all audio is processed to get the last window too
+  void Finish();
+  const std::vector<PITCH_TRACK_POINT>& GetTrack();
+
+  // Stability of the pitch between startTime and endTime (seconds)
+  static bool CalculateStability(const std::vector<PITCH_TRACK_POINT> &track, double startTime, double endTime, PITCH_STABILITY &result);
+
+private:
+  unsigned m_samplerate;
+  unsigned m_windowSamples;
+  unsigned m_maxPeriod;
+  std::vector<double> m_history;
+  unsigned long m_historyStart; // sample index of m_history[0]
+  unsigned long m_position; // sample index of the next sample to process
+  double m_lastSample;
+  bool m_hasPeriodStart;
+  unsigned long m_periodStart;
+  double m_periodStartExact;
+  unsigned long m_currentWindow;
+  std::vector<double> m_windowPitches;
+  std::vector<PITCH_TRACK_POINT> m_track;
+
+  void PositiveZeroCrossing(unsigned long index, double exactPosition);
+  void AddPitch(unsigned long position, double pitch);
+  void CloseWindowsBefore(unsigned long window);
+
+};
+
+#endif
@@ -0,0 +1,205 @@
+/*
+ * PlaybackBenchmark.cpp is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#include "PlaybackBenchmark.h"
+#include "PlaybackEngine.h"
+#include <wx/stopwatch.h>
+#include <algorithm>
+#include <cmath>
+
+PlaybackBenchmark::PlaybackBenchmark(FileHandling *audioFile) :
+  m_audioFile(audioFile),
+  m_frames(0),
+  m_channels(1),
+  m_loopStart(0),
+  m_loopEnd(0) {
+  // the output is compared to the data in memory even for streamed playback
+  m_audioFile->EnsurePlaybackData();
+  m_channels = m_audioFile->m_channels;
+  m_frames = m_audioFile->ArrayLength / m_channels;
+
+  // the first loop, or the whole file when there are none
+  if (m_audioFile->m_loops->GetNumberOfLoops() > 0) {
+    LOOPDATA loop;
+    m_audioFile->m_loops->GetLoopData(0, loop);
+    m_loopStart = loop.dwStart;
+    m_loopEnd = loop.dwEnd;
+  } else if (m_frames > 0) {
+    m_loopEnd = m_frames - 1;
+  }
+}
+
+PlaybackBenchmark::~PlaybackBenchmark() {
+
+}
+
+bool PlaybackBenchmark::Run(double seconds) {
+  m_results.clear();
+  if (m_frames == 0 || m_loopEnd >= m_frames || m_loopStart > m_loopEnd)
+    return false;
+
+  // a device samplerate the file doesn't have
+  double otherRate = m_audioFile->GetSampleRate() == 48000 ? 44100.0 : 48000.0;
+  double ratio = otherRate / m_audioFile->GetSampleRate();
+
+  unsigned bufferSizes[] = { 64, 256, 1024 };
+  for (unsigned i = 0; i < 3; i++)
+    m_results.push_back(RunMode(wxT("memory"), bufferSizes[i], 1.0, false, seconds));
+  for (unsigned i = 0; i < 3; i++)
+    m_results.push_back(RunMode(wxT("memory resampled"), bufferSizes[i], ratio, false, seconds));
+  m_results.push_back(RunMode(wxT("streamed"), 256, 1.0, true, seconds));
+  m_results.push_back(RunMode(wxT("streamed resampled"), 256, ratio, true, seconds));
+
+  bool passed = true;
+  for (unsigned i = 0; i < m_results.size(); i++) {
+    if (m_results[i].buffers == 0 || m_results[i].errors > 0)
+      passed = false;
+  }
+  return passed;
+}
+
+PLAYBACK_BENCHMARK_RESULT PlaybackBenchmark::RunMode(wxString mode, unsigned bufferFrames, double ratio, bool streamed, double seconds) {
+  PLAYBACK_BENCHMARK_RESULT result;
+  result.mode = mode;
+  result.bufferFrames = bufferFrames;
+  result.buffers = 0;
+  result.median = 0;
+  result.percentile99 = 0;
+  result.maximum = 0;
+  result.deadlineMisses = 0;
+  result.loopWraps = 0;
+  result.dropouts = 0;
+  result.errors = 0;
+  result.checked = ratio == 1.0;
+
+  PlaybackEngine engine;
+  engine.SetOutputChannels(m_channels);
+  engine.SetLoop(m_loopStart, m_loopEnd);
+  engine.SetLooping(true);
+  engine.SetGain(1.0f);
+  if (streamed) {
+    wxString filePath = m_audioFile->GetFilePath() + wxFILE_SEP_PATH + m_audioFile->GetFileName();
+    if (!engine.SetStreamedAudio(filePath, m_frames, m_channels, m_audioFile->GetSampleRate(), ratio))
+      return result;
+  } else {
+    if (!engine.SetAudioData(m_audioFile->floatAudioData, m_frames, m_channels, ratio))
+      return result;
+  }
+
+  // start a second before the loop so that both the way in and the wrap are played
+  unsigned long expected = m_loopStart > (unsigned) m_audioFile->GetSampleRate() ? m_loopStart - m_audioFile->GetSampleRate() : 0;
+  engine.Seek(expected);
+
+  double deviceRate = m_audioFile->GetSampleRate() * ratio;
+  double bufferDuration = bufferFrames / deviceRate * 1000000.0;
+  unsigned buffers = (unsigned) (seconds * deviceRate / bufferFrames);
+  std::vector<float> output(bufferFrames * m_channels);
+  std::vector<double> times;
+  times.reserve(buffers);
+  const float *data = m_audioFile->floatAudioData;
+
+  wxStopWatch clock;
+  for (unsigned b = 0; b < buffers; b++) {
+    double streamTime = b * bufferFrames / deviceRate;
+    if (streamed) {
+      while (clock.TimeInMicro().ToDouble() < streamTime * 1000000.0)
+        wxMilliSleep(1);
+    }
+
+    wxStopWatch watch;
+    PlaybackEngine::AudioCallback(&output[0], NULL, bufferFrames, streamTime, 0, &engine);
+    double used = watch.TimeInMicro().ToDouble();
+    times.push_back(used);
+    if (used > bufferDuration)
+      result.deadlineMisses++;
+
+    if (result.checked) {
+      for (unsigned i = 0; i < bufferFrames; i++) {
+        const float *frame = &output[i * m_channels];
+        const float *should = data + expected * m_channels;
+        bool matches = true;
+        bool silent = true;
+        for (unsigned ch = 0; ch < m_channels; ch++) {
+          if (fabs(frame[ch] - should[ch]) > 1e-6f)
+            matches = false;
+          if (frame[ch] != 0.0f)
+            silent = false;
+        }
+
+        // a disk stream that hasn't caught up gives silence without moving
+        // on, any other frame takes the place of the expected one
+        if (!matches && silent) {
+          result.dropouts++;
+          continue;
+        }
+        if (!matches)
+          result.errors++;
+        if (expected == m_loopEnd) {
+          expected = m_loopStart;
+          result.loopWraps++;
+        } else {
+          expected++;
+        }
+      }
+    }
+  }
+  result.buffers = times.size();
+
+  if (!times.empty()) {
+    std::sort(times.begin(), times.end());
+    result.median = times[(times.size() - 1) / 2];
+    result.percentile99 = times[(unsigned) ((times.size() - 1) * 0.99)];
+    result.maximum = times.back();
+  }
+
+  return result;
+}
+
+wxString PlaybackBenchmark::GetReport() {
+  wxString report = wxString::Format(
+    wxT("Playback benchmark of %s\n%i Hz, %u channels, %lu frames, loop %u - %u\n\n"),
+    m_audioFile->GetFileName(),
+    m_audioFile->GetSampleRate(),
+    m_channels,
+    m_frames,
+    m_loopStart,
+    m_loopEnd
+  );
+  report += wxT("mode                 buffer   p50 us   p99 us   max us  misses  wraps  dropouts  errors\n");
+  for (unsigned i = 0; i < m_results.size(); i++) {
+    PLAYBACK_BENCHMARK_RESULT &r = m_results[i];
+    wxString errors = r.checked ? wxString::Format(wxT("%u"), r.errors) : wxString(wxT("-"));
+    wxString wraps = r.checked ? wxString::Format(wxT("%u"), r.loopWraps) : wxString(wxT("-"));
+    report += wxString::Format(
+      wxT("%-20s %6u %8.1f %8.1f %8.1f %7u %6s %9u %7s\n"),
+      r.mode,
+      r.bufferFrames,
+      r.median,
+      r.percentile99,
+      r.maximum,
+      r.deadlineMisses,
+      wraps,
+      r.dropouts,
+      errors
+    );
+  }
+
+  return report;
+}
@@ -0,0 +1,71 @@
+/*
+ * PlaybackBenchmark.h is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#ifndef PLAYBACKBENCHMARK_H
+#define PLAYBACKBENCHMARK_H
+
+#include <wx/wx.h>
+#include <vector>
+#include "FileHandling.h"
+
+typedef struct {
+  wxString mode;
+  unsigned bufferFrames;
+  unsigned buffers;
+  double median; // callback time in microseconds
+  double percentile99;
+  double maximum;
+  unsigned deadlineMisses; // callbacks slower than the buffer duration
+  unsigned loopWraps;
+  unsigned dropouts; // silent frames while a disk stream caught up
+  unsigned errors; // frames that weren't the ones that should be heard
+  bool checked; // resampled output can't be compared frame by frame
+} PLAYBACK_BENCHMARK_RESULT;
+
+/*
+ * PlaybackBenchmark drives the playback engine without a sound card. The
+ * audio callback is called back to back on a simulated stream clock and the
+ * time of each call is measured against the duration of the buffer it fills.
+ * Streamed playback is paced in real time since the disk reader must keep up.
+ * When the audio isn't resampled every output frame is compared to the frame
+ * that should be heard, so the loop wrap is checked sample by sample.
+ */
+class PlaybackBenchmark {
+public:
+  PlaybackBenchmark(FileHandling *audioFile);
+  ~PlaybackBenchmark();
+
+  // False if any checked frame was wrong
+  bool Run(double seconds);
+  wxString GetReport();
+
+private:
+  FileHandling *m_audioFile;
+  unsigned long m_frames;
+  unsigned m_channels;
+  unsigned m_loopStart;
+  unsigned m_loopEnd;
+  std::vector<PLAYBACK_BENCHMARK_RESULT> m_results;
+
+  PLAYBACK_BENCHMARK_RESULT RunMode(wxString mode, unsigned bufferFrames, double ratio, bool streamed, double seconds);
+
+};
+
+#endif
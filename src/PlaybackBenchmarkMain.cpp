@@ -0,0 +1,78 @@
+/*
+ * PlaybackBenchmarkMain.cpp is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+// LoopAuditioneerBenchmark is a console program so that the playback engine
+// can be measured on machines without a display
+
+#include <wx/wx.h>
+#include <wx/init.h>
+#include <wx/cmdline.h>
+#include <wx/filename.h>
+#include "PlaybackBenchmark.h"
+#include "FileHandling.h"
+#include "AnalysisCache.h"
+
+static const wxCmdLineEntryDesc cmdLineDesc[] = {
+  { wxCMD_LINE_SWITCH, "h", "help", "show this help", wxCMD_LINE_VAL_NONE, wxCMD_LINE_OPTION_HELP },
+  { wxCMD_LINE_OPTION, "s", "seconds", "seconds of audio to play in each mode (default 10)", wxCMD_LINE_VAL_DOUBLE, 0 },
+  { wxCMD_LINE_PARAM, NULL, NULL, "audio file", wxCMD_LINE_VAL_STRING, 0 },
+  { wxCMD_LINE_NONE, NULL, NULL, NULL, wxCMD_LINE_VAL_NONE, 0 }
+};
+
+int main(int argc, char **argv) {
+  wxInitializer initializer(argc, argv);
+  if (!initializer.IsOk()) {
+    fprintf(stderr, "Could not initialize wxWidgets\n");
+    return 1;
+  }
+
+  wxCmdLineParser parser(cmdLineDesc, argc, argv);
+  parser.SetLogo(wxT("Benchmark of the LoopAuditioneer playback engine"));
+  int parsed = parser.Parse();
+  if (parsed == -1)
+    return 0;
+  if (parsed != 0)
+    return 1;
+
+  double seconds = 10.0;
+  if (parser.Found(wxT("s"), &seconds) && seconds <= 0) {
+    wxFprintf(stderr, wxT("The number of seconds must be above zero\n"));
+    return 1;
+  }
+
+  wxFileName fn(parser.GetParam(0));
+  fn.MakeAbsolute();
+  FileHandling *audioFile = new FileHandling(fn.GetFullName(), fn.GetPath());
+  if (!audioFile->FileCouldBeOpened()) {
+    wxFprintf(stderr, wxT("Could not open %s\n"), fn.GetFullPath());
+    delete audioFile;
+    return 1;
+  }
+
+  PlaybackBenchmark *benchmark = new PlaybackBenchmark(audioFile);
+  bool passed = benchmark->Run(seconds);
+  wxPrintf(wxT("%s"), benchmark->GetReport());
+
+  delete benchmark;
+  delete audioFile;
+  AnalysisCache::FlushAll();
+
+  return passed ? 0 : 1;
+}
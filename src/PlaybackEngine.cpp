@@ -0,0 +1,539 @@
+/*
+ * PlaybackEngine.cpp is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#include "PlaybackEngine.h"
+#include "FileHandling.h"
+#include <cmath>
+#include <algorithm>
+
+// Kept free of aliasing and branches so the compiler can vectorise it
+static inline void ScaleCopy(float * __restrict dest, const float * __restrict source, unsigned long count, float gain) {
+  for (unsigned long i = 0; i < count; i++)
+    dest[i] = source[i] * gain;
+}
+
+PlaybackEngine::PlaybackEngine() :
+  m_data(NULL),
+  m_frames(0),
+  m_channels(1),
+  m_outputChannels(1),
+  m_ratio(1.0),
+  m_stream(NULL),
+  m_resampler(NULL),
+  m_loop(0),
+  m_looping(false),
+  m_gain(1.0f),
+  m_crossfade(0),
+  m_pitchFactor(1.0),
+  m_seek(-1),
+  m_playPosition(0),
+  m_reachedEnd(false),
+  m_xruns(0),
+  m_stampSequence(0),
+  m_stampFrame(0),
+  m_stampTime(0),
+  m_tapEnabled(false),
+  m_frame(0),
+  m_resampling(false),
+  m_resampledPosition(0),
+  m_loopStart(0),
+  m_loopEnd(0),
+  m_loopingNow(false),
+  m_fadeFrames(0),
+  m_fadeType(0),
+  m_pendingConsume(0),
+  m_maxStreamLead(0),
+  m_streamLead(0),
+  m_underrun(false) {
+
+}
+
+PlaybackEngine::~PlaybackEngine() {
+  ReleaseAudio();
+}
+
+bool PlaybackEngine::SetAudioData(const float *data, unsigned long frames, unsigned channels, double ratio) {
+  ReleaseAudio();
+  m_data = data;
+  if (!PrepareAudio(frames, channels, ratio)) {
+    ReleaseAudio();
+    return false;
+  }
+  return true;
+}
+
+bool PlaybackEngine::SetStreamedAudio(wxString filePath, unsigned long frames, unsigned channels, unsigned sampleRate, double ratio) {
+  ReleaseAudio();
+  m_stream = new DiskStream(filePath, channels, frames);
+  if (!m_stream->IsOk()) {
+    delete m_stream;
+    m_stream = NULL;
+    m_lastError = wxT("Could not read ") + filePath;
+    return false;
+  }
+  if (!PrepareAudio(frames, channels, ratio)) {
+    ReleaseAudio();
+    return false;
+  }
+  m_maxStreamLead = (unsigned long) (sampleRate * PLAYBACK_STREAM_MAX_FADE_SECONDS);
+
+  // the stream only changes loop at seeks so it starts with what is set now
+  LatchLoop();
+  RestartStream();
+  return true;
+}
+
+void PlaybackEngine::ReleaseAudio() {
+  if (m_stream) {
+    delete m_stream;
+    m_stream = NULL;
+  }
+  if (m_resampler) {
+    src_delete(m_resampler);
+    m_resampler = NULL;
+  }
+  m_data = NULL;
+  m_frames = 0;
+}
+
+bool PlaybackEngine::PrepareAudio(unsigned long frames, unsigned channels, double ratio) {
+  m_frames = frames;
+  m_channels = channels > 0 ? channels : 1;
+  m_ratio = ratio > 0 ? ratio : 1.0;
+  m_frame = 0;
+  m_resampling = m_ratio != 1.0;
+  m_resampledPosition = 0;
+  m_playPosition.store(0);
+  m_reachedEnd.store(false);
+  m_xruns.store(0);
+  m_stampSequence.store(0);
+  m_pendingConsume = 0;
+  m_underrun = false;
+
+  // also created at the original samplerate for previewing pitch corrections
+  int error = 0;
+  m_resampler = src_callback_new(&PlaybackEngine::ResamplerInput, SRC_SINC_MEDIUM_QUALITY, m_channels, &error, this);
+  if (m_resampler == NULL) {
+    // without it the audio would play at the wrong speed
+    m_lastError = wxT("Could not create the resampler: ") + wxString::FromUTF8(src_strerror(error));
+    return false;
+  }
+  m_resampled.resize(PLAYBACK_RESAMPLE_BLOCK * m_channels);
+  m_crossfaded.resize(PLAYBACK_RESAMPLE_BLOCK * m_channels);
+  m_lastError = wxEmptyString;
+  return true;
+}
+
+void PlaybackEngine::SetOutputChannels(unsigned channels) {
+  m_outputChannels = channels;
+  m_tap.Reset(channels, PLAYBACK_TAP_FRAMES);
+}
+
+void PlaybackEngine::SetLoop(unsigned loopStart, unsigned loopEnd) {
+  m_loop.store(((unsigned long long) loopStart << 32) | loopEnd);
+}
+
+void PlaybackEngine::SetLooping(bool looping) {
+  m_looping.store(looping);
+}
+
+void PlaybackEngine::Seek(unsigned position) {
+  m_seek.store(position);
+}
+
+void PlaybackEngine::SetGain(float gain) {
+  m_gain.store(gain);
+}
+
+void PlaybackEngine::SetPitchCorrection(double cents) {
+  m_pitchFactor.store(pow(2.0, cents / 1200.0));
+}
+
+void PlaybackEngine::SetCrossfade(unsigned fadeFrames, int fadeType) {
+  m_crossfade.store(((unsigned long long) fadeFrames << 32) | (unsigned) fadeType);
+}
+
+unsigned PlaybackEngine::GetPlayPosition() {
+  // a seek that the callback hasn't picked up yet is where playback will be
+  long long pending = m_seek.load();
+  if (pending >= 0)
+    return (unsigned) pending;
+  return m_playPosition.load();
+}
+
+unsigned PlaybackEngine::GetPlayPositionAt(double streamTime, unsigned sampleRate) {
+  long long pending = m_seek.load();
+  if (pending >= 0)
+    return (unsigned) pending;
+
+  // read the stamp again if the callback wrote it meanwhile
+  unsigned long frame = 0;
+  double time = 0;
+  bool gotStamp = false;
+  for (int tries = 0; tries < 4 && !gotStamp; tries++) {
+    unsigned sequence = m_stampSequence.load();
+    if (sequence == 0)
+      break;
+    if (sequence & 1)
+      continue;
+    frame = m_stampFrame.load();
+    time = m_stampTime.load();
+    gotStamp = m_stampSequence.load() == sequence;
+  }
+  if (!gotStamp)
+    return m_playPosition.load();
+
+  // the stamp is never more than a few buffers old
+  double elapsed = streamTime - time;
+  if (elapsed > 1.0)
+    elapsed = 1.0;
+  else if (elapsed < -1.0)
+    elapsed = -1.0;
+  long long position = (long long) frame + (long long) floor(elapsed * sampleRate * m_pitchFactor.load() + 0.5);
+
+  unsigned long long loop = m_loop.load();
+  long long loopStart = (long long) (loop >> 32);
+  long long loopEnd = (long long) (loop & 0xFFFFFFFFULL);
+  if (m_looping.load() && loopEnd >= loopStart && (long long) frame >= loopStart && (long long) frame <= loopEnd) {
+    long long loopLength = loopEnd + 1 - loopStart;
+    while (position > loopEnd)
+      position -= loopLength;
+    while (position < loopStart)
+      position += loopLength;
+  }
+  if (position < 0)
+    position = 0;
+  if (position > (long long) m_frames)
+    position = m_frames;
+
+  return (unsigned) position;
+}
+
+bool PlaybackEngine::HasReachedEnd() {
+  return m_reachedEnd.load();
+}
+
+unsigned PlaybackEngine::GetXrunCount() {
+  return m_xruns.load();
+}
+
+unsigned PlaybackEngine::GetOutputChannels() {
+  return m_outputChannels;
+}
+
+double PlaybackEngine::GetResampleRatio() {
+  return m_ratio;
+}
+
+wxString PlaybackEngine::GetLastError() {
+  return m_lastError;
+}
+
+void PlaybackEngine::SetOutputTap(bool enabled) {
+  // a reader starts with what is played from now on
+  if (enabled)
+    m_tap.Discard();
+  m_tapEnabled.store(enabled);
+}
+
+unsigned long PlaybackEngine::ReadOutput(float *dest, unsigned long maxFrames) {
+  return m_tap.Read(dest, maxFrames);
+}
+
+int PlaybackEngine::AudioCallback(void *outputBuffer,
+                                  void *inputBuffer,
+                                  unsigned nBufferFrames,
+                                  double streamTime,
+                                  RtAudioStreamStatus status,
+                                  void *userData) {
+  (void)inputBuffer;
+
+  PlaybackEngine *engine = static_cast<PlaybackEngine*>(userData);
+  if (status & RTAUDIO_OUTPUT_UNDERFLOW)
+    engine->m_xruns.store(engine->m_xruns.load() + 1);
+  engine->Render(static_cast<float*>(outputBuffer), nBufferFrames, streamTime);
+
+  return 0;
+}
+
+void PlaybackEngine::LatchLoop() {
+  unsigned long long loop = m_loop.load();
+  m_loopStart = (unsigned long) (loop >> 32);
+  m_loopEnd = (unsigned long) (loop & 0xFFFFFFFFULL);
+  m_loopingNow = m_looping.load() && m_loopEnd >= m_loopStart;
+}
+
+void PlaybackEngine::LatchCrossfade() {
+  // the fade can't read before the data or reach back past the loop start
+  unsigned long long crossfade = m_crossfade.load();
+  m_fadeFrames = (unsigned long) (crossfade >> 32);
+  m_fadeType = (int) (crossfade & 0xFFFFFFFFULL);
+  if (m_fadeFrames > m_loopStart)
+    m_fadeFrames = m_loopStart;
+  if (m_fadeFrames > m_loopEnd + 1 - m_loopStart)
+    m_fadeFrames = m_loopEnd + 1 - m_loopStart;
+  if (m_stream && m_fadeFrames > m_streamLead)
+    m_fadeFrames = m_streamLead;
+  if (!m_loopingNow || m_loopEnd >= m_frames || m_fadeFrames < 2)
+    m_fadeFrames = 0;
+}
+
+void PlaybackEngine::RestartStream() {
+  // what was handed out but not consumed is dropped with the rest of the buffer
+  m_pendingConsume = 0;
+  m_streamLead = m_maxStreamLead;
+  if (m_streamLead > m_loopStart)
+    m_streamLead = m_loopStart;
+  m_stream->Restart(m_frame, m_loopStart, m_loopEnd, m_loopingNow, m_streamLead);
+}
+
+void PlaybackEngine::Render(float *buffer, unsigned nFrames, double streamTime) {
+  // take over what the GUI has published since the last buffer
+  long long seek = m_seek.exchange(-1);
+  if (!m_stream || seek >= 0)
+    LatchLoop();
+  double ratio = m_ratio / m_pitchFactor.load();
+  if (seek >= 0) {
+    m_frame = seek;
+    m_resampledPosition = seek;
+    m_resampling = ratio != 1.0;
+    if (m_resampler)
+      src_reset(m_resampler);
+    if (m_stream)
+      RestartStream();
+  }
+  LatchCrossfade();
+  float gain = m_gain.load();
+
+  // a pitch correction takes over from where direct playback is
+  if (!m_resampling && ratio != 1.0 && m_resampler) {
+    m_resampling = true;
+    m_resampledPosition = m_frame;
+    src_reset(m_resampler);
+  }
+
+  // what starts playing with this buffer, for the GUI to extrapolate from
+  unsigned long startFrame = m_resampling ? (unsigned long) m_resampledPosition : m_frame;
+  if (m_loopingNow && startFrame > m_loopEnd)
+    startFrame = m_loopStart;
+  m_stampSequence.store(m_stampSequence.load() + 1);
+  m_stampFrame.store(startFrame);
+  m_stampTime.store(streamTime);
+  m_stampSequence.store(m_stampSequence.load() + 1);
+
+  // channels the device can't take are skipped
+  unsigned useChannels = m_outputChannels < m_channels ? m_outputChannels : m_channels;
+
+  unsigned done = 0;
+  if (m_data || m_stream) {
+    if (m_resampling && m_resampler)
+      done = RenderResampled(buffer, nFrames, useChannels, gain, ratio);
+    else
+      done = RenderDirect(buffer, nFrames, useChannels, gain);
+  }
+
+  // silence for whatever is left of the buffer
+  if (done < nFrames)
+    std::fill(buffer + done * m_outputChannels, buffer + nFrames * m_outputChannels, 0.0f);
+
+  if (m_tapEnabled.load())
+    m_tap.Write(buffer, nFrames);
+
+  if (m_resampling)
+    m_playPosition.store((unsigned long) m_resampledPosition);
+  else
+    m_playPosition.store(m_frame);
+}
+
+unsigned PlaybackEngine::RenderDirect(float *buffer, unsigned nFrames, unsigned useChannels, float gain) {
+  unsigned done = 0;
+  while (done < nFrames) {
+    unsigned long span = 0;
+    const float *source = NextSourceBlock(nFrames - done, span);
+    if (source == NULL) {
+      // a disk stream that hasn't caught up only gives silence
+      if (!m_underrun)
+        m_reachedEnd.store(true);
+      break;
+    }
+
+    if (useChannels == m_channels) {
+      ScaleCopy(buffer, source, span * m_channels, gain);
+      buffer += span * m_channels;
+    } else {
+      for (unsigned long i = 0; i < span; i++) {
+        ScaleCopy(buffer, source, useChannels, gain);
+        buffer += useChannels;
+        source += m_channels;
+      }
+    }
+    done += span;
+
+    if (m_loopingNow && m_frame > m_loopEnd)
+      m_frame = m_loopStart;
+  }
+
+  return done;
+}
+
+unsigned PlaybackEngine::RenderResampled(float *buffer, unsigned nFrames, unsigned useChannels, float gain, double ratio) {
+  unsigned done = 0;
+  while (done < nFrames) {
+    long wanted = nFrames - done;
+    if (wanted > PLAYBACK_RESAMPLE_BLOCK)
+      wanted = PLAYBACK_RESAMPLE_BLOCK;
+
+    if (m_stream) {
+      // running out of input would end the resampling so wait for the disk
+      unsigned long needed = (unsigned long) (wanted / ratio) + PLAYBACK_RESAMPLE_BLOCK;
+      if (!m_loopingNow && m_frame < m_frames && m_frames - m_frame < needed)
+        needed = m_frames - m_frame;
+      unsigned long available = m_stream->Available();
+      available = available > m_pendingConsume ? available - m_pendingConsume : 0;
+      if (available < needed && m_frame < m_frames)
+        break;
+    }
+
+    long generated = src_callback_read(m_resampler, ratio, wanted, &m_resampled[0]);
+    if (generated <= 0) {
+      // the input has ended and the resampler is drained
+      m_reachedEnd.store(true);
+      break;
+    }
+
+    const float *source = &m_resampled[0];
+    if (useChannels == m_channels) {
+      ScaleCopy(buffer, source, generated * m_channels, gain);
+      buffer += generated * m_channels;
+    } else {
+      for (long i = 0; i < generated; i++) {
+        ScaleCopy(buffer, source, useChannels, gain);
+        buffer += useChannels;
+        source += m_channels;
+      }
+    }
+    done += generated;
+
+    m_resampledPosition += generated / ratio;
+    while (m_loopingNow && m_resampledPosition >= m_loopEnd + 1)
+      m_resampledPosition -= m_loopEnd + 1 - m_loopStart;
+    if (m_resampledPosition > m_frames)
+      m_resampledPosition = m_frames;
+  }
+
+  return done;
+}
+
+unsigned long PlaybackEngine::NextSpan(unsigned long maxFrames) {
+  if (m_loopingNow && m_frame > m_loopEnd)
+    m_frame = m_loopStart;
+  if (m_frame >= m_frames)
+    return 0;
+
+  // the longest stretch that doesn't pass the loop end or the end of data
+  unsigned long span = m_frames - m_frame;
+  if (maxFrames < span)
+    span = maxFrames;
+  if (m_loopingNow && m_loopEnd + 1 - m_frame < span)
+    span = m_loopEnd + 1 - m_frame;
+
+  // the crossfade is mixed block by block from where it starts
+  if (m_fadeFrames) {
+    unsigned long fadeStart = m_loopEnd + 1 - m_fadeFrames;
+    if (m_frame < fadeStart && fadeStart - m_frame < span)
+      span = fadeStart - m_frame;
+    else if (m_frame >= fadeStart && span > PLAYBACK_RESAMPLE_BLOCK)
+      span = PLAYBACK_RESAMPLE_BLOCK;
+  }
+
+  return span;
+}
+
+const float* PlaybackEngine::NextSourceBlock(unsigned long maxFrames, unsigned long &frames) {
+  // what was handed out last time has been used by now
+  if (m_pendingConsume) {
+    m_stream->Consume(m_pendingConsume);
+    m_pendingConsume = 0;
+  }
+
+  m_underrun = false;
+  frames = NextSpan(maxFrames);
+  if (frames == 0)
+    return NULL;
+
+  const float *block;
+  if (m_stream) {
+    block = m_stream->Peek(frames);
+    if (frames == 0) {
+      m_underrun = true;
+      return NULL;
+    }
+    m_pendingConsume = frames;
+  } else {
+    block = m_data + m_frame * m_channels;
+  }
+
+  if (m_fadeFrames && m_frame + m_fadeFrames > m_loopEnd)
+    block = CrossfadeBlock(block, frames);
+
+  m_frame += frames;
+  return block;
+}
+
+const float* PlaybackEngine::CrossfadeBlock(const float *block, unsigned long frames) {
+  // the frames one loop length back are what PerformCrossfade fades in
+  unsigned long loopLength = m_loopEnd + 1 - m_loopStart;
+  const float *source;
+  if (m_stream)
+    source = m_stream->GetPinnedFrames(m_frame - loopLength);
+  else
+    source = m_data + (m_frame - loopLength) * m_channels;
+  if (source == NULL)
+    return block;
+
+  float *dest = &m_crossfaded[0];
+  unsigned long first = m_frame - (m_loopEnd + 1 - m_fadeFrames);
+  double last = m_fadeFrames - 1;
+  for (unsigned long i = 0; i < frames; i++) {
+    double position = first + i;
+    float targetGain = (float) FileHandling::CrossfadeCurve(m_fadeType, (last - position) / last);
+    float sourceGain = (float) FileHandling::CrossfadeCurve(m_fadeType, position / last);
+    for (unsigned ch = 0; ch < m_channels; ch++) {
+      *dest = *block * targetGain + *source * sourceGain;
+      dest++;
+      block++;
+      source++;
+    }
+  }
+
+  return &m_crossfaded[0];
+}
+
+long PlaybackEngine::ResamplerInput(void *userData, float **data) {
+  // libsamplerate asks for more input, it's handed a pointer into the data
+  PlaybackEngine *engine = static_cast<PlaybackEngine*>(userData);
+  unsigned long frames = 0;
+  const float *block = engine->NextSourceBlock(PLAYBACK_RESAMPLE_BLOCK, frames);
+  if (block == NULL)
+    return 0;
+
+  *data = const_cast<float*>(block);
+  return frames;
+}
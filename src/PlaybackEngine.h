@@ -0,0 +1,163 @@
+/*
+ * PlaybackEngine.h is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#ifndef PLAYBACKENGINE_H
+#define PLAYBACKENGINE_H
+
+#include <wx/wx.h>
+#include "RtAudio.h"
+#include "DiskStream.h"
+#include "AudioRing.h"
+#include <samplerate.h>
+#include <atomic>
+#include <vector>
+
+// Largest number of frames taken from or given to the resampler at a time
+#define PLAYBACK_RESAMPLE_BLOCK 1024
+// Frames of output kept for the GUI to meter and analyse
+#define PLAYBACK_TAP_FRAMES 32768
+// Longest crossfade that can be auditioned on a disk stream, the stream keeps
+// this much before the loop start in memory for it (as long as the fade slider goes)
+#define PLAYBACK_STREAM_MAX_FADE_SECONDS 1.0
+
+/*
+ * PlaybackEngine holds everything the audio callback needs so that it never
+ * has to reach into the frame or the file. The audio data itself is only
+ * changed while the stream is stopped. Loop points, seeks, looping and volume
+ * can be changed from the GUI at any time and are passed on through atomics
+ * that the callback reads once per buffer, so it never waits for a lock.
+ * All positions in the public interface are frames of the original audio.
+ * When the device runs at another samplerate the audio is resampled while
+ * playing, with libsamplerate pulling the input straight from the data so
+ * that the loop seam is resampled as one continuous signal. The same
+ * resampling previews a tuning correction by playing at a variable rate, it
+ * is switched on as soon as a correction is set and stays on until the next
+ * seek so that changing the correction never interrupts playback. Instead of data
+ * in memory the audio can be streamed from the file with a DiskStream, loop
+ * and looping changes then take effect at the next seek. A crossfade can be
+ * auditioned at the loop seam without touching the data, the frames leading
+ * up to the loop end are then mixed with those before the loop start just
+ * like FileHandling::PerformCrossfade would write them. The fade follows
+ * every change at once, a disk stream keeps the frames before the loop start
+ * that the longest fade needs so it never has to restart for one. Each buffer stamps
+ * the frame it starts with and its stream time so that the GUI can work out
+ * what is heard between the callbacks. While the output tap is on every
+ * buffer is also copied into an AudioRing for the GUI to read the exact
+ * output from, without the callback ever waiting for it.
+ */
+class PlaybackEngine {
+public:
+  PlaybackEngine();
+  ~PlaybackEngine();
+
+  // Only to be called when the stream isn't running, false if the audio
+  // can't be played (GetLastError() tells why)
+  bool SetAudioData(const float *data, unsigned long frames, unsigned channels, double ratio = 1.0);
+  bool SetStreamedAudio(wxString filePath, unsigned long frames, unsigned channels, unsigned sampleRate, double ratio = 1.0);
+  void ReleaseAudio();
+  void SetOutputChannels(unsigned channels);
+
+  // These can be called from the GUI thread while playing
+  void SetLoop(unsigned loopStart, unsigned loopEnd);
+  void SetLooping(bool looping);
+  void Seek(unsigned position);
+  void SetGain(float gain);
+  // fadeFrames of 0 turns the crossfade audition off
+  void SetCrossfade(unsigned fadeFrames, int fadeType);
+  // Plays the audio this many cents higher (or lower) by resampling
+  void SetPitchCorrection(double cents);
+  unsigned GetPlayPosition();
+  // The frame heard at streamTime, extrapolated from the last buffer
+  unsigned GetPlayPositionAt(double streamTime, unsigned sampleRate);
+  bool HasReachedEnd();
+  // Buffers the device reported as underflowed since the audio was set
+  unsigned GetXrunCount();
+  unsigned GetOutputChannels();
+  // Samplerate of the output relative to the audio
+  double GetResampleRatio();
+  wxString GetLastError();
+
+  // The output tap, only one reader at a time
+  void SetOutputTap(bool enabled);
+  unsigned long ReadOutput(float *dest, unsigned long maxFrames);
+
+  static int AudioCallback(void *outputBuffer, void *inputBuffer, unsigned int nBufferFrames,
+                    double streamTime, RtAudioStreamStatus status, void *userData);
+
+private:
+  const float *m_data;
+  unsigned long m_frames;
+  unsigned m_channels;
+  unsigned m_outputChannels;
+  double m_ratio;
+  DiskStream *m_stream;
+  SRC_STATE *m_resampler;
+  std::vector<float> m_resampled;
+  std::vector<float> m_crossfaded;
+  wxString m_lastError;
+
+  // loop start in the high and loop end in the low 32 bits so they change together
+  std::atomic<unsigned long long> m_loop;
+  std::atomic<bool> m_looping;
+  std::atomic<float> m_gain;
+  // fade length in the high and fade type in the low 32 bits
+  std::atomic<unsigned long long> m_crossfade;
+  std::atomic<double> m_pitchFactor;
+  std::atomic<long long> m_seek; // -1 when no seek is pending
+  std::atomic<unsigned long> m_playPosition;
+  std::atomic<bool> m_reachedEnd;
+  std::atomic<unsigned> m_xruns;
+  // frame at the start of the last buffer and its stream time, the
+  // sequence is odd while they're written so that they're read as a pair
+  std::atomic<unsigned> m_stampSequence;
+  std::atomic<unsigned long> m_stampFrame;
+  std::atomic<double> m_stampTime;
+  std::atomic<bool> m_tapEnabled;
+  AudioRing m_tap;
+
+  // only touched by the audio callback while the stream runs
+  unsigned long m_frame; // next frame to play, or to give the resampler
+  bool m_resampling;
+  double m_resampledPosition; // frame heard when resampling
+  unsigned long m_loopStart;
+  unsigned long m_loopEnd;
+  bool m_loopingNow;
+  unsigned long m_fadeFrames; // 0 when no crossfade is auditioned
+  int m_fadeType;
+  unsigned long m_pendingConsume; // frames handed out from the disk stream
+  unsigned long m_maxStreamLead; // frames of the longest fade at the file samplerate
+  unsigned long m_streamLead; // frames before the loop start the disk stream keeps
+  bool m_underrun;
+
+  bool PrepareAudio(unsigned long frames, unsigned channels, double ratio);
+  void LatchLoop();
+  void LatchCrossfade();
+  void RestartStream();
+  void Render(float *buffer, unsigned nFrames, double streamTime);
+  unsigned RenderDirect(float *buffer, unsigned nFrames, unsigned useChannels, float gain);
+  unsigned RenderResampled(float *buffer, unsigned nFrames, unsigned useChannels, float gain, double ratio);
+  unsigned long NextSpan(unsigned long maxFrames);
+  const float* NextSourceBlock(unsigned long maxFrames, unsigned long &frames);
+  const float* CrossfadeBlock(const float *block, unsigned long frames);
+  static long ResamplerInput(void *userData, float **data);
+
+};
+
+#endif
@@ -0,0 +1,273 @@
+/*
+ * SeamMetrics.cpp is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#include "SeamMetrics.h"
+#include "FFT.h"
+#include <wx/thread.h>
+#include <algorithm>
+#include <cmath>
+
+// Bins more than this far below the strongest bin don't count in the spectral difference
+#define SEAM_METRICS_SPECTRUM_RANGE 60.0
+
+/*
+ * The kernels are plain loops over contiguous arrays without branches so the
+ * compiler vectorizes them in the optimized build (-O3 -ffast-math)
+ */
+static double DotProduct(const double *a, const double *b, unsigned n) {
+  double sum = 0;
+  for (unsigned i = 0; i < n; i++)
+    sum += a[i] * b[i];
+  return sum;
+}
+
+static void ApplyWindow(const double *data, const double *window, float *out, unsigned n) {
+  for (unsigned i = 0; i < n; i++)
+    out[i] = (float) (data[i] * window[i]);
+}
+
+static void PowerToDecibels(float *power, unsigned n) {
+  for (unsigned i = 0; i < n; i++)
+    power[i] = 10.0f * log10f(power[i] + 1e-20f);
+}
+
+void CalculateSeamMetrics(
+  FileHandling *audioFile,
+  unsigned channel,
+  unsigned long loopStart,
+  unsigned long loopEnd,
+  SEAM_METRICS &metrics
+) {
+  const unsigned half = SEAM_METRICS_WINDOW / 2;
+  double endWindow[SEAM_METRICS_WINDOW];
+  double startWindow[SEAM_METRICS_WINDOW];
+
+  // endWindow[half - 1] is the loop end and startWindow[half - 1] the frame before the loop start
+  audioFile->GetChannelWindow(channel, (long) loopEnd - (long) half + 1, SEAM_METRICS_WINDOW, endWindow);
+  audioFile->GetChannelWindow(channel, (long) loopStart - (long) half, SEAM_METRICS_WINDOW, startWindow);
+
+  metrics.sampleJump = fabs(endWindow[half - 1] - startWindow[half - 1]);
+  metrics.slopeJump = fabs((endWindow[half - 1] - endWindow[half - 2]) - (startWindow[half - 1] - startWindow[half - 2]));
+
+  double endEnergy = DotProduct(endWindow, endWindow, SEAM_METRICS_WINDOW);
+  double startEnergy = DotProduct(startWindow, startWindow, SEAM_METRICS_WINDOW);
+  if (endEnergy > 0 && startEnergy > 0)
+    metrics.correlation = DotProduct(endWindow, startWindow, SEAM_METRICS_WINDOW) / sqrt(endEnergy * startEnergy);
+  else
+    metrics.correlation = 0;
+
+  // Hann windowed power spectra of both windows compared in dB
+  const double *window = GetWindow(3, SEAM_METRICS_WINDOW);
+  float input[SEAM_METRICS_WINDOW];
+  float endSpectrum[SEAM_METRICS_WINDOW];
+  float startSpectrum[SEAM_METRICS_WINDOW];
+  ApplyWindow(endWindow, window, input, SEAM_METRICS_WINDOW);
+  PowerSpectrum(SEAM_METRICS_WINDOW, input, endSpectrum);
+  ApplyWindow(startWindow, window, input, SEAM_METRICS_WINDOW);
+  PowerSpectrum(SEAM_METRICS_WINDOW, input, startSpectrum);
+  PowerToDecibels(endSpectrum, half);
+  PowerToDecibels(startSpectrum, half);
+
+  float strongest = -200.0f;
+  for (unsigned i = 1; i < half; i++)
+    strongest = std::max(strongest, std::max(endSpectrum[i], startSpectrum[i]));
+
+  double squaredDifference = 0;
+  unsigned bins = 0;
+  for (unsigned i = 1; i < half; i++) {
+    if (std::max(endSpectrum[i], startSpectrum[i]) < strongest - SEAM_METRICS_SPECTRUM_RANGE)
+      continue;
+    double difference = endSpectrum[i] - startSpectrum[i];
+    squaredDifference += difference * difference;
+    bins++;
+  }
+  if (bins > 0)
+    metrics.spectralDifference = sqrt(squaredDifference / bins);
+  else
+    metrics.spectralDifference = 0;
+}
+
+static bool CompareMatches(const SEAM_MATCH &a, const SEAM_MATCH &b) {
+  return a.error < b.error;
+}
+
+void FindBestSeamMatches(
+  FileHandling *audioFile,
+  unsigned long loopStart,
+  unsigned long loopEnd,
+  bool moveEnd,
+  unsigned radius,
+  unsigned count,
+  std::vector<SEAM_MATCH> &matches
+) {
+  matches.clear();
+  unsigned channels = audioFile->waveTracks.size();
+  if (channels == 0 || count == 0)
+    return;
+  long frames = audioFile->waveTracks[0].waveData.size();
+  if (radius > SEAM_SEARCH_MAX_RADIUS)
+    radius = SEAM_SEARCH_MAX_RADIUS;
+
+  const long half = SEAM_METRICS_WINDOW / 2;
+  long first = (long) (moveEnd ? loopEnd : loopStart) - (long) radius;
+  unsigned candidates = radius * 2 + 1;
+  unsigned bufferLength = candidates - 1 + SEAM_METRICS_WINDOW;
+
+  // the window of the point that stays and one long buffer that the window of every candidate is a part of
+  std::vector<double> fixed(channels * SEAM_METRICS_WINDOW);
+  std::vector<double> fixedEnergy(channels);
+  std::vector<double> moving(channels * bufferLength);
+  for (unsigned ch = 0; ch < channels; ch++) {
+    double *fixedWindow = &fixed[ch * SEAM_METRICS_WINDOW];
+    if (moveEnd) {
+      audioFile->GetChannelWindow(ch, (long) loopStart - half, SEAM_METRICS_WINDOW, fixedWindow);
+      audioFile->GetChannelWindow(ch, first - half + 1, bufferLength, &moving[ch * bufferLength]);
+    } else {
+      audioFile->GetChannelWindow(ch, (long) loopEnd - half + 1, SEAM_METRICS_WINDOW, fixedWindow);
+      audioFile->GetChannelWindow(ch, first - half, bufferLength, &moving[ch * bufferLength]);
+    }
+    fixedEnergy[ch] = DotProduct(fixedWindow, fixedWindow, SEAM_METRICS_WINDOW);
+  }
+
+  // the error is 1 - 2ab / (aa + bb) which is 0 for identical and 1 for uncorrelated windows
+  std::vector<double> errors(candidates, -1.0);
+  for (unsigned k = 0; k < candidates; k++) {
+    long position = first + (long) k;
+    if (position < 0 || position >= frames)
+      continue;
+    if (moveEnd ? position <= (long) loopStart : position >= (long) loopEnd)
+      continue;
+
+    double error = 0;
+    for (unsigned ch = 0; ch < channels; ch++) {
+      const double *window = &moving[ch * bufferLength + k];
+      double energy = DotProduct(window, window, SEAM_METRICS_WINDOW) + fixedEnergy[ch];
+      if (energy > 0)
+        error += 1.0 - 2.0 * DotProduct(window, &fixed[ch * SEAM_METRICS_WINDOW], SEAM_METRICS_WINDOW) / energy;
+      else
+        error += 1.0;
+    }
+    errors[k] = error / channels;
+  }
+
+  for (unsigned k = 0; k < candidates; k++) {
+    if (errors[k] < 0)
+      continue;
+    bool lowerThanPrevious = k == 0 || errors[k - 1] < 0 || errors[k] <= errors[k - 1];
+    bool lowerThanNext = k + 1 == candidates || errors[k + 1] < 0 || errors[k] < errors[k + 1];
+    if (lowerThanPrevious && lowerThanNext) {
+      SEAM_MATCH match;
+      match.position = first + k;
+      match.error = errors[k];
+      matches.push_back(match);
+    }
+  }
+
+  std::sort(matches.begin(), matches.end(), CompareMatches);
+  if (matches.size() > count)
+    matches.resize(count);
+}
+
+// Shared by the threads searching the loops of one file
+typedef struct {
+  FileHandling *audioFile;
+  std::vector<LOOPDATA> loops;
+  bool moveEnd;
+  unsigned radius;
+  std::vector<SEAM_MATCH> *bestMatches;
+  unsigned nextLoop;
+  wxMutex lock;
+} SEAM_SEARCH_JOB;
+
+/*
+ * Takes the next loop to search until all are done. Only the wave data is
+ * read so the file can be shared and each loop's result is written by the
+ * thread that searched it.
+ */
+static void SearchLoops(SEAM_SEARCH_JOB *job) {
+  while (true) {
+    unsigned loop;
+    {
+      wxMutexLocker locker(job->lock);
+      if (job->nextLoop >= job->loops.size())
+        return;
+      loop = job->nextLoop++;
+    }
+
+    std::vector<SEAM_MATCH> matches;
+    FindBestSeamMatches(job->audioFile, job->loops[loop].dwStart, job->loops[loop].dwEnd, job->moveEnd, job->radius, 1, matches);
+    if (!matches.empty())
+      (*job->bestMatches)[loop] = matches[0];
+  }
+}
+
+class SeamSearchWorker : public wxThread {
+public:
+  SeamSearchWorker(SEAM_SEARCH_JOB *job) : wxThread(wxTHREAD_JOINABLE), m_job(job) {}
+
+protected:
+  virtual ExitCode Entry() {
+    SearchLoops(m_job);
+    return (ExitCode) 0;
+  }
+
+private:
+  SEAM_SEARCH_JOB *m_job;
+};
+
+void FindBestSeamMatchesForAllLoops(
+  FileHandling *audioFile,
+  bool moveEnd,
+  unsigned radius,
+  std::vector<SEAM_MATCH> &bestMatches
+) {
+  SEAM_SEARCH_JOB job;
+  job.audioFile = audioFile;
+  job.loops.resize(audioFile->m_loops->GetNumberOfLoops());
+  job.moveEnd = moveEnd;
+  job.radius = radius;
+  job.bestMatches = &bestMatches;
+  job.nextLoop = 0;
+
+  bestMatches.resize(job.loops.size());
+  for (unsigned i = 0; i < job.loops.size(); i++) {
+    audioFile->m_loops->GetLoopData(i, job.loops[i]);
+    bestMatches[i].position = moveEnd ? job.loops[i].dwEnd : job.loops[i].dwStart;
+    bestMatches[i].error = -1;
+  }
+
+  // this thread searches too so one loop less needs a worker
+  std::vector<SeamSearchWorker*> workers;
+  int nbrWorkers = std::min(wxThread::GetCPUCount(), (int) job.loops.size()) - 1;
+  for (int i = 0; i < nbrWorkers; i++) {
+    SeamSearchWorker *worker = new SeamSearchWorker(&job);
+    if (worker->Run() == wxTHREAD_NO_ERROR)
+      workers.push_back(worker);
+    else
+      delete worker;
+  }
+
+  SearchLoops(&job);
+
+  for (unsigned i = 0; i < workers.size(); i++) {
+    workers[i]->Wait();
+    delete workers[i];
+  }
+}
@@ -0,0 +1,90 @@
+/*
+ * SeamMetrics.h is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#ifndef SEAMMETRICS_H
+#define SEAMMETRICS_H
+
+#include "FileHandling.h"
+#include <vector>
+
+// Frames compared around the seam, half of them on each side (power of two)
+#define SEAM_METRICS_WINDOW 512
+// Default and largest number of frames searched on each side of a loop point
+#define SEAM_SEARCH_RADIUS 1000
+#define SEAM_SEARCH_MAX_RADIUS 100000
+
+typedef struct {
+  double sampleJump; // difference of the loop end and the frame before the loop start
+  double slopeJump; // difference of the slopes into those two frames
+  double correlation; // normalized cross-correlation of the windows, 1 is identical
+  double spectralDifference; // RMS difference in dB of the window spectra
+} SEAM_METRICS;
+
+typedef struct {
+  unsigned long position; // the new loop start or end
+  double error; // 0 for a perfect seam, 1 for uncorrelated windows
+} SEAM_MATCH;
+
+/*
+ * Measures how well the seam of a loop in one channel matches. When the loop
+ * wraps the loop start is played right after the loop end, so in a perfect
+ * loop the audio around the loop end looks just like the audio around the
+ * frame before the loop start. The window around each of those is compared
+ * sample by sample, by correlation and by spectrum. Frames outside of the
+ * audio count as silence.
+ */
+void CalculateSeamMetrics(
+  FileHandling *audioFile,
+  unsigned channel,
+  unsigned long loopStart,
+  unsigned long loopEnd,
+  SEAM_METRICS &metrics
+);
+
+/*
+ * Searches radius frames on both sides of the loop start (or of the loop end
+ * if moveEnd is set) for the positions where the seam against the other loop
+ * point has the lowest error, averaged over all channels. Only local minima
+ * are returned so that the matches aren't just neighbours of each other, at
+ * most count of them with the best first.
+ */
+void FindBestSeamMatches(
+  FileHandling *audioFile,
+  unsigned long loopStart,
+  unsigned long loopEnd,
+  bool moveEnd,
+  unsigned radius,
+  unsigned count,
+  std::vector<SEAM_MATCH> &matches
+);
+
+/*
+ * The best match for every loop of the file, each loop is searched on its own
+ * worker thread (as many at a time as there are CPUs). A loop without any
+ * valid position keeps its own with an error of -1.
+ */
+void FindBestSeamMatchesForAllLoops(
+  FileHandling *audioFile,
+  bool moveEnd,
+  unsigned radius,
+  std::vector<SEAM_MATCH> &bestMatches
+);
+
+#endif
@@ -0,0 +1,236 @@
+/*
+ * SpectrogramDialog.cpp is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#include "SpectrogramDialog.h"
+#include <wx/statline.h>
+
+IMPLEMENT_CLASS(SpectrogramDialog, wxDialog)
+
+BEGIN_EVENT_TABLE(SpectrogramDialog, wxDialog)
+  EVT_BUTTON(ID_SPECTROGRAM_ZOOM_ALL_BTN, SpectrogramDialog::OnZoomAllButton)
+  EVT_BUTTON(ID_SPECTROGRAM_ZOOM_OUT_BTN, SpectrogramDialog::OnZoomOutButton)
+  EVT_BUTTON(ID_SPECTROGRAM_ZOOM_IN_BTN, SpectrogramDialog::OnZoomInButton)
+  EVT_CHOICE(ID_SPECTROGRAM_FFTSIZE_CHOICE, SpectrogramDialog::OnFftSizeChoice)
+  EVT_COMMAND_SCROLL(ID_SPECTROGRAM_SCROLLBAR, SpectrogramDialog::OnScroll)
+END_EVENT_TABLE()
+
+SpectrogramDialog::SpectrogramDialog(FileHandling *audioFile, int windowType) {
+  Init(audioFile, windowType);
+}
+
+SpectrogramDialog::SpectrogramDialog(
+  FileHandling *audioFile,
+  int windowType,
+  wxWindow* parent,
+  wxWindowID id,
+  const wxString& title,
+  const wxPoint& pos,
+  const wxSize& size,
+  long style) {
+  Init(audioFile, windowType);
+  Create(parent, id, title, pos, size, style);
+}
+
+SpectrogramDialog::~SpectrogramDialog() {
+
+}
+
+void SpectrogramDialog::Init(FileHandling *audioFile, int windowType) {
+  m_audioFile = audioFile;
+  m_windowType = windowType;
+  m_drawingPanel = NULL;
+  m_scrollBar = NULL;
+  m_zoomAllBtn = NULL;
+  m_zoomInBtn = NULL;
+  m_zoomOutBtn = NULL;
+
+  m_fftSizes.Add(wxT("256")); // pow(2, 8 + choice number)
+  m_fftSizes.Add(wxT("512"));
+  m_fftSizes.Add(wxT("1024"));
+  m_fftSizes.Add(wxT("2048"));
+  m_fftSizes.Add(wxT("4096"));
+  m_fftSizes.Add(wxT("8192"));
+  m_fftSizes.Add(wxT("16384"));
+}
+
+bool SpectrogramDialog::Create(
+  wxWindow* parent,
+  wxWindowID id,
+  const wxString& caption,
+  const wxPoint& pos,
+  const wxSize& size,
+  long style) {
+  if (!wxDialog::Create(parent, id, caption, pos, size, style))
+    return false;
+
+  CreateControls();
+  SetTitle(wxT("Spectrogram for ") + m_audioFile->GetFileName());
+
+  GetSizer()->Fit(this);
+  GetSizer()->SetSizeHints(this);
+  Centre();
+
+  ViewHasChanged();
+
+  return true;
+}
+
+void SpectrogramDialog::CreateControls() {
+  // Create a top level sizer
+  wxBoxSizer *topSizer = new wxBoxSizer(wxVERTICAL);
+
+  // The drawing panel that show the spectrogram
+  m_drawingPanel = new SpectrogramPanel(m_audioFile, 2048, m_windowType, this);
+  topSizer->Add(m_drawingPanel, 1, wxEXPAND);
+
+  // Scrollbar for moving in time when zoomed in
+  m_scrollBar = new wxScrollBar(
+    this,
+    ID_SPECTROGRAM_SCROLLBAR
+  );
+  topSizer->Add(m_scrollBar, 0, wxEXPAND|wxLEFT|wxRIGHT, 5);
+
+  // Sizer for the zoom button row
+  wxBoxSizer *zoomRow = new wxBoxSizer(wxHORIZONTAL);
+
+  // The zoom all button
+  m_zoomAllBtn = new wxButton(
+    this,
+    ID_SPECTROGRAM_ZOOM_ALL_BTN,
+    wxT("All"),
+    wxDefaultPosition,
+    wxDefaultSize,
+    0
+  );
+  zoomRow->Add(m_zoomAllBtn, 0, wxALIGN_CENTER|wxALL, 5);
+
+  // The zoom out button
+  m_zoomOutBtn = new wxButton(
+    this,
+    ID_SPECTROGRAM_ZOOM_OUT_BTN,
+    wxT("Out"),
+    wxDefaultPosition,
+    wxDefaultSize,
+    0
+  );
+  zoomRow->Add(m_zoomOutBtn, 0, wxALIGN_CENTER|wxALL, 5);
+
+  // The zoom in button
+  m_zoomInBtn = new wxButton(
+    this,
+    ID_SPECTROGRAM_ZOOM_IN_BTN,
+    wxT("In"),
+    wxDefaultPosition,
+    wxDefaultSize,
+    0
+  );
+  zoomRow->Add(m_zoomInBtn, 0, wxALIGN_CENTER|wxALL, 5);
+
+  zoomRow->AddStretchSpacer();
+
+  wxStaticText *fftSizeLabel = new wxStaticText(
+    this,
+    wxID_STATIC,
+    wxT("FFT size:")
+  );
+  zoomRow->Add(fftSizeLabel, 0, wxALIGN_CENTER_VERTICAL|wxALL, 5);
+
+  // FFT size choice
+  wxChoice *fftSizeChoice = new wxChoice(
+    this,
+    ID_SPECTROGRAM_FFTSIZE_CHOICE,
+    wxDefaultPosition,
+    wxDefaultSize,
+    m_fftSizes
+  );
+  zoomRow->Add(fftSizeChoice, 0, wxALIGN_CENTER_VERTICAL|wxALL, 5);
+  fftSizeChoice->SetSelection(3);
+
+  topSizer->Add(zoomRow, 0, wxEXPAND);
+
+  wxStaticLine *bottomDivider = new wxStaticLine(this);
+  topSizer->Add(bottomDivider, 0, wxEXPAND);
+
+  wxBoxSizer *lastRow = new wxBoxSizer(wxHORIZONTAL);
+  lastRow->AddStretchSpacer();
+  wxButton *closeButton = new wxButton(
+    this,
+    wxID_CANCEL,
+    wxT("Close")
+  );
+  lastRow->Add(closeButton, 0, wxALIGN_CENTER_VERTICAL|wxALL, 5);
+
+  topSizer->Add(lastRow, 0, wxGROW);
+
+  SetSizer(topSizer);
+}
+
+void SpectrogramDialog::ViewHasChanged() {
+  // the panel can get size events before all controls are created
+  if (!m_drawingPanel || !m_scrollBar || !m_zoomOutBtn || !m_zoomInBtn)
+    return;
+
+  int range = m_drawingPanel->GetScrollRange();
+  int thumb = m_drawingPanel->GetScrollThumb();
+  m_scrollBar->SetScrollbar(m_drawingPanel->GetScrollPosition(), thumb, range, thumb);
+  if (range > thumb)
+    m_scrollBar->Enable();
+  else
+    m_scrollBar->Disable();
+
+  DecideZoomButtonState();
+}
+
+void SpectrogramDialog::DecideZoomButtonState() {
+  if (m_drawingPanel->CanZoomOut()) {
+    m_zoomAllBtn->Enable();
+    m_zoomOutBtn->Enable();
+  } else {
+    m_zoomAllBtn->Disable();
+    m_zoomOutBtn->Disable();
+  }
+  if (m_drawingPanel->CanZoomIn())
+    m_zoomInBtn->Enable();
+  else
+    m_zoomInBtn->Disable();
+}
+
+void SpectrogramDialog::OnZoomAllButton(wxCommandEvent& WXUNUSED(event)) {
+  m_drawingPanel->DoZoomAll();
+  ViewHasChanged();
+}
+
+void SpectrogramDialog::OnZoomInButton(wxCommandEvent& WXUNUSED(event)) {
+  m_drawingPanel->DoZoomIn();
+  ViewHasChanged();
+}
+
+void SpectrogramDialog::OnZoomOutButton(wxCommandEvent& WXUNUSED(event)) {
+  m_drawingPanel->DoZoomOut();
+  ViewHasChanged();
+}
+
+void SpectrogramDialog::OnFftSizeChoice(wxCommandEvent& event) {
+  m_drawingPanel->SetFftSize(lround(pow(2, 8 + event.GetSelection())));
+}
+
+void SpectrogramDialog::OnScroll(wxScrollEvent& event) {
+  m_drawingPanel->SetScrollPosition(event.GetPosition());
+}
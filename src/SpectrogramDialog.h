@@ -0,0 +1,96 @@
+/*
+ * SpectrogramDialog.h is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#ifndef SPECTROGRAMDIALOG_H
+#define SPECTROGRAMDIALOG_H
+
+#include <wx/wx.h>
+#include "FileHandling.h"
+#include "SpectrogramPanel.h"
+
+// Identifiers
+enum {
+  ID_SPECTROGRAM_ZOOM_ALL_BTN = wxID_HIGHEST + 420,
+  ID_SPECTROGRAM_ZOOM_IN_BTN = wxID_HIGHEST + 421,
+  ID_SPECTROGRAM_ZOOM_OUT_BTN = wxID_HIGHEST + 422,
+  ID_SPECTROGRAM_SCROLLBAR = wxID_HIGHEST + 423,
+  ID_SPECTROGRAM_FFTSIZE_CHOICE = wxID_HIGHEST + 424,
+  ID_SPECTROGRAM_TILE_READY = wxID_HIGHEST + 425,
+};
+
+class SpectrogramDialog : public wxDialog {
+  DECLARE_CLASS(SpectrogramDialog)
+  DECLARE_EVENT_TABLE()
+
+public:
+  // Constructors
+  SpectrogramDialog(FileHandling *audioFile, int windowType);
+  SpectrogramDialog(
+    FileHandling *audioFile,
+    int windowType,
+    wxWindow* parent,
+    wxWindowID id = wxID_ANY,
+    const wxString& title = wxT("Spectrogram"),
+    const wxPoint& pos = wxDefaultPosition,
+    const wxSize& size = wxDefaultSize,
+    long style = wxDEFAULT_DIALOG_STYLE|wxRESIZE_BORDER|wxCLIP_CHILDREN|wxFULL_REPAINT_ON_RESIZE
+  );
+
+  ~SpectrogramDialog();
+
+  // Initialize our variables
+  void Init(FileHandling *audioFile, int windowType);
+
+  // Creation
+  bool Create(
+    wxWindow* parent,
+    wxWindowID id = wxID_ANY,
+    const wxString& caption = wxT("Spectrogram"),
+    const wxPoint& pos = wxDefaultPosition,
+    const wxSize& size = wxDefaultSize,
+    long style = wxDEFAULT_DIALOG_STYLE|wxRESIZE_BORDER|wxCLIP_CHILDREN|wxFULL_REPAINT_ON_RESIZE
+  );
+
+  // Creates the controls and sizers
+  void CreateControls();
+
+  // Called by the panel when zoom or size has changed
+  void ViewHasChanged();
+
+private:
+  FileHandling *m_audioFile;
+  int m_windowType;
+  wxArrayString m_fftSizes;
+  SpectrogramPanel *m_drawingPanel;
+  wxScrollBar *m_scrollBar;
+  wxButton *m_zoomAllBtn;
+  wxButton *m_zoomInBtn;
+  wxButton *m_zoomOutBtn;
+
+  void DecideZoomButtonState();
+  void OnZoomAllButton(wxCommandEvent& event);
+  void OnZoomInButton(wxCommandEvent& event);
+  void OnZoomOutButton(wxCommandEvent& event);
+  void OnFftSizeChoice(wxCommandEvent& event);
+  void OnScroll(wxScrollEvent& event);
+
+};
+
+#endif
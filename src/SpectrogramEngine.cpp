@@ -0,0 +1,319 @@
+/*
+ * SpectrogramEngine.cpp is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#include "SpectrogramEngine.h"
+#include "FFT.h"
+#include <cmath>
+
+// Memory that the tile cache may use before the least recently used tiles are dropped
+#define SPECTROGRAM_CACHE_BYTES (128 * 1024 * 1024)
+
+class SpectrogramWorker : public wxThread {
+public:
+  SpectrogramWorker(SpectrogramEngine *engine) : wxThread(wxTHREAD_JOINABLE), m_engine(engine) {}
+
+protected:
+  virtual ExitCode Entry() {
+    m_engine->WorkerLoop();
+    return (ExitCode) 0;
+  }
+
+private:
+  SpectrogramEngine *m_engine;
+};
+
+SpectrogramEngine::SpectrogramEngine(FileHandling *audioFile, unsigned fftSize, int windowType, wxEvtHandler *listener, int eventId) : m_fftSize(fftSize), m_sampleRate(audioFile->GetSampleRate()), m_levels(1), m_windowScale(1.0), m_listener(listener), m_eventId(eventId), m_useCounter(0), m_maxTiles(0), m_hasWork(m_lock), m_working(0), m_stop(false) {
+  // the workers get their own copy of the audio so the file can't change under them
+  unsigned length = 0;
+  if (!audioFile->waveTracks.empty())
+    length = audioFile->waveTracks[0].waveData.size();
+  m_audio.assign(length, 0.0f);
+  if (!audioFile->waveTracks.empty()) {
+    double channelScale = 1.0 / (double) audioFile->waveTracks.size();
+    for (unsigned i = 0; i < audioFile->waveTracks.size(); i++) {
+      const double *data = &audioFile->waveTracks[i].waveData[0];
+      for (unsigned j = 0; j < length; j++)
+        m_audio[j] += (float) (data[j] * channelScale);
+    }
+  }
+
+  const double *window = GetWindow(windowType, m_fftSize);
+  m_window.assign(window, window + m_fftSize);
+  double winSum = 0;
+  for (unsigned i = 0; i < m_fftSize; i++)
+    winSum += m_window[i];
+  if (winSum > 0)
+    m_windowScale = 4.0 / (winSum * winSum);
+
+  // add levels until the whole file fits in a single tile
+  while (GetNumberOfFrames(m_levels - 1) > SPECTROGRAM_TILE_FRAMES && m_levels < 24)
+    m_levels++;
+
+  size_t tileBytes = (size_t) SPECTROGRAM_TILE_FRAMES * GetNumberOfBins() * sizeof(float);
+  m_maxTiles = SPECTROGRAM_CACHE_BYTES / tileBytes;
+  if (m_maxTiles < 64)
+    m_maxTiles = 64;
+
+  int nbrWorkers = wxThread::GetCPUCount();
+  if (nbrWorkers < 1)
+    nbrWorkers = 1;
+  for (int i = 0; i < nbrWorkers; i++) {
+    SpectrogramWorker *worker = new SpectrogramWorker(this);
+    if (worker->Run() == wxTHREAD_NO_ERROR)
+      m_workers.push_back(worker);
+    else
+      delete worker;
+  }
+}
+
+SpectrogramEngine::~SpectrogramEngine() {
+  {
+    wxMutexLocker locker(m_lock);
+    m_stop = true;
+    m_queue.clear();
+    m_hasWork.Broadcast();
+  }
+  for (unsigned i = 0; i < m_workers.size(); i++) {
+    m_workers[i]->Wait();
+    delete m_workers[i];
+  }
+  m_workers.clear();
+
+  for (unsigned i = 0; i < m_finished.size(); i++)
+    delete m_finished[i].second;
+  m_finished.clear();
+
+  for (std::map<wxUint64, SPECTROGRAM_TILE*>::iterator it = m_tiles.begin(); it != m_tiles.end(); ++it)
+    delete it->second;
+  m_tiles.clear();
+}
+
+unsigned SpectrogramEngine::GetFftSize() {
+  return m_fftSize;
+}
+
+unsigned SpectrogramEngine::GetNumberOfBins() {
+  return m_fftSize / 2;
+}
+
+unsigned SpectrogramEngine::GetSampleRate() {
+  return m_sampleRate;
+}
+
+unsigned SpectrogramEngine::GetLength() {
+  return m_audio.size();
+}
+
+unsigned SpectrogramEngine::GetNumberOfLevels() {
+  return m_levels;
+}
+
+unsigned SpectrogramEngine::GetHopSize(unsigned level) {
+  return (m_fftSize / 4) << level;
+}
+
+unsigned SpectrogramEngine::GetNumberOfFrames(unsigned level) {
+  unsigned hop = GetHopSize(level);
+  return (m_audio.size() + hop - 1) / hop;
+}
+
+unsigned SpectrogramEngine::GetLevelForSamplesPerPixel(double samplesPerPixel) {
+  unsigned level = 0;
+  while (level + 1 < m_levels && (double) GetHopSize(level + 1) <= samplesPerPixel)
+    level++;
+  return level;
+}
+
+const float *SpectrogramEngine::GetFrame(unsigned level, unsigned frame) {
+  if (level >= m_levels || frame >= GetNumberOfFrames(level))
+    return NULL;
+
+  std::map<wxUint64, SPECTROGRAM_TILE*>::iterator it = m_tiles.find(TileKey(level, frame / SPECTROGRAM_TILE_FRAMES));
+  if (it == m_tiles.end())
+    return NULL;
+
+  it->second->lastUsed = ++m_useCounter;
+  return &it->second->dB[(frame % SPECTROGRAM_TILE_FRAMES) * GetNumberOfBins()];
+}
+
+void SpectrogramEngine::ClearRequests() {
+  wxMutexLocker locker(m_lock);
+  for (unsigned i = 0; i < m_queue.size(); i++)
+    m_requested.erase(m_queue[i]);
+  m_queue.clear();
+}
+
+void SpectrogramEngine::RequestFrame(unsigned level, unsigned frame) {
+  if (level >= m_levels || frame >= GetNumberOfFrames(level))
+    return;
+
+  wxUint64 key = TileKey(level, frame / SPECTROGRAM_TILE_FRAMES);
+  if (m_tiles.find(key) != m_tiles.end() || m_requested.find(key) != m_requested.end())
+    return;
+
+  m_requested.insert(key);
+  wxMutexLocker locker(m_lock);
+  m_queue.push_back(key);
+  m_hasWork.Signal();
+}
+
+bool SpectrogramEngine::CollectFinishedTiles() {
+  std::vector<std::pair<wxUint64, SPECTROGRAM_TILE*> > finished;
+  {
+    wxMutexLocker locker(m_lock);
+    finished.swap(m_finished);
+  }
+  if (finished.empty())
+    return false;
+
+  for (unsigned i = 0; i < finished.size(); i++) {
+    m_requested.erase(finished[i].first);
+    finished[i].second->lastUsed = ++m_useCounter;
+    m_tiles[finished[i].first] = finished[i].second;
+  }
+  EvictOldTiles();
+  return true;
+}
+
+bool SpectrogramEngine::IsBusy() {
+  wxMutexLocker locker(m_lock);
+  if (!m_queue.empty() || m_working > 0)
+    return true;
+  else
+    return false;
+}
+
+void SpectrogramEngine::WorkerLoop() {
+  while (true) {
+    wxUint64 key;
+    {
+      wxMutexLocker locker(m_lock);
+      while (m_queue.empty() && !m_stop)
+        m_hasWork.Wait();
+      if (m_stop)
+        return;
+      key = m_queue.front();
+      m_queue.pop_front();
+      m_working++;
+    }
+
+    SPECTROGRAM_TILE *tile = new SPECTROGRAM_TILE;
+    CalculateTile(key, tile);
+
+    {
+      wxMutexLocker locker(m_lock);
+      m_working--;
+      if (m_stop) {
+        delete tile;
+        return;
+      }
+      m_finished.push_back(std::make_pair(key, tile));
+    }
+    wxQueueEvent(m_listener, new wxThreadEvent(wxEVT_THREAD, m_eventId));
+  }
+}
+
+wxUint64 SpectrogramEngine::TileKey(unsigned level, unsigned tile) {
+  return ((wxUint64) level << 32) | tile;
+}
+
+void SpectrogramEngine::CalculateTile(wxUint64 key, SPECTROGRAM_TILE *tile) {
+  unsigned level = (unsigned) (key >> 32);
+  unsigned firstFrame = (unsigned) (key & 0xFFFFFFFF) * SPECTROGRAM_TILE_FRAMES;
+  unsigned hop = GetHopSize(level);
+  unsigned bins = GetNumberOfBins();
+  long length = m_audio.size();
+  bool singlePrecision = m_fftSize <= MaxFloatFFTSize;
+
+  tile->dB.assign((size_t) SPECTROGRAM_TILE_FRAMES * bins, -145.0f);
+  tile->lastUsed = 0;
+
+  float *inputF = NULL;
+  float *outputF = NULL;
+  double *inputD = NULL;
+  double *outputD = NULL;
+  if (singlePrecision) {
+    inputF = new float[m_fftSize];
+    outputF = new float[m_fftSize];
+  } else {
+    inputD = new double[m_fftSize];
+    outputD = new double[m_fftSize];
+  }
+
+  for (unsigned f = 0; f < SPECTROGRAM_TILE_FRAMES; f++) {
+    unsigned frame = firstFrame + f;
+    if (frame >= GetNumberOfFrames(level))
+      break;
+
+    // frames are centered on their position, outside of the file is silence
+    long start = (long) frame * hop - (long) (m_fftSize / 2);
+    for (unsigned j = 0; j < m_fftSize; j++) {
+      long idx = start + j;
+      double value = 0;
+      if (idx >= 0 && idx < length)
+        value = m_window[j] * m_audio[idx];
+      if (singlePrecision)
+        inputF[j] = (float) value;
+      else
+        inputD[j] = value;
+    }
+
+    float *out = &tile->dB[(size_t) f * bins];
+    if (singlePrecision) {
+      PowerSpectrum(m_fftSize, inputF, outputF);
+      for (unsigned j = 0; j < bins; j++) {
+        double temp = 10 * log10(outputF[j] * m_windowScale);
+        if (temp > -145)
+          out[j] = (float) temp;
+      }
+    } else {
+      PowerSpectrum(m_fftSize, inputD, outputD);
+      for (unsigned j = 0; j < bins; j++) {
+        double temp = 10 * log10(outputD[j] * m_windowScale);
+        if (temp > -145)
+          out[j] = (float) temp;
+      }
+    }
+
+    // don't keep going if the view is closing
+    if (f % 8 == 7) {
+      wxMutexLocker locker(m_lock);
+      if (m_stop)
+        break;
+    }
+  }
+
+  delete[] inputF;
+  delete[] outputF;
+  delete[] inputD;
+  delete[] outputD;
+}
+
+void SpectrogramEngine::EvictOldTiles() {
+  while (m_tiles.size() > m_maxTiles) {
+    std::map<wxUint64, SPECTROGRAM_TILE*>::iterator oldest = m_tiles.begin();
+    for (std::map<wxUint64, SPECTROGRAM_TILE*>::iterator it = m_tiles.begin(); it != m_tiles.end(); ++it) {
+      if (it->second->lastUsed < oldest->second->lastUsed)
+        oldest = it;
+    }
+    delete oldest->second;
+    m_tiles.erase(oldest);
+  }
+}
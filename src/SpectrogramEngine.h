@@ -0,0 +1,114 @@
+/*
+ * SpectrogramEngine.h is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#ifndef SPECTROGRAMENGINE_H
+#define SPECTROGRAMENGINE_H
+
+#include <wx/wx.h>
+#include <wx/thread.h>
+#include <vector>
+#include <deque>
+#include <map>
+#include <set>
+#include "FileHandling.h"
+
+// Number of STFT frames stored in each tile
+#define SPECTROGRAM_TILE_FRAMES 64
+
+typedef struct {
+  std::vector<float> dB; // SPECTROGRAM_TILE_FRAMES frames of (fftSize / 2) bins each
+  unsigned long lastUsed;
+} SPECTROGRAM_TILE;
+
+class SpectrogramWorker;
+
+/*
+ * SpectrogramEngine calculates STFT frames of an audio file on worker threads
+ * and keeps them in tiles of SPECTROGRAM_TILE_FRAMES frames. Level 0 uses a
+ * hop of fftSize / 4 and every following level doubles the hop, so a zoomed
+ * out view only needs a fraction of the frames. Calculated tiles are kept
+ * (up to a memory limit) so zooming and scrolling don't recalculate anything
+ * already seen.
+ *
+ * All public functions must be called from the GUI thread. The listener gets
+ * a wxThreadEvent with the id given in the constructor every time a tile is
+ * ready, it should then call CollectFinishedTiles() and refresh.
+ */
+class SpectrogramEngine {
+public:
+  SpectrogramEngine(FileHandling *audioFile, unsigned fftSize, int windowType, wxEvtHandler *listener, int eventId);
+  ~SpectrogramEngine();
+
+  unsigned GetFftSize();
+  unsigned GetNumberOfBins();
+  unsigned GetSampleRate();
+  unsigned GetLength();
+  unsigned GetNumberOfLevels();
+  unsigned GetHopSize(unsigned level);
+  unsigned GetNumberOfFrames(unsigned level);
+  // Coarsest level that still has at least one frame per pixel
+  unsigned GetLevelForSamplesPerPixel(double samplesPerPixel);
+
+  // Returns the frame in dB or NULL if it's not calculated yet
+  const float *GetFrame(unsigned level, unsigned frame);
+  // Pending requests for a previous view are dropped so the current view gets calculated first
+  void ClearRequests();
+  // Queue the tile containing the frame unless it's already available or queued
+  void RequestFrame(unsigned level, unsigned frame);
+  // Move tiles finished by the workers into the cache, returns true if any were added
+  bool CollectFinishedTiles();
+  bool IsBusy();
+
+  // Called by the worker threads only
+  void WorkerLoop();
+
+private:
+  std::vector<float> m_audio; // mono mix of all channels
+  unsigned m_fftSize;
+  unsigned m_sampleRate;
+  unsigned m_levels;
+  std::vector<double> m_window;
+  double m_windowScale;
+  wxEvtHandler *m_listener;
+  int m_eventId;
+
+  // only used from the GUI thread
+  std::map<wxUint64, SPECTROGRAM_TILE*> m_tiles;
+  std::set<wxUint64> m_requested;
+  unsigned long m_useCounter;
+  size_t m_maxTiles;
+
+  // shared with the workers, protected by m_lock
+  wxMutex m_lock;
+  wxCondition m_hasWork;
+  std::deque<wxUint64> m_queue;
+  std::vector<std::pair<wxUint64, SPECTROGRAM_TILE*> > m_finished;
+  unsigned m_working;
+  bool m_stop;
+
+  std::vector<SpectrogramWorker*> m_workers;
+
+  static wxUint64 TileKey(unsigned level, unsigned tile);
+  void CalculateTile(wxUint64 key, SPECTROGRAM_TILE *tile);
+  void EvictOldTiles();
+
+};
+
+#endif
@@ -0,0 +1,340 @@
+/*
+ * SpectrogramPanel.cpp is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#include "SpectrogramPanel.h"
+#include "SpectrogramDialog.h"
+#include <wx/dcbuffer.h>
+#include <cmath>
+
+// Event table
+BEGIN_EVENT_TABLE(SpectrogramPanel, wxPanel)
+  EVT_PAINT(SpectrogramPanel::OnPaintEvent)
+  EVT_THREAD(ID_SPECTROGRAM_TILE_READY, SpectrogramPanel::OnTileReady)
+  EVT_SIZE(SpectrogramPanel::OnPanelSize)
+END_EVENT_TABLE()
+
+SpectrogramPanel::SpectrogramPanel(
+  FileHandling *audioFile,
+  unsigned fftSize,
+  int windowType,
+  wxWindow *parent) : wxPanel(parent, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxFULL_REPAINT_ON_RESIZE) {
+  m_audioFile = audioFile;
+  m_windowType = windowType;
+  m_startSample = 0;
+  m_samplesPerPixel = 1;
+  m_zoomedAll = true;
+  m_engine = new SpectrogramEngine(m_audioFile, fftSize, m_windowType, this, ID_SPECTROGRAM_TILE_READY);
+
+  CreatePalette();
+  // everything is painted for each tile that is ready so avoid flicker
+  SetBackgroundStyle(wxBG_STYLE_PAINT);
+  SetBackgroundColour(wxColour(244,242,239));
+  SetMinSize(wxSize(800, 480));
+  UpdateLayout();
+}
+
+SpectrogramPanel::~SpectrogramPanel() {
+  // stops and waits for the workers
+  delete m_engine;
+}
+
+void SpectrogramPanel::SetFftSize(unsigned fftSize) {
+  if (fftSize == m_engine->GetFftSize())
+    return;
+
+  delete m_engine;
+  m_engine = new SpectrogramEngine(m_audioFile, fftSize, m_windowType, this, ID_SPECTROGRAM_TILE_READY);
+  Refresh();
+}
+
+void SpectrogramPanel::DoZoomIn() {
+  if (!CanZoomIn())
+    return;
+
+  double midSample = m_startSample + m_samplesPerPixel * m_spectrogramArea.GetWidth() / 2.0;
+  m_samplesPerPixel /= 2.0;
+  if (m_samplesPerPixel < 1)
+    m_samplesPerPixel = 1;
+  m_zoomedAll = false;
+  m_startSample = midSample - m_samplesPerPixel * m_spectrogramArea.GetWidth() / 2.0;
+  ClampStartSample();
+  Refresh();
+}
+
+void SpectrogramPanel::DoZoomOut() {
+  if (!CanZoomOut())
+    return;
+
+  double midSample = m_startSample + m_samplesPerPixel * m_spectrogramArea.GetWidth() / 2.0;
+  m_samplesPerPixel *= 2.0;
+  double allSamplesPerPixel = (double) m_engine->GetLength() / (double) m_spectrogramArea.GetWidth();
+  if (m_samplesPerPixel >= allSamplesPerPixel) {
+    DoZoomAll();
+    return;
+  }
+  m_startSample = midSample - m_samplesPerPixel * m_spectrogramArea.GetWidth() / 2.0;
+  ClampStartSample();
+  Refresh();
+}
+
+void SpectrogramPanel::DoZoomAll() {
+  m_zoomedAll = true;
+  UpdateLayout();
+  Refresh();
+}
+
+bool SpectrogramPanel::CanZoomIn() {
+  if (m_samplesPerPixel > 1)
+    return true;
+  else
+    return false;
+}
+
+bool SpectrogramPanel::CanZoomOut() {
+  return !m_zoomedAll;
+}
+
+int SpectrogramPanel::GetScrollRange() {
+  return (int) ceil((double) m_engine->GetLength() / m_samplesPerPixel);
+}
+
+int SpectrogramPanel::GetScrollThumb() {
+  return m_spectrogramArea.GetWidth();
+}
+
+int SpectrogramPanel::GetScrollPosition() {
+  return (int) (m_startSample / m_samplesPerPixel);
+}
+
+void SpectrogramPanel::SetScrollPosition(int position) {
+  m_startSample = (double) position * m_samplesPerPixel;
+  ClampStartSample();
+  Refresh();
+}
+
+void SpectrogramPanel::UpdateLayout() {
+  wxSize panelSize = GetClientSize();
+  // 60 px to the left for frequency ruler and 30 px at bottom for time ruler
+  int width = panelSize.x - 70;
+  int height = panelSize.y - 40;
+  if (width < 1)
+    width = 1;
+  if (height < 1)
+    height = 1;
+  m_spectrogramArea = wxRect(60, 10, width, height);
+
+  if (m_zoomedAll) {
+    m_startSample = 0;
+    m_samplesPerPixel = (double) m_engine->GetLength() / (double) width;
+    if (m_samplesPerPixel < 1)
+      m_samplesPerPixel = 1;
+  }
+  ClampStartSample();
+}
+
+void SpectrogramPanel::ClampStartSample() {
+  double lastStart = (double) m_engine->GetLength() - m_samplesPerPixel * m_spectrogramArea.GetWidth();
+  if (m_startSample > lastStart)
+    m_startSample = lastStart;
+  if (m_startSample < 0)
+    m_startSample = 0;
+}
+
+void SpectrogramPanel::CreatePalette() {
+  // black - blue - red - yellow - white with increasing level
+  const double stops[5][3] = {
+    {0, 0, 0},
+    {0, 0, 160},
+    {200, 0, 60},
+    {255, 210, 0},
+    {255, 255, 255}
+  };
+  for (int i = 0; i < 256; i++) {
+    double pos = (double) i / 255.0 * 4.0;
+    int idx = (int) pos;
+    if (idx > 3)
+      idx = 3;
+    double frac = pos - idx;
+    for (int c = 0; c < 3; c++)
+      m_palette[i][c] = (unsigned char) (stops[idx][c] + (stops[idx + 1][c] - stops[idx][c]) * frac);
+  }
+}
+
+void SpectrogramPanel::OnPaintEvent(wxPaintEvent& WXUNUSED(event)) {
+  wxAutoBufferedPaintDC dc(this);
+  dc.SetBackground(wxBrush(GetBackgroundColour()));
+  dc.Clear();
+  RenderPanel(dc);
+}
+
+void SpectrogramPanel::RenderPanel(wxDC& dc) {
+  int width = m_spectrogramArea.GetWidth();
+  int height = m_spectrogramArea.GetHeight();
+  if (width < 2 || height < 2 || m_engine->GetLength() == 0)
+    return;
+
+  unsigned bins = m_engine->GetNumberOfBins();
+  unsigned level = m_engine->GetLevelForSamplesPerPixel(m_samplesPerPixel);
+  unsigned overviewLevel = level + 2;
+  if (overviewLevel >= m_engine->GetNumberOfLevels())
+    overviewLevel = m_engine->GetNumberOfLevels() - 1;
+
+  // first bin for each row, the top row is the highest frequency
+  std::vector<unsigned> rowFirstBin(height + 1);
+  for (int y = 0; y <= height; y++)
+    rowFirstBin[y] = (unsigned) ((double) (height - y) * bins / height);
+
+  // a coarse overview of the view is requested first so there's soon something to show
+  m_engine->ClearRequests();
+  for (int x = 0; x < width; x++) {
+    double sample = m_startSample + (x + 0.5) * m_samplesPerPixel;
+    m_engine->RequestFrame(overviewLevel, (unsigned) (sample / m_engine->GetHopSize(overviewLevel) + 0.5));
+  }
+
+  wxImage image(width, height);
+  unsigned char *pixels = image.GetData();
+
+  for (int x = 0; x < width; x++) {
+    double sample = m_startSample + (x + 0.5) * m_samplesPerPixel;
+    unsigned frame = (unsigned) (sample / m_engine->GetHopSize(level) + 0.5);
+    const float *data = m_engine->GetFrame(level, frame);
+    if (!data) {
+      m_engine->RequestFrame(level, frame);
+      // use whatever coarser level is already available meanwhile
+      for (unsigned l = level + 1; l < m_engine->GetNumberOfLevels() && !data; l++)
+        data = m_engine->GetFrame(l, (unsigned) (sample / m_engine->GetHopSize(l) + 0.5));
+    }
+
+    for (int y = 0; y < height; y++) {
+      unsigned char *pixel = pixels + ((size_t) y * width + x) * 3;
+      if (!data) {
+        pixel[0] = 96;
+        pixel[1] = 96;
+        pixel[2] = 96;
+        continue;
+      }
+
+      unsigned first = rowFirstBin[y + 1];
+      unsigned last = rowFirstBin[y];
+      if (last <= first)
+        last = first + 1;
+      if (last > bins)
+        last = bins;
+      float maxValue = -145;
+      for (unsigned b = first; b < last; b++) {
+        if (data[b] > maxValue)
+          maxValue = data[b];
+      }
+
+      // 120 dB of range like the spectrum view
+      int idx = (int) ((maxValue + 120.0f) * 255.0f / 120.0f);
+      if (idx < 0)
+        idx = 0;
+      if (idx > 255)
+        idx = 255;
+      pixel[0] = m_palette[idx][0];
+      pixel[1] = m_palette[idx][1];
+      pixel[2] = m_palette[idx][2];
+    }
+  }
+
+  dc.DrawBitmap(wxBitmap(image), m_spectrogramArea.GetX(), m_spectrogramArea.GetY());
+
+  dc.SetPen(wxPen(wxColour(*wxBLACK), 1, wxPENSTYLE_SOLID));
+  dc.SetBrush(*wxTRANSPARENT_BRUSH);
+  wxRect outline(m_spectrogramArea);
+  outline.Inflate(1, 1);
+  dc.DrawRectangle(outline);
+  dc.SetFont(wxFont(8, wxFONTFAMILY_DEFAULT, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_LIGHT));
+  DrawFrequencyRuler(dc);
+  DrawTimeRuler(dc);
+
+  if (m_engine->IsBusy()) {
+    wxString calculating = wxT("Calculating...");
+    wxSize extent = dc.GetTextExtent(calculating);
+    dc.DrawText(calculating, m_spectrogramArea.GetRight() - extent.x, m_spectrogramArea.GetBottom() + 18);
+  }
+}
+
+void SpectrogramPanel::DrawFrequencyRuler(wxDC& dc) {
+  double nyquist = m_engine->GetSampleRate() / 2.0;
+  int height = m_spectrogramArea.GetHeight();
+  const double steps[] = {100, 200, 500, 1000, 2000, 5000, 10000};
+  double step = steps[6];
+  for (int i = 0; i < 7; i++) {
+    if (steps[i] / nyquist * height >= 40) {
+      step = steps[i];
+      break;
+    }
+  }
+
+  for (double hz = 0; hz <= nyquist; hz += step) {
+    int y = m_spectrogramArea.GetBottom() - (int) (hz / nyquist * (height - 1));
+    dc.DrawLine(m_spectrogramArea.GetX() - 5, y, m_spectrogramArea.GetX() - 1, y);
+    wxString label;
+    if (hz >= 1000)
+      label = wxString::Format(wxT("%.1f kHz"), hz / 1000.0);
+    else
+      label = wxString::Format(wxT("%.0f Hz"), hz);
+    wxSize extent = dc.GetTextExtent(label);
+    dc.DrawText(label, m_spectrogramArea.GetX() - 7 - extent.x, y - extent.y / 2);
+  }
+}
+
+void SpectrogramPanel::DrawTimeRuler(wxDC& dc) {
+  double sampleRate = m_engine->GetSampleRate();
+  double secondsPerPixel = m_samplesPerPixel / sampleRate;
+  const double steps[] = {0.001, 0.002, 0.005, 0.01, 0.02, 0.05, 0.1, 0.2, 0.5, 1, 2, 5, 10, 20, 30, 60};
+  double step = steps[15];
+  for (int i = 0; i < 16; i++) {
+    if (steps[i] / secondsPerPixel >= 80) {
+      step = steps[i];
+      break;
+    }
+  }
+
+  double startTime = m_startSample / sampleRate;
+  double endTime = startTime + m_spectrogramArea.GetWidth() * secondsPerPixel;
+  for (double t = ceil(startTime / step) * step; t <= endTime; t += step) {
+    int x = m_spectrogramArea.GetX() + (int) ((t - startTime) / secondsPerPixel);
+    dc.DrawLine(x, m_spectrogramArea.GetBottom() + 1, x, m_spectrogramArea.GetBottom() + 6);
+    wxString label;
+    if (step < 0.01)
+      label = wxString::Format(wxT("%.3f s"), t);
+    else if (step < 1)
+      label = wxString::Format(wxT("%.2f s"), t);
+    else
+      label = wxString::Format(wxT("%.0f s"), t);
+    wxSize extent = dc.GetTextExtent(label);
+    dc.DrawText(label, x - extent.x / 2, m_spectrogramArea.GetBottom() + 6);
+  }
+}
+
+void SpectrogramPanel::OnTileReady(wxThreadEvent& WXUNUSED(event)) {
+  if (m_engine->CollectFinishedTiles())
+    Refresh(false);
+}
+
+void SpectrogramPanel::OnPanelSize(wxSizeEvent& event) {
+  UpdateLayout();
+  SpectrogramDialog *myParent = (SpectrogramDialog*) GetParent();
+  myParent->ViewHasChanged();
+  event.Skip();
+}
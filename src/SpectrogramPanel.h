@@ -0,0 +1,71 @@
+/*
+ * SpectrogramPanel.h is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program. If not, see <https://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#ifndef SPECTROGRAMPANEL_H
+#define SPECTROGRAMPANEL_H
+
+#include <wx/wx.h>
+#include "FileHandling.h"
+#include "SpectrogramEngine.h"
+
+class SpectrogramPanel : public wxPanel {
+public:
+  SpectrogramPanel(FileHandling *audioFile, unsigned fftSize, int windowType, wxWindow *parent);
+  ~SpectrogramPanel();
+
+  void SetFftSize(unsigned fftSize);
+  void DoZoomIn();
+  void DoZoomOut();
+  void DoZoomAll();
+  bool CanZoomIn();
+  bool CanZoomOut();
+
+  // The scroll positions are in pixels of the whole file at current zoom
+  int GetScrollRange();
+  int GetScrollThumb();
+  int GetScrollPosition();
+  void SetScrollPosition(int position);
+
+private:
+	DECLARE_EVENT_TABLE()
+
+  FileHandling *m_audioFile;
+  SpectrogramEngine *m_engine;
+  int m_windowType;
+  double m_startSample;
+  double m_samplesPerPixel;
+  bool m_zoomedAll;
+  wxRect m_spectrogramArea;
+  unsigned char m_palette[256][3];
+
+  void UpdateLayout();
+  void ClampStartSample();
+  void CreatePalette();
+  void DrawTimeRuler(wxDC& dc);
+  void DrawFrequencyRuler(wxDC& dc);
+
+  void OnPaintEvent(wxPaintEvent& event);
+  void RenderPanel(wxDC& dc);
+  void OnTileReady(wxThreadEvent& event);
+  void OnPanelSize(wxSizeEvent& event);
+
+};
+
+#endif
@@ -31,6 +31,7 @@ BEGIN_EVENT_TABLE(SpectrumDialog, wxDialog)
   EVT_BUTTON(ID_ZOOM_SEL_BTN, SpectrumDialog::OnZoomSelection)
   EVT_SLIDER(ID_ZOOM_SLIDER, SpectrumDialog::OnZoomSlider)
   EVT_CHECKBOX(ID_PITCH_INTERPOLATION_CHECK, SpectrumDialog::OnPitchInterpolationCheck)
+  EVT_CHECKBOX(ID_LIVE_SPECTRUM_CHECK, SpectrumDialog::OnLiveCheck)
 END_EVENT_TABLE()
 
 SpectrumDialog::SpectrumDialog(double *fftData, unsigned fftSize, wxString fileName, unsigned samplerate) {
@@ -61,6 +62,7 @@ void SpectrumDialog::Init(double *fftData, unsigned fftSize, wxString fileName,
   m_fftSize = fftSize;
   m_fileName = fileName;
   m_sampleRate = samplerate;
+  m_liveEngine = NULL;
 }
 
 bool SpectrumDialog::Create(
@@ -170,6 +172,14 @@ void SpectrumDialog::CreateControls() {
   lastRow->Add(m_interpolatePitchCheck, 0, wxALIGN_CENTER_VERTICAL|wxALL, 5);
   m_interpolatePitchCheck->SetValue(m_drawingPanel->GetUsePitchInterpolation());
 
+  m_liveCheck = new wxCheckBox(
+    this,
+    ID_LIVE_SPECTRUM_CHECK,
+    wxT("Live while playing")
+  );
+  lastRow->Add(m_liveCheck, 0, wxALIGN_CENTER_VERTICAL|wxALL, 5);
+  m_liveCheck->Disable();
+
   lastRow->AddStretchSpacer();
   wxButton *usePitchButton = new wxButton(
     this,
@@ -204,6 +214,15 @@ void SpectrumDialog::SetInterpolatePitchOption(bool interpolate) {
   m_drawingPanel->SetPitchInterpolation(m_interpolatePitchCheck->GetValue());
 }
 
+void SpectrumDialog::SetLiveEngine(PlaybackEngine *engine) {
+  m_liveEngine = engine;
+  m_liveCheck->Enable(m_liveEngine != NULL);
+  if (!m_liveEngine) {
+    m_liveCheck->SetValue(false);
+    m_drawingPanel->StopLive();
+  }
+}
+
 void SpectrumDialog::DecideOkButtonState() {
   wxButton *theOkBtn = (wxButton*) FindWindow(wxID_OK);
   if (m_drawingPanel->HasPitchSelection()) {
@@ -279,3 +298,12 @@ void SpectrumDialog::OnPitchInterpolationCheck(wxCommandEvent& WXUNUSED(event))
   myParent->SetPreferredInterpolatePitch(m_interpolatePitchCheck->GetValue());
 }
 
+void SpectrumDialog::OnLiveCheck(wxCommandEvent& WXUNUSED(event)) {
+  if (m_liveCheck->GetValue()) {
+    m_drawingPanel->StartLive(m_liveEngine);
+    SetTitle(wxT("Live power spectrum for ") + m_fileName);
+  } else {
+    m_drawingPanel->StopLive();
+    SetTitle(wxT("Power spectrum for ") + m_fileName);
+  }
+}
@@ -23,6 +23,7 @@
 
 #include <wx/wx.h>
 #include "SpectrumPanel.h"
+#include "PlaybackEngine.h"
 
 // Identifiers
 enum {
@@ -32,6 +33,7 @@ enum {
   ID_ZOOM_SEL_BTN = wxID_HIGHEST + 413,
   ID_ZOOM_SLIDER = wxID_HIGHEST + 414,
   ID_PITCH_INTERPOLATION_CHECK = wxID_HIGHEST + 415,
+  ID_LIVE_SPECTRUM_CHECK = wxID_HIGHEST + 419,
 };
 
 class SpectrumDialog : public wxDialog {
@@ -75,6 +77,8 @@ public:
   double GetSelectedPitch();
   void PitchSelectionHasChanged();
   void SetInterpolatePitchOption(bool interpolate);
+  // Lets the spectrum and meters follow what the engine plays
+  void SetLiveEngine(PlaybackEngine *engine);
 
 private:
   double *m_fftData; // the array containing the FFT as power spectrum in dB
@@ -88,6 +92,8 @@ private:
   wxButton *m_zoomSelectionBtn;
   wxSlider *m_zoomSlider;
   wxCheckBox *m_interpolatePitchCheck;
+  wxCheckBox *m_liveCheck;
+  PlaybackEngine *m_liveEngine;
 
   void DecideOkButtonState();
   void DecideZoomButtonState();
@@ -97,6 +103,7 @@ private:
   void OnZoomSelection(wxCommandEvent& event);
   void OnZoomSlider(wxCommandEvent& event);
   void OnPitchInterpolationCheck(wxCommandEvent& event);
+  void OnLiveCheck(wxCommandEvent& event);
 
 };
 
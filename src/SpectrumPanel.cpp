@@ -23,6 +23,9 @@
 
 #include "SpectrumPanel.h"
 #include "SpectrumDialog.h"
+#include "PlaybackEngine.h"
+#include "FFT.h"
+#include <cmath>
 
 // Event table
 BEGIN_EVENT_TABLE(SpectrumPanel, wxPanel)
@@ -31,6 +34,7 @@ BEGIN_EVENT_TABLE(SpectrumPanel, wxPanel)
   EVT_MOTION(SpectrumPanel::OnMouseMotion)
   EVT_LEFT_UP(SpectrumPanel::OnLeftRelease)
   EVT_SIZE(SpectrumPanel::OnPanelSize)
+  EVT_TIMER(wxID_ANY, SpectrumPanel::OnLiveTimer)
 END_EVENT_TABLE()
 
 SpectrumPanel::SpectrumPanel(
@@ -38,7 +42,7 @@ SpectrumPanel::SpectrumPanel(
   unsigned fftSize,
   wxString fileName,
   unsigned samplerate,
-  wxWindow *parent) : wxPanel(parent, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxFULL_REPAINT_ON_RESIZE) {
+  wxWindow *parent) : wxPanel(parent, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxFULL_REPAINT_ON_RESIZE), m_liveTimer(this) {
   m_fftData = fftData;
   m_fftSize = fftSize;
   m_fileName = fileName;
@@ -61,13 +65,18 @@ SpectrumPanel::SpectrumPanel(
   m_currentSelectionX = wxCoord(-1);
   m_isSelecting = false;
   m_selectedPitch = 0;
+  m_liveEngine = NULL;
+  m_staticFftData = fftData;
+  m_liveSampleRate = samplerate;
+  m_liveChannels = 0;
+  m_liveHistoryPos = 0;
 
   SetBackgroundColour(wxColour(244,242,239));
   SetMinSize(wxSize(640, 480));
 }
 
 SpectrumPanel::~SpectrumPanel() {
-
+  StopLive();
 }
 
 double SpectrumPanel::GetSelectedPitch() {
@@ -184,6 +193,49 @@ bool SpectrumPanel::GetHasCustomZoom() {
   return m_hasCustomZoom;
 }
 
+void SpectrumPanel::StartLive(PlaybackEngine *engine) {
+  StopLive();
+  if (!engine)
+    return;
+
+  m_liveEngine = engine;
+  m_liveSampleRate = m_sampleRate * engine->GetResampleRatio();
+  m_liveChannels = engine->GetOutputChannels();
+
+  // the live analysis uses the float FFT, the result is mapped onto the bins shown
+  unsigned liveSize = m_fftSize < MaxFloatFFTSize ? m_fftSize : MaxFloatFFTSize;
+  m_liveBlock.assign(PLAYBACK_TAP_FRAMES * m_liveChannels, 0.0f);
+  m_liveHistory.assign(liveSize, 0.0f);
+  m_liveHistoryPos = 0;
+  m_liveInput.assign(liveSize, 0.0f);
+  m_liveOutput.assign(liveSize, 0.0f);
+  m_liveFftData.assign(m_fftSize / 2, -145.0);
+  m_meterPeak.assign(m_liveChannels, 0.0);
+  m_meterRms.assign(m_liveChannels, 0.0);
+  m_meterHold.assign(m_liveChannels, 0.0);
+  m_meterHoldAge.assign(m_liveChannels, 0);
+  m_fftData = &m_liveFftData[0];
+
+  m_liveEngine->SetOutputTap(true);
+  m_liveTimer.Start(40);
+  Refresh();
+}
+
+void SpectrumPanel::StopLive() {
+  if (!m_liveEngine)
+    return;
+
+  m_liveTimer.Stop();
+  m_liveEngine->SetOutputTap(false);
+  m_liveEngine = NULL;
+  m_fftData = m_staticFftData;
+  Refresh();
+}
+
+bool SpectrumPanel::IsLive() {
+  return m_liveEngine != NULL;
+}
+
 void SpectrumPanel::UpdateLayout() {
   if (!m_hasCustomZoom)
     m_visibleHzRange = (double) m_sampleRate / (2.0f * pow(2, m_zoomLevel));
@@ -250,6 +302,39 @@ double SpectrumPanel::InterpolateHz(unsigned centerBinIndex) {
   }
 }
 
+void SpectrumPanel::UpdateLiveSpectrum() {
+  unsigned liveSize = m_liveHistory.size();
+  unsigned liveHalf = liveSize / 2;
+  const double *window = GetWindow(3, liveSize);
+
+  // Scale window so an amplitude of 1.0 equals to 0 dB
+  double winScale = 0;
+  for (unsigned i = 0; i < liveSize; i++)
+    winScale += window[i];
+  winScale = 4.0 / (winScale * winScale);
+
+  // the oldest sample in the history is where the next one will be written
+  for (unsigned i = 0; i < liveSize; i++)
+    m_liveInput[i] = (float) (window[i] * m_liveHistory[(m_liveHistoryPos + i) & (liveSize - 1)]);
+  PowerSpectrum(liveSize, &m_liveInput[0], &m_liveOutput[0]);
+
+  for (unsigned i = 0; i < liveHalf; i++) {
+    double temp = 10 * log10(m_liveOutput[i] * winScale);
+    m_liveOutput[i] = temp > -145 ? temp : -145;
+  }
+
+  // the output can be at another samplerate and fft size than the bins shown
+  double liveBinsPerBin = ((double) m_sampleRate / m_fftSize) * (liveSize / m_liveSampleRate);
+  for (unsigned i = 0; i < m_fftSize / 2; i++) {
+    double exactBin = i * liveBinsPerBin;
+    unsigned bin = (unsigned) exactBin;
+    if (bin + 1 < liveHalf)
+      m_liveFftData[i] = m_liveOutput[bin] + (m_liveOutput[bin + 1] - m_liveOutput[bin]) * (exactBin - bin);
+    else
+      m_liveFftData[i] = -145;
+  }
+}
+
 void SpectrumPanel::OnPaintEvent(wxPaintEvent& WXUNUSED(event)) {
   wxPaintDC dc(this);
   RenderPanel(dc);
@@ -319,6 +404,14 @@ void SpectrumPanel::RenderPanel(wxDC& dc) {
   dc.DrawLine(panelSize.x - 100, startFftLinesAtY, panelSize.x - 94 + bottomDbExtent.x, startFftLinesAtY);
   dc.DrawText(bottomDb, panelSize.x - 95, startFftLinesAtY - (bottomDbExtent.y + 5));
 
+  if (m_liveEngine) {
+    // meters in the right margin between the dB labels
+    int metersTop = 46 + topDbExtent.y + 10;
+    int metersBottom = startFftLinesAtY - (bottomDbExtent.y + 15);
+    if (metersBottom - metersTop > 20)
+      DrawMeters(dc, wxRect(panelSize.x - 95, metersTop, 90, metersBottom - metersTop));
+  }
+
   unsigned firstVisibleBinIndex = ConvertHzToClosestBinIndex(m_currentLeftmostHz);
   unsigned lastVisibleBinIndex = ConvertHzToClosestBinIndex(m_currentRightmostHz);
   unsigned nbrVisibleBins = lastVisibleBinIndex - firstVisibleBinIndex + 1;
@@ -496,6 +589,53 @@ void SpectrumPanel::RenderPanel(wxDC& dc) {
   }
 }
 
+void SpectrumPanel::DrawMeters(wxDC& dc, wxRect area) {
+  // bars from -60 dB to 0 dB with the rms filled and peak and hold as lines
+  int textHeight = dc.GetTextExtent(wxT("0")).y;
+  int barsHeight = area.height - textHeight - 4;
+  int nbrMeters = m_meterPeak.size();
+  if (nbrMeters == 0 || barsHeight < 10)
+    return;
+  int barWidth = (area.width - 2 * (nbrMeters - 1)) / nbrMeters;
+  if (barWidth > 12)
+    barWidth = 12;
+  if (barWidth < 1)
+    return;
+
+  double maxHold = 0;
+  for (int i = 0; i < nbrMeters; i++) {
+    int x = area.x + i * (barWidth + 2);
+    int bottom = area.y + barsHeight;
+    double rmsDb = m_meterRms[i] > 0 ? 20 * log10(m_meterRms[i]) : -60;
+    double peakDb = m_meterPeak[i] > 0 ? 20 * log10(m_meterPeak[i]) : -60;
+    double holdDb = m_meterHold[i] > 0 ? 20 * log10(m_meterHold[i]) : -60;
+    int rmsHeight = rmsDb > -60 ? (int) ((rmsDb + 60) / 60.0 * barsHeight) : 0;
+    int peakY = peakDb > -60 ? bottom - (int) ((peakDb + 60) / 60.0 * barsHeight) : bottom;
+    int holdY = holdDb > -60 ? bottom - (int) ((holdDb + 60) / 60.0 * barsHeight) : bottom;
+
+    dc.SetPen(wxPen(wxColour(128, 128, 128), 1, wxPENSTYLE_SOLID));
+    dc.SetBrush(wxBrush(wxColour(*wxWHITE)));
+    dc.DrawRectangle(x, area.y, barWidth, barsHeight + 1);
+    if (rmsHeight > 0) {
+      dc.SetPen(*wxTRANSPARENT_PEN);
+      dc.SetBrush(wxBrush(wxColour(0, 160, 0)));
+      dc.DrawRectangle(x + 1, bottom - rmsHeight, barWidth - 2 > 0 ? barWidth - 2 : 1, rmsHeight);
+    }
+    dc.SetPen(wxPen(wxColour(*wxBLACK), 1, wxPENSTYLE_SOLID));
+    dc.DrawLine(x, peakY, x + barWidth, peakY);
+    // a hold at full scale is most likely clipping
+    dc.SetPen(wxPen(holdDb > -0.1 ? wxColour(*wxRED) : wxColour(0, 0, 160), 1, wxPENSTYLE_SOLID));
+    dc.DrawLine(x, holdY, x + barWidth, holdY);
+
+    if (m_meterHold[i] > maxHold)
+      maxHold = m_meterHold[i];
+  }
+
+  dc.SetPen(wxPen(wxColour(*wxBLACK), 1, wxPENSTYLE_SOLID));
+  wxString holdStr = maxHold > 0 ? wxString::Format(wxT("%.1f dB"), 20 * log10(maxHold)) : wxString(wxT("-inf dB"));
+  dc.DrawText(holdStr, area.x, area.y + barsHeight + 4);
+}
+
 void SpectrumPanel::OnLeftClick(wxMouseEvent& event) {
   wxCoord xPos = event.GetX();
   wxCoord yPos = event.GetY();
@@ -595,3 +735,43 @@ void SpectrumPanel::OnPanelSize(wxSizeEvent& WXUNUSED(event)) {
   }
 }
 
+void SpectrumPanel::OnLiveTimer(wxTimerEvent& WXUNUSED(event)) {
+  if (!m_liveEngine)
+    return;
+
+  unsigned long frames = m_liveEngine->ReadOutput(&m_liveBlock[0], PLAYBACK_TAP_FRAMES);
+
+  // meters over what was played since the last tick, peak hold falls after a second
+  for (unsigned ch = 0; ch < m_liveChannels; ch++) {
+    double peak = 0;
+    double sum = 0;
+    for (unsigned long i = 0; i < frames; i++) {
+      double value = m_liveBlock[i * m_liveChannels + ch];
+      if (fabs(value) > peak)
+        peak = fabs(value);
+      sum += value * value;
+    }
+    m_meterPeak[ch] = peak;
+    m_meterRms[ch] = frames > 0 ? sqrt(sum / frames) : 0;
+    if (peak >= m_meterHold[ch]) {
+      m_meterHold[ch] = peak;
+      m_meterHoldAge[ch] = 0;
+    } else if (++m_meterHoldAge[ch] > 25) {
+      m_meterHold[ch] *= 0.7;
+    }
+  }
+
+  if (frames > 0) {
+    unsigned mask = m_liveHistory.size() - 1;
+    for (unsigned long i = 0; i < frames; i++) {
+      float mix = 0;
+      for (unsigned ch = 0; ch < m_liveChannels; ch++)
+        mix += m_liveBlock[i * m_liveChannels + ch];
+      m_liveHistory[m_liveHistoryPos] = mix / m_liveChannels;
+      m_liveHistoryPos = (m_liveHistoryPos + 1) & mask;
+    }
+    UpdateLiveSpectrum();
+  }
+
+  Refresh();
+}
@@ -25,6 +25,8 @@
 #include "wx/overlay.h"
 #include <vector>
 
+class PlaybackEngine;
+
 class SpectrumPanel : public wxPanel {
 public:
   SpectrumPanel(double *fftData, unsigned fftSize, wxString fileName, unsigned samplerate, wxWindow *parent);
@@ -43,6 +45,10 @@ public:
   void SetPitchInterpolation(bool useInterpolation);
   bool GetUsePitchInterpolation();
   bool GetHasCustomZoom();
+  // Follows the output of the engine until StopLive is called
+  void StartLive(PlaybackEngine *engine);
+  void StopLive();
+  bool IsLive();
 
 private:
 	DECLARE_EVENT_TABLE()
@@ -73,10 +79,29 @@ private:
   unsigned m_selectionEndBin;
   bool m_hasCustomZoom;
 
+  // live spectrum and meters of what is played
+  PlaybackEngine *m_liveEngine;
+  wxTimer m_liveTimer;
+  double *m_staticFftData;
+  double m_liveSampleRate;
+  unsigned m_liveChannels;
+  std::vector<float> m_liveBlock;
+  std::vector<float> m_liveHistory; // mix of the channels, circular
+  unsigned m_liveHistoryPos;
+  std::vector<float> m_liveInput;
+  std::vector<float> m_liveOutput;
+  std::vector<double> m_liveFftData;
+  std::vector<double> m_meterPeak; // linear amplitude per channel
+  std::vector<double> m_meterRms;
+  std::vector<double> m_meterHold;
+  std::vector<unsigned> m_meterHoldAge; // in timer ticks
+
   void UpdateLayout();
   unsigned ConvertHzToClosestBinIndex(double hertz);
   double ConvertBinIndexToHz(unsigned binIndex);
   double InterpolateHz(unsigned centerBinIndex);
+  void UpdateLiveSpectrum();
+  void DrawMeters(wxDC& dc, wxRect area);
 
   void OnPaintEvent(wxPaintEvent& event);
   void RenderPanel(wxDC& dc);
@@ -84,6 +109,7 @@ private:
   void OnMouseMotion(wxMouseEvent& event);
   void OnLeftRelease(wxMouseEvent& event);
   void OnPanelSize(wxSizeEvent& event);
+  void OnLiveTimer(wxTimerEvent& event);
 
 };
 
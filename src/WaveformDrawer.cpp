@@ -38,6 +38,9 @@ BEGIN_EVENT_TABLE(WaveformDrawer, wxPanel)
   EVT_MOTION(WaveformDrawer::OnMouseMotion)
   EVT_LEAVE_WINDOW(WaveformDrawer::OnMouseLeave)
   EVT_ENTER_WINDOW(WaveformDrawer::OnMouseEnter)
+  EVT_MOUSEWHEEL(WaveformDrawer::OnMouseWheel)
+  EVT_MIDDLE_DOWN(WaveformDrawer::OnMiddleClick)
+  EVT_THREAD(WAVEFORM_SUMMARY_READY, WaveformDrawer::OnSummaryReady)
 END_EVENT_TABLE()
 
 WaveformDrawer::WaveformDrawer(wxFrame *parent, FileHandling *fh) : wxPanel(parent, wxID_ANY, wxDefaultPosition, wxDefaultSize, wxFULL_REPAINT_ON_RESIZE) {
@@ -58,11 +61,23 @@ WaveformDrawer::WaveformDrawer(wxFrame *parent, FileHandling *fh) : wxPanel(pare
   rightMargin = 10;
   trackWidth = 0;
   trackHeight = 0;
+  playSample = 0;
   playPosition = 0;
+  m_playbackActive = false;
+  m_drawnPlayPosition = -1;
   playPositionMarker = wxIcon(PlayPositionMarker_xpm);
   selectedCueIndex = 0;
   cueIsSelected = false;
   m_amplitudeZoomLevel = 1;
+  m_startSample = 0;
+  m_samplesPerPixel = 1;
+  m_zoomedAll = true;
+  m_panX = 0;
+  m_wheelRotation = 0;
+  m_waveformHasChanged = true;
+  m_layerStartSample = 0;
+  m_layerSamplesPerPixel = 0;
+  m_layerAmplitudeZoomLevel = 0;
   mouseWithinSustainSection = false;
   withinLeftChangeBorder = false;
   withinRightChangeBorder = false;
@@ -83,6 +98,10 @@ WaveformDrawer::WaveformDrawer(wxFrame *parent, FileHandling *fh) : wxPanel(pare
   // create the popup menu for the waveform
   m_popupMenu = new wxMenu();
   m_popupMenu->Append(ADD_CUE, wxT("&Add cue"), wxT("Create a new cue at this position"));
+
+  // a rough waveform is drawn at once and refined while the summary is built
+  m_summary = m_fileReference->GetWaveformSummary();
+  m_summary->Build(this, WAVEFORM_SUMMARY_READY);
 }
 
 // Called when the panel needs to be redrawn (if the panel is resized)
@@ -93,221 +112,344 @@ void WaveformDrawer::paintEvent(wxPaintEvent& WXUNUSED(event)) {
  
 // Method to call when one wants to force redrawing for playback
 void WaveformDrawer::paintNow() {
+  if (!m_playbackActive) {
+    wxClientDC dc(this);
+    OnPaintPlayPosition(dc);
+    return;
+  }
+
+  // during playback only the overlay is redrawn and only when the cursor moves
+  if (playPosition == m_drawnPlayPosition)
+    return;
+  if (outlineAlreadyDrawn) {
+    DrawSustainSectionRectOutline();
+  } else {
+    wxClientDC dc(this);
+    wxDCOverlay overlaydc(m_overlay, &dc);
+    overlaydc.Clear();
+    DrawPlayCursor(dc);
+  }
+}
+
+void WaveformDrawer::SetPlaybackActive(bool active) {
+  bool wasActive = m_playbackActive;
+  m_playbackActive = active;
+  m_drawnPlayPosition = -1;
+
+  // take the cursor away from the waveform and put the marker back
+  if (wasActive && !active) {
+    {
+      wxClientDC dc(this);
+      wxDCOverlay overlaydc(m_overlay, &dc);
+      overlaydc.Clear();
+    }
+    m_overlay.Reset();
+    if (outlineAlreadyDrawn)
+      DrawSustainSectionRectOutline();
+  }
   wxClientDC dc(this);
   OnPaintPlayPosition(dc);
 }
 
+void WaveformDrawer::DrawPlayCursor(wxDC& dc) {
+  int x = playPosition + 4;
+  if (IsWithinTrack(x)) {
+    int yPositionHigh = topMargin + 1;
+    int yPositionLow = topMargin + trackHeight * m_fileReference->waveTracks.size() + (marginBetweenTracks * (m_fileReference->waveTracks.size() - 1) - 1);
+    dc.SetPen(wxPen(black, 1, wxPENSTYLE_SOLID));
+    dc.DrawLine(x, yPositionHigh, x, yPositionLow);
+    dc.DrawIcon(playPositionMarker, playPosition, 1);
+  }
+  m_drawnPlayPosition = playPosition;
+}
+
+void WaveformDrawer::DrawPlayPositionArea(wxDC& dc) {
+  dc.SetBrush(wxBrush(white));
+  dc.SetPen(wxPen(black, 1, wxPENSTYLE_SOLID));
+
+  // draw playposition rectangle
+  dc.DrawRectangle(leftMargin, 0, trackWidth, 10);
+
+  // when zoomed in the part of the file that is shown is marked in it
+  int nrOfSamples = m_fileReference->waveTracks[0].waveData.size();
+  if (!m_zoomedAll && nrOfSamples > 0) {
+    int viewX = leftMargin + m_startSample / nrOfSamples * trackWidth;
+    int viewWidth = m_samplesPerPixel * trackWidth / nrOfSamples * trackWidth;
+    if (viewWidth < 2)
+      viewWidth = 2;
+    dc.SetBrush(wxBrush(wxColour(211, 211, 211)));
+    dc.SetPen(*wxTRANSPARENT_PEN);
+    dc.DrawRectangle(viewX, 1, viewWidth, 8);
+  }
+
+  // draw the indicator for the playposition
+  if (!m_playbackActive && IsWithinTrack(playPosition + 4))
+    dc.DrawIcon(playPositionMarker, playPosition, 1);
+}
+
 // Here the actual drawing happens when either the panel is resized or something changes
 void WaveformDrawer::OnPaint(wxDC& dc) {
-  bool redrawCompletely = false;
-
   // First get the size of this panel to know if the panel is resized.
   wxSize size = this->GetSize();
   trackWidth = size.x - (leftMargin + rightMargin);
   trackHeight = (size.y - (topMargin + bottomMargin + ((m_fileReference->m_channels - 1) * marginBetweenTracks))) / m_fileReference->m_channels;
 
-  // if playPosition == 0 reset playPosition to correct pixel value instead
-  if (playPosition == 0)
-    SetPlayPosition(0);
-
-  // Compare with the xSize and ySize members and decide if whole panel should be redrawn
-  if (size.x == xSize && size.y == ySize)
-    redrawCompletely = false;
-  else
-    redrawCompletely = true;
-
-  // Check if metadata has changed which calls for a layout calculation and complete redraw
-  if (somethingHasChanged) {
-    redrawCompletely = true;
+  // the view and the playposition in pixels follow the size
+  UpdateView();
+  SetPlayPosition(playSample);
+
+  // the waveform layer is only rendered again when it would look different
+  if (m_waveformHasChanged || size.x != xSize || size.y != ySize ||
+      m_startSample != m_layerStartSample || m_samplesPerPixel != m_layerSamplesPerPixel ||
+      m_amplitudeZoomLevel != m_layerAmplitudeZoomLevel)
+    RenderWaveformLayer(size);
+  dc.DrawBitmap(m_waveformLayer, 0, 0, false);
+
+  // and the playposition, markers and sustainsection are drawn on top of it
+  CalculateLayout();
+  DrawPlayPositionArea(dc);
+  if (m_fileReference->waveTracks[0].waveData.size() > 0) {
+    DrawMarkers(dc);
+
+    // draw transparent rectangle that indicate current sustainsection in the file
+    CalculateSustainIndication();
+    if (mouseWithinSustainSection) {
+      DrawSustainIndication(dc);
+      DrawSustainSectionRectOutline();
+    } else
+      DrawSustainIndication(dc);
   }
+  somethingHasChanged = false;
+  m_overlay.Reset();
+  m_drawnPlayPosition = -1;
+}
 
-  // This is for a complete redraw of the panel which includes waveform and metadata
-  if (redrawCompletely) {
-    // first calculate the layout
-    CalculateLayout();
+void WaveformDrawer::RenderWaveformLayer(wxSize size) {
+  if (size.x != xSize || size.y != ySize || !m_waveformLayer.IsOk()) {
+    m_waveformLayer.Create(size.x > 0 ? size.x : 1, size.y > 0 ? size.y : 1);
+    xSize = size.x;
+    ySize = size.y;
+  }
+  m_layerStartSample = m_startSample;
+  m_layerSamplesPerPixel = m_samplesPerPixel;
+  m_layerAmplitudeZoomLevel = m_amplitudeZoomLevel;
+  m_waveformHasChanged = false;
 
-    dc.SetBrush(wxBrush(white));
-    dc.SetPen(wxPen(black, 1, wxPENSTYLE_SOLID));
-    dc.SetFont(wxFont(6, wxFONTFAMILY_DEFAULT, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_LIGHT));
-
-    // draw playposition rectangle
-    dc.DrawRectangle(leftMargin, 0, trackWidth, 10);
-
-    // draw the track containing rectangles
-    if (m_fileReference->m_channels > 0) {
-      for (int i = 0; i < m_fileReference->m_channels; i++) {
-        int x1, y1, x2, y2;
-        x1 = leftMargin;
-        y1 = topMargin + trackHeight * i + i * marginBetweenTracks; // top margin + trackheight * tracknumber + margin between tracks
-        x2 = trackWidth;
-        y2 = trackHeight;
-        dc.DrawRectangle(x1, y1, x2, y2);
-        dc.DrawText(wxString::Format(wxT("%.2f"), (double) 1.0 / (double) m_amplitudeZoomLevel), 9, topMargin + trackHeight * i + i * marginBetweenTracks);
-        dc.DrawText(wxT("0"), 16, topMargin - 5 + trackHeight * i + i * marginBetweenTracks + (trackHeight / 2));
-        dc.DrawText(wxString::Format(wxT("-%.2f"), (double) 1.0 / (double) m_amplitudeZoomLevel), 6, topMargin - 2 + trackHeight * i + i * marginBetweenTracks + trackHeight - 10);
-      }
+  wxMemoryDC dc(m_waveformLayer);
+  dc.SetBackground(wxBrush(GetBackgroundColour()));
+  dc.Clear();
+  dc.SetBrush(wxBrush(white));
+  dc.SetPen(wxPen(black, 1, wxPENSTYLE_SOLID));
+  dc.SetFont(wxFont(6, wxFONTFAMILY_DEFAULT, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_LIGHT));
+
+  // draw the track containing rectangles
+  if (m_fileReference->m_channels > 0) {
+    for (int i = 0; i < m_fileReference->m_channels; i++) {
+      int x1, y1, x2, y2;
+      x1 = leftMargin;
+      y1 = topMargin + trackHeight * i + i * marginBetweenTracks; // top margin + trackheight * tracknumber + margin between tracks
+      x2 = trackWidth;
+      y2 = trackHeight;
+      dc.DrawRectangle(x1, y1, x2, y2);
+      dc.DrawText(wxString::Format(wxT("%.2f"), (double) 1.0 / (double) m_amplitudeZoomLevel), 9, topMargin + trackHeight * i + i * marginBetweenTracks);
+      dc.DrawText(wxT("0"), 16, topMargin - 5 + trackHeight * i + i * marginBetweenTracks + (trackHeight / 2));
+      dc.DrawText(wxString::Format(wxT("-%.2f"), (double) 1.0 / (double) m_amplitudeZoomLevel), 6, topMargin - 2 + trackHeight * i + i * marginBetweenTracks + trackHeight - 10);
     }
+  }
 
-    if (m_fileReference->waveTracks[0].waveData.size() > 0) {
-      int nrOfSamples = m_fileReference->waveTracks[0].waveData.size();
-      int samplesPerPixel;
-    
-      if (nrOfSamples % trackWidth == 0)
-        samplesPerPixel = nrOfSamples / trackWidth;
-      else
-        samplesPerPixel = (nrOfSamples / trackWidth) + 1;
-
-      double maxValue = 0, minValue = 0;
-      int lineToDraw = 0;
-      for (unsigned j = 0; j < m_fileReference->waveTracks.size(); j++) {
-        for (unsigned i = 0; i < m_fileReference->waveTracks[0].waveData.size(); i++) {
-          if (i % samplesPerPixel == 0 && i > 0) {
-            // we should write the line representing the audio data and start a new count
-            // but first we adjust max and min values with the m_amplitudeZoomLevel
-            maxValue *= m_amplitudeZoomLevel;
-            minValue *= m_amplitudeZoomLevel;
-            if (maxValue > 1)
-              maxValue = 1;
-            if (minValue < -1)
-              minValue = -1;
-
-            // calculate coordinates
-            wxCoord x1 = leftMargin + lineToDraw, y1 = topMargin + trackHeight * j + j * marginBetweenTracks + (trackHeight / 2) - (maxValue * trackHeight / 2);
-            wxCoord x2 = leftMargin + lineToDraw, y2 = topMargin + trackHeight * j + j * marginBetweenTracks + (trackHeight / 2) - (minValue * trackHeight / 2);
-
-            dc.SetPen(wxPen(blue, 1, wxPENSTYLE_SOLID));
-            dc.DrawLine(x1, y1, x2, y2);
-
-            // proceed with next frame
-            maxValue = m_fileReference->waveTracks[j].waveData[i];
-            minValue = m_fileReference->waveTracks[j].waveData[i];
-            lineToDraw++;
-          } else {
-            if (m_fileReference->waveTracks[j].waveData[i] > maxValue)
-              maxValue = m_fileReference->waveTracks[j].waveData[i];
-            else if (m_fileReference->waveTracks[j].waveData[i] < minValue)
-              minValue = m_fileReference->waveTracks[j].waveData[i];
-          }
+  if (m_fileReference->waveTracks[0].waveData.size() == 0)
+    return;
+
+  unsigned long nrOfSamples = m_fileReference->waveTracks[0].waveData.size();
+  int yPositionLow = topMargin + trackHeight * m_fileReference->waveTracks.size() + (marginBetweenTracks * (m_fileReference->waveTracks.size() - 1) - 1);
+
+  dc.SetPen(wxPen(blue, 1, wxPENSTYLE_SOLID));
+  dc.SetClippingRegion(leftMargin, topMargin, trackWidth, yPositionLow - topMargin);
+  for (unsigned j = 0; j < m_fileReference->waveTracks.size(); j++) {
+    int trackMiddle = topMargin + trackHeight * j + j * marginBetweenTracks + (trackHeight / 2);
+    m_wavePoints.clear();
+    if (m_samplesPerPixel >= 1) {
+      // each pixel column shows the extremes of its samples as found in the summary, the
+      // line goes down one column and up the next so that it follows both edges of the waveform
+      for (int lineToDraw = 0; lineToDraw < trackWidth; lineToDraw++) {
+        double firstSample = m_startSample + lineToDraw * m_samplesPerPixel;
+        unsigned long start = (unsigned long) firstSample;
+        unsigned long end = (unsigned long) (firstSample + m_samplesPerPixel);
+        if (start >= nrOfSamples)
+          break;
+        if (end <= start)
+          end = start + 1;
+        if (end > nrOfSamples)
+          end = nrOfSamples;
+        // reaching one sample back joins the column to the previous one
+        if (start > 0)
+          start--;
+
+        double maxValue = 0, minValue = 0;
+        m_summary->GetMinMax(j, start, end, minValue, maxValue);
+
+        // adjust max and min values with the m_amplitudeZoomLevel
+        maxValue *= m_amplitudeZoomLevel;
+        minValue *= m_amplitudeZoomLevel;
+        if (maxValue > 1)
+          maxValue = 1;
+        if (minValue < -1)
+          minValue = -1;
+
+        // calculate coordinates
+        wxCoord x = leftMargin + lineToDraw;
+        wxCoord y1 = trackMiddle - (maxValue * trackHeight / 2);
+        wxCoord y2 = trackMiddle - (minValue * trackHeight / 2);
+        if (lineToDraw % 2 == 0) {
+          m_wavePoints.push_back(wxPoint(x, y1));
+          m_wavePoints.push_back(wxPoint(x, y2));
+        } else {
+          m_wavePoints.push_back(wxPoint(x, y2));
+          m_wavePoints.push_back(wxPoint(x, y1));
         }
-        // draw the 0 indicating line
-        dc.SetPen(wxPen(blue, 1, wxPENSTYLE_SOLID));
-        dc.DrawLine((leftMargin + 1), topMargin + trackHeight * j + j * marginBetweenTracks + (trackHeight / 2), size.x - (rightMargin + 1), topMargin + trackHeight * j + j * marginBetweenTracks + (trackHeight / 2));
-
-        // reset the wave pixel position for the next track
-        lineToDraw = 0;
-        maxValue = 0;
-        minValue = 0;
       }
-      // draw in eventual metadata (loops and cues)
-      dc.SetFont(wxFont(8, wxFONTFAMILY_DEFAULT, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL));
-      if (cueSampleOffset.size() > 0) {
-        int overlap = 0;
-        // here we draw the cues from the vector
-        for (unsigned i = 0; i < cueSampleOffset.size(); i++) {
-          overlap = cueLayout[i].putInRow;
-          // the positions from dwSampleOffset is in sample frames so it has to be re-calculated into pixels
-          int xPosition = cueSampleOffset[i] / samplesPerPixel + leftMargin;
-          int yPositionHigh = topMargin + 1;
-          int yPositionLow = topMargin + trackHeight * m_fileReference->waveTracks.size() + (marginBetweenTracks * (m_fileReference->waveTracks.size() - 1) - 1);
-          if (hasCueSelection && i == (unsigned) cueIndexSelection) {
-            dc.SetPen(wxPen(green, 1, wxPENSTYLE_SOLID));
-          } else {
-            dc.SetPen(wxPen(green, 1, wxPENSTYLE_DOT));
-          }
-          wxSize extent = dc.GetTextExtent(wxString::Format(wxT("M%i"), i + 1));
-          dc.DrawLine(xPosition, yPositionLow, xPosition, yPositionHigh + overlap * (extent.GetHeight() + 5));
-          dc.DrawRectangle(xPosition, yPositionHigh + overlap * (extent.GetHeight() + 5), extent.GetWidth() + 2, extent.GetHeight());
-          cueLayout[i].flagUpLeft = std::make_pair(xPosition, yPositionHigh + overlap * (extent.GetHeight() + 5)); 
-          cueLayout[i].flagDownRight = std::make_pair(xPosition + extent.GetWidth() + 2, yPositionHigh + overlap * (extent.GetHeight() + 5) + extent.GetHeight());
-          dc.DrawText(wxString::Format(wxT("M%i"), i + 1), xPosition + 1, yPositionHigh + overlap * (extent.GetHeight() + 5));
-        }
+    } else {
+      // zoomed in so far that each sample gets several pixels, the samples are joined with lines
+      unsigned long first = (unsigned long) m_startSample;
+      unsigned long last = (unsigned long) ceil(m_startSample + trackWidth * m_samplesPerPixel);
+      if (last >= nrOfSamples)
+        last = nrOfSamples - 1;
+      for (unsigned long i = first; i <= last; i++) {
+        double value = m_fileReference->waveTracks[j].waveData[i] * m_amplitudeZoomLevel;
+        if (value > 1)
+          value = 1;
+        if (value < -1)
+          value = -1;
+        m_wavePoints.push_back(wxPoint(SampleToPixel(i), trackMiddle - (value * trackHeight / 2)));
       }
-      if (loopPositions.size() > 0) {
-        // here we draw the loops from the vector
-        int overlap = 0;
-        int yPositionHigh = topMargin + 1;
-        int yPositionLow = topMargin + trackHeight * m_fileReference->waveTracks.size() + (marginBetweenTracks * (m_fileReference->waveTracks.size() - 1) - 1);
-
-        for (unsigned i = 0; i < loopPositions.size(); i++) {
-          // the loop start value (in samples) is in loopPositions[i].first
-          int xPositionS = loopPositions[i].first / samplesPerPixel + leftMargin;
+      // draw the samplepoints as 3 x 3 points when they are far enough apart
+      if (m_samplesPerPixel < 0.2) {
+        dc.SetBrush(wxBrush(blue));
+        for (unsigned i = 0; i < m_wavePoints.size(); i++)
+          dc.DrawRectangle(m_wavePoints[i].x - 1, m_wavePoints[i].y - 1, 3, 3);
+      }
+    }
+    if (m_wavePoints.size() > 1)
+      dc.DrawLines(m_wavePoints.size(), &m_wavePoints[0]);
+    // draw the 0 indicating line
+    dc.DrawLine((leftMargin + 1), trackMiddle, size.x - (rightMargin + 1), trackMiddle);
+  }
+  dc.DestroyClippingRegion();
 
-          overlap = loopLayout[i].placedInRow;
+  // draw time indicating lines at bottom, at least 25 pixels apart
+  dc.SetPen(wxPen(black, 1, wxPENSTYLE_SOLID));
+  dc.SetFont(wxFont(6, wxFONTFAMILY_DEFAULT, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_LIGHT));
+  double pixelsPerSecond = m_fileReference->GetSampleRate() / m_samplesPerPixel;
+  double interval = 0.25;
+  if (interval * pixelsPerSecond < 25) {
+    // multiples of a quarter of a second
+    interval *= ceil(25 / (interval * pixelsPerSecond));
+  } else {
+    // when zoomed in the lines are 0.2, 0.1, 0.05... seconds apart
+    double steps[3] = { 0.2, 0.1, 0.05 };
+    for (double scale = 1; steps[0] * scale * pixelsPerSecond >= 25; scale /= 10) {
+      for (unsigned k = 0; k < 3; k++) {
+        if (steps[k] * scale * pixelsPerSecond >= 25)
+          interval = steps[k] * scale;
+      }
+    }
+  }
+  // every second line has a number with enough decimals to tell them apart
+  int decimals = ceil(-log10(interval * 2) - 0.000001);
+  if (decimals < 1)
+    decimals = 1;
+  double viewStartTime = m_startSample / m_fileReference->GetSampleRate();
+  double viewEndTime = PixelToSample(leftMargin + trackWidth) / m_fileReference->GetSampleRate();
+  for (long lineNbr = (long) ceil(viewStartTime / interval - 0.000001); lineNbr * interval <= viewEndTime; lineNbr++) {
+    int xCoordinate = SampleToPixel(lineNbr * interval * m_fileReference->GetSampleRate() + 0.000001);
+    if (!IsWithinTrack(xCoordinate))
+      continue;
+    if (lineNbr % 2 == 0) {
+      // at this line we also write a number
+      dc.DrawLine(xCoordinate, size.y - 11, xCoordinate, size.y - 1);
+      wxString timeString = wxT("0");
+      if (lineNbr > 0)
+        timeString = wxString::Format(wxString::Format(wxT("%%.%if"), decimals), lineNbr * interval);
+      wxSize extent = dc.GetTextExtent(timeString);
+      dc.DrawText(timeString, xCoordinate + 2, size.y - extent.GetHeight());
+    } else {
+      dc.DrawLine(xCoordinate, size.y - 11, xCoordinate, size.y - 5);
+    }
+  }
+}
 
-          if (hasLoopSelection && i == (unsigned) loopIndexSelection) {
-            dc.SetPen(wxPen(red, 1, wxPENSTYLE_SOLID));
-          } else {
-            dc.SetPen(wxPen(red, 1, wxPENSTYLE_DOT_DASH));
-          }
-          wxSize extent = dc.GetTextExtent(wxString::Format(wxT("L%i"), i + 1));
-          dc.DrawLine(xPositionS, yPositionLow, xPositionS, yPositionHigh + overlap * (extent.GetHeight() + 5));
-          dc.DrawRectangle(xPositionS, yPositionHigh + overlap * (extent.GetHeight() + 5), extent.GetWidth() + 2, extent.GetHeight());
-          dc.DrawText(wxString::Format(wxT("L%i"), i + 1), xPositionS + 1, yPositionHigh + overlap * (extent.GetHeight() + 5));
-
-          // the loop end value (in samples) is in loopPositions[i].second
-          int xPositionE = loopPositions[i].second / samplesPerPixel + leftMargin;
-          dc.DrawLine(xPositionE, yPositionLow, xPositionE, yPositionHigh + overlap * (extent.GetHeight() + 5));
-          dc.DrawRectangle(xPositionE - (extent.GetWidth() + 1), yPositionHigh + overlap * (extent.GetHeight() + 5), extent.GetWidth() + 2, extent.GetHeight());
-          dc.DrawText(wxString::Format(wxT("L%i"), i + 1), xPositionE - (extent.GetWidth() + 1), yPositionHigh + overlap * (extent.GetHeight() + 5));
-
-          // draw line at top connecting loop start and end lines
-          dc.DrawLine(xPositionS, yPositionHigh + overlap * (extent.GetHeight() + 5), xPositionE, yPositionHigh + overlap * (extent.GetHeight() + 5));
-        }
+void WaveformDrawer::DrawMarkers(wxDC& dc) {
+  int yPositionHigh = topMargin + 1;
+  int yPositionLow = topMargin + trackHeight * m_fileReference->waveTracks.size() + (marginBetweenTracks * (m_fileReference->waveTracks.size() - 1) - 1);
+
+  // draw in eventual metadata (loops and cues) that is within the view
+  dc.SetBrush(wxBrush(white));
+  dc.SetFont(wxFont(8, wxFONTFAMILY_DEFAULT, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_NORMAL));
+  if (cueSampleOffset.size() > 0) {
+    int overlap = 0;
+    // here we draw the cues from the vector
+    for (unsigned i = 0; i < cueSampleOffset.size(); i++) {
+      overlap = cueLayout[i].putInRow;
+      // the positions from dwSampleOffset is in sample frames so it has to be re-calculated into pixels
+      int xPosition = SampleToPixel(cueSampleOffset[i]);
+      if (!IsWithinTrack(xPosition)) {
+        // a cue that isn't shown can't be clicked either
+        cueLayout[i].flagUpLeft = std::make_pair(-1, -1);
+        cueLayout[i].flagDownRight = std::make_pair(-1, -1);
+        continue;
       }
-      
-      // draw time indicating lines at bottom
-      dc.SetPen(wxPen(black, 1, wxPENSTYLE_SOLID));
-      // starting at zero
-      dc.DrawLine(leftMargin, size.y - 11, leftMargin, size.y - 1);
-      dc.SetFont(wxFont(6, wxFONTFAMILY_DEFAULT, wxFONTSTYLE_NORMAL, wxFONTWEIGHT_LIGHT));
-      wxSize extent = dc.GetTextExtent(wxT("0"));
-      dc.DrawText(wxT("0"), leftMargin + 2, size.y - extent.GetHeight());
-      int lastLineX = 0;
-      int lineNbr = 1;
-      for (int i = 0; i < nrOfSamples; i++) {
-        // only care if the sample make at least 0.25s
-        if ((i * 4) % m_fileReference->GetSampleRate() == 0) {
-          // make sure at least 25 pixels are passed since last line
-          int xCoordinate = i / samplesPerPixel;
-          if (xCoordinate - lastLineX >= 25) {
-            if (lineNbr % 2 == 0) {
-              // at this line we also write a number
-              dc.DrawLine(leftMargin + xCoordinate, size.y - 11, leftMargin + xCoordinate, size.y - 1);
-              wxString timeString = wxString::Format(wxT("%.1f"), ((double) i / (double) m_fileReference->GetSampleRate()));
-              wxSize extent = dc.GetTextExtent(timeString);
-              dc.DrawText(timeString, leftMargin + xCoordinate + 2, size.y - extent.GetHeight());
-            } else {
-              dc.DrawLine(leftMargin + xCoordinate, size.y - 11, leftMargin + xCoordinate, size.y - 5);
-            }
-            lineNbr++;
-            lastLineX = xCoordinate;
-          }
-        }
+      if (hasCueSelection && i == (unsigned) cueIndexSelection) {
+        dc.SetPen(wxPen(green, 1, wxPENSTYLE_SOLID));
+      } else {
+        dc.SetPen(wxPen(green, 1, wxPENSTYLE_DOT));
       }
-      // draw transparent rectangle that indicate current sustainsection in the file
-      CalculateSustainIndication();
-      if (mouseWithinSustainSection) {
-        DrawSustainIndication(dc);
-        DrawSustainSectionRectOutline();
-      } else
-        DrawSustainIndication(dc);
+      wxSize extent = dc.GetTextExtent(wxString::Format(wxT("M%i"), i + 1));
+      dc.DrawLine(xPosition, yPositionLow, xPosition, yPositionHigh + overlap * (extent.GetHeight() + 5));
+      dc.DrawRectangle(xPosition, yPositionHigh + overlap * (extent.GetHeight() + 5), extent.GetWidth() + 2, extent.GetHeight());
+      cueLayout[i].flagUpLeft = std::make_pair(xPosition, yPositionHigh + overlap * (extent.GetHeight() + 5)); 
+      cueLayout[i].flagDownRight = std::make_pair(xPosition + extent.GetWidth() + 2, yPositionHigh + overlap * (extent.GetHeight() + 5) + extent.GetHeight());
+      dc.DrawText(wxString::Format(wxT("M%i"), i + 1), xPosition + 1, yPositionHigh + overlap * (extent.GetHeight() + 5));
     }
-    // draw the indicator for the playposition
-    dc.DrawIcon(playPositionMarker, playPosition, 1);
-    somethingHasChanged = false;
-    m_overlay.Reset();
-  } else {
-    // the panel is not resized so the waveform doesn't need redrawing but the playposition should be redrawn
-    dc.SetClippingRegion(0, 0, leftMargin + trackWidth + rightMargin, 9);
-    dc.Clear();
-    dc.SetBrush(wxBrush(white));
-    dc.SetPen(wxPen(black, 1, wxPENSTYLE_SOLID));
+  }
+  if (loopPositions.size() > 0) {
+    // here we draw the loops from the vector
+    int overlap = 0;
+
+    for (unsigned i = 0; i < loopPositions.size(); i++) {
+      // the loop start value (in samples) is in loopPositions[i].first
+      int xPositionS = SampleToPixel(loopPositions[i].first);
+      // the loop end value (in samples) is in loopPositions[i].second
+      int xPositionE = SampleToPixel(loopPositions[i].second);
+      if (xPositionE < leftMargin || xPositionS > leftMargin + trackWidth)
+        continue;
+
+      overlap = loopLayout[i].placedInRow;
+
+      if (hasLoopSelection && i == (unsigned) loopIndexSelection) {
+        dc.SetPen(wxPen(red, 1, wxPENSTYLE_SOLID));
+      } else {
+        dc.SetPen(wxPen(red, 1, wxPENSTYLE_DOT_DASH));
+      }
+      wxSize extent = dc.GetTextExtent(wxString::Format(wxT("L%i"), i + 1));
+      if (IsWithinTrack(xPositionS)) {
+        dc.DrawLine(xPositionS, yPositionLow, xPositionS, yPositionHigh + overlap * (extent.GetHeight() + 5));
+        dc.DrawRectangle(xPositionS, yPositionHigh + overlap * (extent.GetHeight() + 5), extent.GetWidth() + 2, extent.GetHeight());
+        dc.DrawText(wxString::Format(wxT("L%i"), i + 1), xPositionS + 1, yPositionHigh + overlap * (extent.GetHeight() + 5));
+      } else {
+        xPositionS = leftMargin;
+      }
 
-    // draw playposition rectangle
-    dc.DrawRectangle(leftMargin, 0, trackWidth, 10);
- 
-    // draw the indicator for the playposition 
-    dc.DrawIcon(playPositionMarker, playPosition, 1);
+      if (IsWithinTrack(xPositionE)) {
+        dc.DrawLine(xPositionE, yPositionLow, xPositionE, yPositionHigh + overlap * (extent.GetHeight() + 5));
+        dc.DrawRectangle(xPositionE - (extent.GetWidth() + 1), yPositionHigh + overlap * (extent.GetHeight() + 5), extent.GetWidth() + 2, extent.GetHeight());
+        dc.DrawText(wxString::Format(wxT("L%i"), i + 1), xPositionE - (extent.GetWidth() + 1), yPositionHigh + overlap * (extent.GetHeight() + 5));
+      } else {
+        xPositionE = leftMargin + trackWidth;
+      }
+
+      // draw line at top connecting loop start and end lines
+      dc.DrawLine(xPositionS, yPositionHigh + overlap * (extent.GetHeight() + 5), xPositionE, yPositionHigh + overlap * (extent.GetHeight() + 5));
+    }
   }
 }
 
@@ -315,27 +457,21 @@ void WaveformDrawer::OnPaintPlayPosition(wxDC& dc) {
   // the playposition should be redrawn during playback
   dc.SetClippingRegion(0, 0, leftMargin + trackWidth + rightMargin, 9);
   dc.Clear();
-  dc.SetPen(wxPen(black, 1, wxPENSTYLE_SOLID));
-  dc.SetBrush(wxBrush(white, wxBRUSHSTYLE_SOLID));
-
-  // draw playposition rectangle
-  dc.DrawRectangle(leftMargin, 0, trackWidth, 10);
- 
-  // draw the indicator for the playposition 
-  dc.DrawIcon(playPositionMarker, playPosition, 1);
+  DrawPlayPositionArea(dc);
 }
 
 void WaveformDrawer::SetPlayPosition(unsigned int pPos) {
-  // In comes a sample value and the playPosition is calculated in pixels from (leftMargin - 4) to (trackWidth - 4)
-  int nrOfSamples = m_fileReference->waveTracks[0].waveData.size();
-  int samplesPerPixel;
-
+  // In comes a sample value and the playPosition is calculated in pixels, 4 to the left of the sample
+  playSample = pPos;
   if (trackWidth > 0) {
-    if (nrOfSamples % trackWidth == 0)
-      samplesPerPixel = nrOfSamples / trackWidth;
-    else
-      samplesPerPixel = (nrOfSamples / trackWidth) + 1;
-    playPosition = pPos / samplesPerPixel + (leftMargin - 4);
+    // a view zoomed in on time turns the page when playback leaves it
+    if (m_playbackActive && !m_zoomedAll && (pPos < m_startSample || pPos >= m_startSample + trackWidth * m_samplesPerPixel)) {
+      m_startSample = pPos - trackWidth * m_samplesPerPixel / 10;
+      UpdateView();
+      somethingHasChanged = true;
+      Refresh();
+    }
+    playPosition = SampleToPixel(pPos) - 4;
   } else {
     playPosition = leftMargin - 4;
   }
@@ -344,6 +480,12 @@ void WaveformDrawer::SetPlayPosition(unsigned int pPos) {
 WaveformDrawer::~WaveformDrawer() {
 }
 
+void WaveformDrawer::OnSummaryReady(wxThreadEvent& WXUNUSED(event)) {
+  m_waveformHasChanged = true;
+  somethingHasChanged = true;
+  Refresh();
+}
+
 void WaveformDrawer::AddCuePosition(unsigned int cuePos) {
   cueSampleOffset.push_back(cuePos);
   somethingHasChanged = true;
@@ -432,17 +574,8 @@ void WaveformDrawer::CalculateLayout() {
     }
   }
 
-  // And now it's the cue markers turn but first we get the samplesPerPixel value
-  int nrOfSamples = m_fileReference->waveTracks[0].waveData.size();
-  int samplesPerPixel;
-  int equalTo24px;
-
-  if (nrOfSamples % trackWidth == 0)
-    samplesPerPixel = nrOfSamples / trackWidth;
-  else
-    samplesPerPixel = (nrOfSamples / trackWidth) + 1;
-
-  equalTo24px = 24 * samplesPerPixel;
+  // And now it's the cue markers turn, how close they are depends on the time zoom
+  int equalTo24px = ceil(24 * m_samplesPerPixel);
 
   for (unsigned i = 0; i < cueSampleOffset.size(); i++) {
     // Add a CUELAYOUT item to the cueLayout vector
@@ -471,7 +604,7 @@ void WaveformDrawer::CalculateLayout() {
       else
         differenceInSamples = cueSampleOffset[j] - cueSampleOffset[i];
 
-      if (differenceInSamples / samplesPerPixel < 25)
+      if (differenceInSamples / m_samplesPerPixel < 25)
         cueLayout[i].markerClose.push_back(j);
     }
   }
@@ -522,16 +655,18 @@ void WaveformDrawer::OnLeftClick(wxMouseEvent& event) {
   m_x = event.GetX(); 
   m_y = event.GetY();
 
-  if (m_x > leftMargin && m_x < (leftMargin + trackWidth) && m_y > topMargin && m_y <= (topMargin + trackHeight * m_fileReference->m_channels + marginBetweenTracks * m_fileReference->m_channels)) {
-    // user have clicked on the track area
+  if (!m_zoomedAll && m_x >= leftMargin && m_x < (leftMargin + trackWidth) && m_y < topMargin) {
+    // a click in the playposition area centers the view on that part of the file
     int nrOfSamples = m_fileReference->waveTracks[0].waveData.size();
-    int samplesPerPixel;
-
-    if (nrOfSamples % trackWidth == 0)
-      samplesPerPixel = nrOfSamples / trackWidth;
-    else
-      samplesPerPixel = (nrOfSamples / trackWidth) + 1;
+    m_startSample = (double) (m_x - leftMargin) / trackWidth * nrOfSamples - trackWidth * m_samplesPerPixel / 2;
+    UpdateView();
+    somethingHasChanged = true;
+    Refresh();
+    return;
+  }
 
+  if (m_x > leftMargin && m_x < (leftMargin + trackWidth) && m_y > topMargin && m_y <= (topMargin + trackHeight * m_fileReference->m_channels + marginBetweenTracks * m_fileReference->m_channels)) {
+    // user have clicked on the track area
     if (mouseWithinSustainSection) {
       
       if (!isChangingSustainSection) {
@@ -557,30 +692,7 @@ void WaveformDrawer::OnLeftClick(wxMouseEvent& event) {
       if (m_x > leftMargin + trackWidth)
         m_x = leftMargin + trackWidth;
 
-      int approximateSampleNumber = samplesPerPixel * (m_x - (leftMargin + 1));
-      int earliestSampleToConsider = approximateSampleNumber - samplesPerPixel;
-      unsigned lastSampleToConsider = approximateSampleNumber + samplesPerPixel;
-
-      if (earliestSampleToConsider < 0)
-        earliestSampleToConsider = 0;
-
-      if (lastSampleToConsider > m_fileReference->waveTracks[0].waveData.size())
-        lastSampleToConsider = m_fileReference->waveTracks[0].waveData.size() - 1;
-
-      unsigned int bestSample = 0;
-      double lowestRMSPower = DBL_MAX;
-      double currentRMSPower = 0;
-      // the sample values are in waveTracks[0].waveData
-      for (unsigned i = earliestSampleToConsider; i <= lastSampleToConsider; i++) {
-        for (unsigned j = 0; j < m_fileReference->waveTracks.size(); j++)
-          currentRMSPower += pow(m_fileReference->waveTracks[j].waveData[i], 2);
-
-        if (currentRMSPower < lowestRMSPower) {
-          lowestRMSPower = currentRMSPower;
-          bestSample = i;
-        }
-        currentRMSPower = 0;
-      }
+      unsigned bestSample = FindLowestPowerSample(m_x);
 
       cueSampleOffset[selectedCueIndex] = bestSample; // change the cues position in this class
       ::wxGetApp().frame->ChangeCuePosition(bestSample, selectedCueIndex); // send offset value for changed cue
@@ -628,10 +740,17 @@ void WaveformDrawer::OnLeftRelease(wxMouseEvent& WXUNUSED(event)) {
     if (isChangingSustainSection) {
       // we must update the sustainsection in the file reference as it could have changed
       // the values to send is in percentage of track size
+      // only the side that was dragged is taken from the rectangle as it's cut at the view when zoomed in
       isChangingSustainSection = false;
       CalculateSustainRectZones();
-      int start = ((double) (m_sustainsection_rect.xPosLeft - leftMargin) / trackWidth) * 100 + 0.5;
-      int end = ((double) (m_sustainsection_rect.xPosLeft + m_sustainsection_rect.xExtent - leftMargin) / trackWidth) * 100 + 0.5;
+      double nrOfSamples = m_fileReference->waveTracks[0].waveData.size();
+      std::pair<unsigned, unsigned> currentSustain = m_fileReference->GetSustainsection();
+      int start = currentSustain.first / nrOfSamples * 100 + 0.5;
+      int end = currentSustain.second / nrOfSamples * 100 + 0.5;
+      if (withinLeftChangeBorder)
+        start = PixelToSample(m_sustainsection_rect.xPosLeft) / nrOfSamples * 100 + 0.5;
+      if (withinRightChangeBorder)
+        end = PixelToSample(m_sustainsection_rect.xPosLeft + m_sustainsection_rect.xExtent) / nrOfSamples * 100 + 0.5;
       m_fileReference->SetSliderSustainsection(start, end);
 
       // also the auto loopsearch parameters must be updated
@@ -671,7 +790,14 @@ void WaveformDrawer::OnRightClick(wxMouseEvent& event) {
   }
 }
 
-void WaveformDrawer::OnMouseMotion(wxMouseEvent& WXUNUSED(event)) {
+void WaveformDrawer::OnMouseMotion(wxMouseEvent& event) {
+  if (event.MiddleIsDown()) {
+    // dragging with the middle button pans the view
+    ScrollView(m_panX - event.GetX());
+    m_panX = event.GetX();
+    return;
+  }
+
   if (!m_fileReference->GetAutoSustainSearch()) {
     wxPoint pt = wxGetMousePosition();
     int mouseX = pt.x - this->GetScreenPosition().x;
@@ -712,8 +838,8 @@ void WaveformDrawer::OnMouseMotion(wxMouseEvent& WXUNUSED(event)) {
             m_sustainsection_rect.xExtent += (m_prev_x - mouseX);
             m_sustainsection_rect.xPosLeft -= (m_prev_x - mouseX);
             outlineHasChanged = true;
-          } else if (mouseX > m_prev_x && ((double) m_sustainsection_rect.xExtent / trackWidth * 100 + 0.5 > 1.0f)) {
-            if ((m_sustainsection_rect.xExtent - (mouseX - m_prev_x)) / (double) trackWidth * 100 + 0.5 > 1.0f) {
+          } else if (mouseX > m_prev_x && ((double) m_sustainsection_rect.xExtent / GetFileWidthInPixels() * 100 + 0.5 > 1.0f)) {
+            if ((m_sustainsection_rect.xExtent - (mouseX - m_prev_x)) / GetFileWidthInPixels() * 100 + 0.5 > 1.0f) {
               m_sustainsection_rect.xExtent -= (mouseX - m_prev_x);
               m_sustainsection_rect.xPosLeft += (mouseX - m_prev_x);
               outlineHasChanged = true;
@@ -725,8 +851,8 @@ void WaveformDrawer::OnMouseMotion(wxMouseEvent& WXUNUSED(event)) {
           }
           m_prev_x = mouseX;
         } else if (withinRightChangeBorder) {
-          if (mouseX < m_prev_x && (m_sustainsection_rect.xExtent / (double) trackWidth * 100 > 1.0f)) {
-            if ((m_sustainsection_rect.xExtent - (m_prev_x - mouseX)) / (double) trackWidth * 100 > 1.0f) {
+          if (mouseX < m_prev_x && (m_sustainsection_rect.xExtent / GetFileWidthInPixels() * 100 > 1.0f)) {
+            if ((m_sustainsection_rect.xExtent - (m_prev_x - mouseX)) / GetFileWidthInPixels() * 100 > 1.0f) {
               m_sustainsection_rect.xExtent -= (m_prev_x - mouseX);
               outlineHasChanged = true;
             } else {
@@ -803,6 +929,8 @@ void WaveformDrawer::DrawSustainSectionRectOutline() {
   } else if (withinRightChangeBorder) {
     dc.DrawLine(m_rightBorderX, m_sustainsection_rect.yPosHigh + 1, m_rightBorderX, m_sustainsection_rect.yPosHigh + m_sustainsection_rect.yExtent - 1);
   }
+  if (m_playbackActive)
+    DrawPlayCursor(dc);
 }
 
 void WaveformDrawer::CalculateSustainRectZones() {
@@ -837,18 +965,17 @@ void WaveformDrawer::DrawSustainIndication(wxDC &dc) {
 }
 
 void WaveformDrawer::CalculateSustainIndication() {
-  int nrOfSamples = m_fileReference->waveTracks[0].waveData.size();
-  int samplesPerPixel;
-    
-  if (nrOfSamples % trackWidth == 0)
-    samplesPerPixel = nrOfSamples / trackWidth;
-  else
-    samplesPerPixel = (nrOfSamples / trackWidth) + 1;
   std::pair<unsigned, unsigned> currentSustain = m_fileReference->GetSustainsection();
   int yPosHigh = topMargin + 1;
   int yExtent = topMargin + trackHeight * m_fileReference->waveTracks.size() + (marginBetweenTracks * (m_fileReference->waveTracks.size() - 1) - 1) - yPosHigh;
-  int xPosLeft = currentSustain.first / samplesPerPixel + leftMargin;
-  int xExtent = (currentSustain.second - currentSustain.first) / samplesPerPixel;
+  // when zoomed in only the part within the view is indicated
+  int xPosLeft = SampleToPixel(currentSustain.first);
+  int xPosRight = SampleToPixel(currentSustain.second);
+  if (xPosLeft < leftMargin)
+    xPosLeft = leftMargin;
+  if (xPosRight > leftMargin + trackWidth)
+    xPosRight = leftMargin + trackWidth;
+  int xExtent = xPosRight > xPosLeft ? xPosRight - xPosLeft : 0;
   m_sustainsection_rect.yPosHigh = yPosHigh;
   m_sustainsection_rect.yExtent = yExtent;
   m_sustainsection_rect.xPosLeft = xPosLeft;
@@ -857,25 +984,27 @@ void WaveformDrawer::CalculateSustainIndication() {
 }
 
 void WaveformDrawer::OnClickAddCue(wxCommandEvent& WXUNUSED(event)) {
-  // we should now calculate what sample have lowest RMS power around current position
-  // so that a good dwSampleOffset value can be sent to the new cue
-  int nrOfSamples = m_fileReference->waveTracks[0].waveData.size();
-  int samplesPerPixel;
-
-  if (nrOfSamples % trackWidth == 0)
-    samplesPerPixel = nrOfSamples / trackWidth;
-  else
-    samplesPerPixel = (nrOfSamples / trackWidth) + 1;
+  // send offset value for the new cue creation
+  ::wxGetApp().frame->AddNewCue(FindLowestPowerSample(m_x));
+}
 
-  int approximateSampleNumber = samplesPerPixel * (m_x - (leftMargin + 1));
-  int earliestSampleToConsider = approximateSampleNumber - samplesPerPixel;
-  unsigned lastSampleToConsider = approximateSampleNumber + samplesPerPixel;
+unsigned WaveformDrawer::FindLowestPowerSample(int x) {
+  // we should now calculate what sample have lowest RMS power around the position
+  // so that a good dwSampleOffset value can be used for the cue
+  unsigned nrOfSamples = m_fileReference->waveTracks[0].waveData.size();
+  int searchRange = ceil(m_samplesPerPixel);
+  int approximateSampleNumber = PixelToSample(x);
+  int earliestSampleToConsider = approximateSampleNumber - searchRange;
+  unsigned lastSampleToConsider = approximateSampleNumber + searchRange;
 
   if (earliestSampleToConsider < 0)
     earliestSampleToConsider = 0;
 
-  if (lastSampleToConsider > m_fileReference->waveTracks[0].waveData.size())
-    lastSampleToConsider = m_fileReference->waveTracks[0].waveData.size() - 1;
+  if (lastSampleToConsider >= nrOfSamples)
+    lastSampleToConsider = nrOfSamples - 1;
+
+  if ((unsigned) earliestSampleToConsider > lastSampleToConsider)
+    earliestSampleToConsider = lastSampleToConsider;
 
   unsigned int bestSample = 0;
   double lowestRMSPower = DBL_MAX;
@@ -892,7 +1021,7 @@ void WaveformDrawer::OnClickAddCue(wxCommandEvent& WXUNUSED(event)) {
     currentRMSPower = 0;
   }
 
-  ::wxGetApp().frame->AddNewCue(bestSample); // send offset value for the new cue creation
+  return bestSample;
 }
 
 void WaveformDrawer::ChangeLoopPositions(unsigned int start, unsigned int end, int idx) {
@@ -919,6 +1048,127 @@ void WaveformDrawer::ZoomOutAmplitude() {
   somethingHasChanged = true;
 }
 
+double WaveformDrawer::GetTimeZoomFactor() {
+  int nrOfSamples = m_fileReference->waveTracks[0].waveData.size();
+  if (trackWidth <= 0 || nrOfSamples == 0)
+    return 1;
+  return ceil((double) nrOfSamples / trackWidth) / m_samplesPerPixel;
+}
+
+void WaveformDrawer::ZoomInTime() {
+  ZoomTimeAt(leftMargin + trackWidth / 2, 2);
+}
+
+void WaveformDrawer::ZoomOutTime() {
+  ZoomTimeAt(leftMargin + trackWidth / 2, 0.5);
+}
+
+void WaveformDrawer::ZoomAllTime() {
+  m_zoomedAll = true;
+  UpdateView();
+  somethingHasChanged = true;
+}
+
+void WaveformDrawer::ZoomTimeAt(int x, double factor) {
+  if (trackWidth <= 0)
+    return;
+
+  // the sample under x stays where it is
+  double anchor = PixelToSample(x);
+  m_samplesPerPixel /= factor;
+  if (m_samplesPerPixel < 1.0 / WAVEFORM_MAX_PIXELS_PER_SAMPLE)
+    m_samplesPerPixel = 1.0 / WAVEFORM_MAX_PIXELS_PER_SAMPLE;
+  m_zoomedAll = false;
+  m_startSample = anchor - (x - leftMargin) * m_samplesPerPixel;
+  UpdateView();
+  somethingHasChanged = true;
+}
+
+void WaveformDrawer::ScrollView(double pixels) {
+  if (m_zoomedAll || pixels == 0)
+    return;
+
+  m_startSample += pixels * m_samplesPerPixel;
+  UpdateView();
+  somethingHasChanged = true;
+  Refresh();
+}
+
+void WaveformDrawer::UpdateView() {
+  int nrOfSamples = m_fileReference->waveTracks[0].waveData.size();
+  if (trackWidth <= 0 || nrOfSamples == 0) {
+    m_startSample = 0;
+    m_samplesPerPixel = 1;
+    return;
+  }
+
+  // zoomed out completely the whole file fits in the track
+  double allSamplesPerPixel = ceil((double) nrOfSamples / trackWidth);
+  if (m_zoomedAll || m_samplesPerPixel >= allSamplesPerPixel) {
+    m_zoomedAll = true;
+    m_samplesPerPixel = allSamplesPerPixel;
+    m_startSample = 0;
+    return;
+  }
+
+  double lastStart = nrOfSamples - m_samplesPerPixel * trackWidth;
+  if (m_startSample > lastStart)
+    m_startSample = lastStart;
+  if (m_startSample < 0)
+    m_startSample = 0;
+}
+
+int WaveformDrawer::SampleToPixel(double sample) {
+  double x = floor((sample - m_startSample) / m_samplesPerPixel);
+  // far outside the view is as good as just outside
+  if (x < -trackWidth)
+    x = -trackWidth;
+  if (x > 2 * trackWidth)
+    x = 2 * trackWidth;
+  return leftMargin + (int) x;
+}
+
+double WaveformDrawer::PixelToSample(int x) {
+  return m_startSample + (x - leftMargin) * m_samplesPerPixel;
+}
+
+bool WaveformDrawer::IsWithinTrack(int x) {
+  return x >= leftMargin && x <= leftMargin + trackWidth;
+}
+
+double WaveformDrawer::GetFileWidthInPixels() {
+  return m_fileReference->waveTracks[0].waveData.size() / m_samplesPerPixel;
+}
+
+void WaveformDrawer::OnMouseWheel(wxMouseEvent& event) {
+  if (event.ControlDown()) {
+    // zoom in or out on time around the pointer, one step per notch
+    m_wheelRotation += event.GetWheelRotation();
+    int steps = m_wheelRotation / event.GetWheelDelta();
+    if (steps == 0)
+      return;
+    m_wheelRotation -= steps * event.GetWheelDelta();
+    int x = event.GetX();
+    if (x < leftMargin)
+      x = leftMargin;
+    if (x > leftMargin + trackWidth)
+      x = leftMargin + trackWidth;
+    ZoomTimeAt(x, pow(2, steps));
+    ::wxGetApp().frame->UpdateZoomStatus();
+    Refresh();
+  } else {
+    // a tenth of the view per notch, smoothly for wheels with a finer resolution
+    double pixels = (double) event.GetWheelRotation() / event.GetWheelDelta() * trackWidth / 10;
+    if (event.GetWheelAxis() == wxMOUSE_WHEEL_VERTICAL)
+      pixels = -pixels;
+    ScrollView(pixels);
+  }
+}
+
+void WaveformDrawer::OnMiddleClick(wxMouseEvent& event) {
+  m_panX = event.GetX();
+}
+
 void WaveformDrawer::OnKeyDown(wxKeyEvent& event) {
   MyFrame *myParent = (MyFrame *) GetParent();
   myParent->OnKeyboardInput(event);
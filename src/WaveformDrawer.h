@@ -24,8 +24,12 @@
 #include <wx/wx.h>
 #include <vector>
 #include "FileHandling.h"
+#include "WaveformSummary.h"
 #include "wx/overlay.h"
 
+// Closest time zoom, one sample is then spread over this many pixels
+#define WAVEFORM_MAX_PIXELS_PER_SAMPLE 16
+
 typedef struct {
   int placedInRow;
   std::vector<int> overlappingLoops;
@@ -60,6 +64,8 @@ public:
   void OnMouseMotion(wxMouseEvent& event);
   void OnMouseLeave(wxMouseEvent& event);
   void OnMouseEnter(wxMouseEvent& event);
+  void OnMouseWheel(wxMouseEvent& event);
+  void OnMiddleClick(wxMouseEvent& event);
   void DrawSustainSectionRectOutline();
   void CalculateSustainRectZones();
   void DrawSustainIndication(wxDC &dc);
@@ -68,6 +74,7 @@ public:
   void OnPaint(wxDC& dc);
   void OnPaintPlayPosition(wxDC& dc);
   void SetPlayPosition(unsigned int pPos);
+  void SetPlaybackActive(bool active);
   void AddCuePosition(unsigned int cuePos);
   void AddLoopPosition(unsigned int startPos, unsigned int endPos);
   void ChangeLoopPositions(unsigned int start, unsigned int end, int idx);
@@ -82,6 +89,12 @@ public:
   void ZoomInAmplitude();
   void ZoomOutAmplitude();
 
+  // Methods for dealing with time zoom, zooming in keeps the middle of the view
+  double GetTimeZoomFactor();
+  void ZoomInTime();
+  void ZoomOutTime();
+  void ZoomAllTime();
+
 private:
   std::vector<unsigned int> cueSampleOffset;
   std::vector<std::pair<unsigned int, unsigned int> > loopPositions;
@@ -94,7 +107,10 @@ private:
   int marginBetweenTracks;
   int leftMargin;
   int rightMargin;
-  unsigned int playPosition;
+  unsigned int playSample;
+  int playPosition; // in pixels, the marker is hidden when outside the track
+  bool m_playbackActive; // the play cursor is then only drawn on the overlay
+  int m_drawnPlayPosition;
   wxColour white;
   wxColour black;
   wxColour blue;
@@ -112,7 +128,20 @@ private:
   int selectedCueIndex; // used when changing cue position
   bool cueIsSelected; // used when changing cue position
   int m_amplitudeZoomLevel;
+  double m_startSample; // the sample at the left edge of the tracks
+  double m_samplesPerPixel;
+  bool m_zoomedAll;
+  wxCoord m_panX; // where the view was grabbed with the middle button
+  int m_wheelRotation; // of the wheel towards the next zoom step
+  // the tracks, waveform and time ruler as last rendered, the markers are drawn on top
+  wxBitmap m_waveformLayer;
+  bool m_waveformHasChanged; // the audio or its summary has changed
+  double m_layerStartSample;
+  double m_layerSamplesPerPixel;
+  int m_layerAmplitudeZoomLevel;
+  std::vector<wxPoint> m_wavePoints; // kept to not allocate them for every channel
   FileHandling *m_fileReference;
+  WaveformSummary *m_summary;
   SUSTAINSECTION_RECT m_sustainsection_rect;
   SUSTAINSECTION_RECT m_old_sustainsection_rect;
   bool mouseWithinSustainSection;
@@ -130,6 +159,19 @@ private:
   bool hasCueSelection;
 
   void OnClickAddCue(wxCommandEvent& event);
+  void OnSummaryReady(wxThreadEvent& event);
+  void DrawPlayCursor(wxDC& dc);
+  void DrawPlayPositionArea(wxDC& dc);
+  void RenderWaveformLayer(wxSize size);
+  void DrawMarkers(wxDC& dc);
+  void UpdateView();
+  void ZoomTimeAt(int x, double factor);
+  void ScrollView(double pixels);
+  int SampleToPixel(double sample);
+  double PixelToSample(int x);
+  bool IsWithinTrack(int x);
+  double GetFileWidthInPixels();
+  unsigned FindLowestPowerSample(int x);
 
   // This class handles events
   DECLARE_EVENT_TABLE()
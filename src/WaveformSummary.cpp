@@ -0,0 +1,260 @@
+/*
+ * WaveformSummary.cpp is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#include "WaveformSummary.h"
+#include "FileHandling.h"
+#include <wx/stopwatch.h>
+#include <algorithm>
+
+class WaveformSummaryBuilder : public wxThread {
+public:
+  WaveformSummaryBuilder(WaveformSummary *summary) : wxThread(wxTHREAD_JOINABLE), m_summary(summary) {}
+
+protected:
+  virtual ExitCode Entry() {
+    m_summary->BuilderLoop();
+    return (ExitCode) 0;
+  }
+
+private:
+  WaveformSummary *m_summary;
+};
+
+WaveformSummary::WaveformSummary(FileHandling *audioFile) :
+  m_audioFile(audioFile),
+  m_channels(0),
+  m_length(0),
+  m_nbrLevels(0),
+  m_listener(NULL),
+  m_eventId(wxID_ANY),
+  m_builder(NULL),
+  m_ready(false),
+  m_builtFrames(0),
+  m_stop(false) {
+
+}
+
+WaveformSummary::~WaveformSummary() {
+  Stop();
+}
+
+void WaveformSummary::Build(wxEvtHandler *listener, int eventId) {
+  Stop();
+  m_listener = listener;
+  m_eventId = eventId;
+  m_ready.store(false);
+  m_builtFrames.store(0);
+  m_stop.store(false);
+  Allocate();
+
+  WaveformSummaryBuilder *builder = new WaveformSummaryBuilder(this);
+  if (builder->Run() == wxTHREAD_NO_ERROR) {
+    m_builder = builder;
+  } else {
+    delete builder;
+    BuilderLoop();
+  }
+}
+
+void WaveformSummary::Stop() {
+  if (m_builder) {
+    m_stop.store(true);
+    m_builder->Wait();
+    delete m_builder;
+    m_builder = NULL;
+  }
+}
+
+bool WaveformSummary::IsReady() {
+  return m_ready.load();
+}
+
+void WaveformSummary::Update(unsigned long first, unsigned long last) {
+  Stop();
+  std::vector<WAVETRACK> &tracks = m_audioFile->waveTracks;
+  unsigned long length = tracks.empty() ? 0 : tracks[0].waveData.size();
+  if (!m_ready.load() || tracks.size() != m_channels || length != m_length) {
+    // a summary that wasn't finished or that doesn't fit any more is built again
+    if (m_listener)
+      Build(m_listener, m_eventId);
+    return;
+  }
+
+  if (last >= m_length)
+    last = m_length - 1;
+  if (m_length > 0 && first <= last)
+    CalculateBlocks(first, last);
+
+  // anything drawn from the summary must be drawn again
+  if (m_listener)
+    wxQueueEvent(m_listener, new wxThreadEvent(wxEVT_THREAD, m_eventId));
+}
+
+void WaveformSummary::GetMinMax(unsigned channel, unsigned long start, unsigned long end, double &minValue, double &maxValue) {
+  minValue = 0;
+  maxValue = 0;
+  std::vector<WAVETRACK> &tracks = m_audioFile->waveTracks;
+  if (channel >= tracks.size())
+    return;
+  const std::vector<double> &data = tracks[channel].waveData;
+  if (end > data.size())
+    end = data.size();
+  if (start >= end)
+    return;
+
+  minValue = data[start];
+  maxValue = data[start];
+  unsigned long built = m_ready.load() ? m_length : m_builtFrames.load();
+  if (data.size() != m_length || channel >= m_channels)
+    built = 0;
+
+  // take the largest finished block that starts here and fits in what is left of the range
+  unsigned long pos = start;
+  while (pos < end) {
+    if (pos >= built) {
+      // not summarized yet, a rough picture from a limited number of samples will do
+      unsigned long step = (end - pos) / WAVEFORM_SUMMARY_MAX_SCAN;
+      if (step < 1)
+        step = 1;
+      for (; pos < end; pos += step) {
+        if (data[pos] > maxValue)
+          maxValue = data[pos];
+        else if (data[pos] < minValue)
+          minValue = data[pos];
+      }
+      break;
+    }
+
+    int level = m_nbrLevels - 1;
+    for (; level >= 0; level--) {
+      unsigned long blockSize = 1UL << (WAVEFORM_SUMMARY_FIRST_LEVEL + level);
+      unsigned long blockEnd = std::min(pos + blockSize, m_length);
+      if ((pos & (blockSize - 1)) == 0 && blockEnd <= end && blockEnd <= built)
+        break;
+    }
+
+    if (level < 0) {
+      if (data[pos] > maxValue)
+        maxValue = data[pos];
+      else if (data[pos] < minValue)
+        minValue = data[pos];
+      pos++;
+    } else {
+      unsigned shift = WAVEFORM_SUMMARY_FIRST_LEVEL + level;
+      const std::vector<float> &blocks = m_levels[channel * m_nbrLevels + level];
+      unsigned long block = pos >> shift;
+      if (blocks[2 * block] < minValue)
+        minValue = blocks[2 * block];
+      if (blocks[2 * block + 1] > maxValue)
+        maxValue = blocks[2 * block + 1];
+      pos += 1UL << shift;
+    }
+  }
+}
+
+void WaveformSummary::BuilderLoop() {
+  // the blocks are finished from the start, the listener is told how far it has got now and then
+  wxStopWatch sinceProgress;
+  for (unsigned long first = 0; first < m_length; first += WAVEFORM_SUMMARY_CHUNK_FRAMES) {
+    unsigned long last = std::min(first + WAVEFORM_SUMMARY_CHUNK_FRAMES, m_length) - 1;
+    if (!CalculateBlocks(first, last))
+      return;
+    m_builtFrames.store(last + 1);
+
+    if (m_listener && last + 1 < m_length && sinceProgress.Time() >= WAVEFORM_SUMMARY_PROGRESS_INTERVAL) {
+      wxQueueEvent(m_listener, new wxThreadEvent(wxEVT_THREAD, m_eventId));
+      sinceProgress.Start();
+    }
+  }
+
+  m_ready.store(true);
+  if (m_listener)
+    wxQueueEvent(m_listener, new wxThreadEvent(wxEVT_THREAD, m_eventId));
+}
+
+void WaveformSummary::Allocate() {
+  std::vector<WAVETRACK> &tracks = m_audioFile->waveTracks;
+  m_channels = tracks.size();
+  m_length = m_channels > 0 ? tracks[0].waveData.size() : 0;
+
+  // levels are added until a single block covers everything
+  std::vector<unsigned long> blocksPerLevel;
+  unsigned long blocks = (m_length + (1UL << WAVEFORM_SUMMARY_FIRST_LEVEL) - 1) >> WAVEFORM_SUMMARY_FIRST_LEVEL;
+  while (blocks > 0) {
+    blocksPerLevel.push_back(blocks);
+    if (blocks == 1)
+      break;
+    blocks = (blocks + 1) / 2;
+  }
+  m_nbrLevels = blocksPerLevel.size();
+
+  m_levels.assign(m_channels * m_nbrLevels, std::vector<float>());
+  for (unsigned ch = 0; ch < m_channels; ch++) {
+    for (unsigned level = 0; level < m_nbrLevels; level++)
+      m_levels[ch * m_nbrLevels + level].resize(2 * blocksPerLevel[level]);
+  }
+}
+
+bool WaveformSummary::CalculateBlocks(unsigned long first, unsigned long last) {
+  for (unsigned ch = 0; ch < m_channels; ch++) {
+    const double *data = &m_audioFile->waveTracks[ch].waveData[0];
+
+    // the finest level from the samples
+    unsigned long firstBlock = first >> WAVEFORM_SUMMARY_FIRST_LEVEL;
+    unsigned long lastBlock = last >> WAVEFORM_SUMMARY_FIRST_LEVEL;
+    std::vector<float> &finest = m_levels[ch * m_nbrLevels];
+    for (unsigned long b = firstBlock; b <= lastBlock; b++) {
+      if ((b & 0xFFF) == 0 && m_stop.load())
+        return false;
+
+      unsigned long start = b << WAVEFORM_SUMMARY_FIRST_LEVEL;
+      unsigned long end = std::min(start + (1UL << WAVEFORM_SUMMARY_FIRST_LEVEL), m_length);
+      double minValue = data[start];
+      double maxValue = data[start];
+      for (unsigned long i = start + 1; i < end; i++) {
+        minValue = std::min(minValue, data[i]);
+        maxValue = std::max(maxValue, data[i]);
+      }
+      finest[2 * b] = (float) minValue;
+      finest[2 * b + 1] = (float) maxValue;
+    }
+
+    // every other level from the two blocks below each block
+    for (unsigned level = 1; level < m_nbrLevels; level++) {
+      firstBlock >>= 1;
+      lastBlock >>= 1;
+      const std::vector<float> &below = m_levels[ch * m_nbrLevels + level - 1];
+      std::vector<float> &blocks = m_levels[ch * m_nbrLevels + level];
+      for (unsigned long b = firstBlock; b <= lastBlock; b++) {
+        unsigned long c = 2 * b;
+        float minValue = below[2 * c];
+        float maxValue = below[2 * c + 1];
+        if (2 * (c + 1) < below.size()) {
+          minValue = std::min(minValue, below[2 * c + 2]);
+          maxValue = std::max(maxValue, below[2 * c + 3]);
+        }
+        blocks[2 * b] = minValue;
+        blocks[2 * b + 1] = maxValue;
+      }
+    }
+  }
+
+  return true;
+}
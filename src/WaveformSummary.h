@@ -0,0 +1,95 @@
+/*
+ * WaveformSummary.h is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#ifndef WAVEFORMSUMMARY_H
+#define WAVEFORMSUMMARY_H
+
+#include <wx/wx.h>
+#include <wx/thread.h>
+#include <atomic>
+#include <vector>
+
+// The finest level keeps min/max of blocks of 2^WAVEFORM_SUMMARY_FIRST_LEVEL samples
+#define WAVEFORM_SUMMARY_FIRST_LEVEL 4
+// Frames the builder calculates before the part that is done grows
+#define WAVEFORM_SUMMARY_CHUNK_FRAMES 65536
+// Most samples looked at for a range that isn't summarized yet
+#define WAVEFORM_SUMMARY_MAX_SCAN 64
+// Milliseconds between the events telling how far the builder has got
+#define WAVEFORM_SUMMARY_PROGRESS_INTERVAL 100
+
+class FileHandling;
+class WaveformSummaryBuilder;
+
+/*
+ * WaveformSummary keeps a pyramid of the minimum and maximum per block of
+ * samples for each channel of a file. Every level doubles the block size of
+ * the one below so the extremes of any range of samples are found from a
+ * handful of blocks, at most O(log n) of them, and drawing a waveform costs
+ * in proportion to the pixels instead of the samples.
+ *
+ * The pyramid is built on a background thread from the start of the file
+ * and forward, a chunk at a time. GetMinMax() uses the blocks that are done
+ * and looks at no more than WAVEFORM_SUMMARY_MAX_SCAN samples spread over the
+ * rest of the range, so a rough overview can be drawn at once and refined as
+ * the builder gets further. The listener gets a wxThreadEvent with the given
+ * id now and then while building and when it's ready. When the audio is
+ * edited Update() recalculates only the blocks over the edited frames and
+ * sends the same event again. All public functions are called from the GUI
+ * thread, Stop() must be called before the wave data is changed.
+ */
+class WaveformSummary {
+public:
+  WaveformSummary(FileHandling *audioFile);
+  ~WaveformSummary();
+
+  void Build(wxEvtHandler *listener, int eventId);
+  void Stop();
+  bool IsReady();
+  // After the frames from first to last (inclusive) have changed
+  void Update(unsigned long first, unsigned long last);
+
+  // Extremes of the samples from start up to, but not including, end
+  void GetMinMax(unsigned channel, unsigned long start, unsigned long end, double &minValue, double &maxValue);
+
+  // Called by the builder thread only
+  void BuilderLoop();
+
+private:
+  FileHandling *m_audioFile;
+  unsigned m_channels;
+  unsigned long m_length;
+  unsigned m_nbrLevels;
+  // min and max pairs for each block, index channel * m_nbrLevels + level
+  std::vector<std::vector<float> > m_levels;
+  wxEvtHandler *m_listener;
+  int m_eventId;
+  WaveformSummaryBuilder *m_builder;
+  std::atomic<bool> m_ready;
+  std::atomic<unsigned long> m_builtFrames; // the blocks below this frame are done
+  std::atomic<bool> m_stop;
+
+  void Allocate();
+  // Calculates the blocks of all levels that cover the frames first to last
+  bool CalculateBlocks(unsigned long first, unsigned long last);
+
+};
+
+#endif
@@ -0,0 +1,163 @@
+/*
+ * ZeroCrossingIndex.cpp is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#include "ZeroCrossingIndex.h"
+#include "FileHandling.h"
+#include <algorithm>
+#include <cmath>
+
+static bool IndexIsBefore(const ZERO_CROSSING &crossing, unsigned long position) {
+  return crossing.index < position;
+}
+
+static bool PositionIsBefore(unsigned long position, const ZERO_CROSSING &crossing) {
+  return position < crossing.index;
+}
+
+ZeroCrossingIndex::ZeroCrossingIndex(FileHandling *audioFile) : m_audioFile(audioFile) {
+
+}
+
+ZeroCrossingIndex::~ZeroCrossingIndex() {
+
+}
+
+void ZeroCrossingIndex::Invalidate() {
+  m_crossings.clear();
+  m_isIndexed.clear();
+}
+
+double ZeroCrossingIndex::GetPosition(const ZERO_CROSSING &crossing) {
+  return (double) crossing.index - 1.0 + crossing.fraction;
+}
+
+unsigned ZeroCrossingIndex::GetClosestSample(const ZERO_CROSSING &crossing) {
+  if (crossing.fraction < 0.5f)
+    return crossing.index - 1;
+  else
+    return crossing.index;
+}
+
+bool ZeroCrossingIndex::FindNext(unsigned channel, ZERO_CROSSING_DIRECTION direction, unsigned long position, ZERO_CROSSING &crossing) {
+  bool found = false;
+  for (int rising = 1; rising >= 0; rising--) {
+    if ((rising && direction == ZERO_CROSSING_FALLING) || (!rising && direction == ZERO_CROSSING_RISING))
+      continue;
+    const std::vector<ZERO_CROSSING> &crossings = GetChannelCrossings(channel, rising);
+    std::vector<ZERO_CROSSING>::const_iterator next = std::lower_bound(crossings.begin(), crossings.end(), position, IndexIsBefore);
+    if (next != crossings.end() && (!found || next->index < crossing.index)) {
+      crossing = *next;
+      found = true;
+    }
+  }
+  return found;
+}
+
+bool ZeroCrossingIndex::FindPrevious(unsigned channel, ZERO_CROSSING_DIRECTION direction, unsigned long position, ZERO_CROSSING &crossing) {
+  bool found = false;
+  for (int rising = 1; rising >= 0; rising--) {
+    if ((rising && direction == ZERO_CROSSING_FALLING) || (!rising && direction == ZERO_CROSSING_RISING))
+      continue;
+    const std::vector<ZERO_CROSSING> &crossings = GetChannelCrossings(channel, rising);
+    std::vector<ZERO_CROSSING>::const_iterator after = std::upper_bound(crossings.begin(), crossings.end(), position, PositionIsBefore);
+    if (after != crossings.begin() && (!found || (after - 1)->index > crossing.index)) {
+      crossing = *(after - 1);
+      found = true;
+    }
+  }
+  return found;
+}
+
+bool ZeroCrossingIndex::FindNearest(unsigned channel, ZERO_CROSSING_DIRECTION direction, double position, ZERO_CROSSING &crossing) {
+  if (position < 0)
+    position = 0;
+  unsigned long sample = (unsigned long) position;
+  double bestDistance = -1;
+  for (int rising = 1; rising >= 0; rising--) {
+    if ((rising && direction == ZERO_CROSSING_FALLING) || (!rising && direction == ZERO_CROSSING_RISING))
+      continue;
+    const std::vector<ZERO_CROSSING> &crossings = GetChannelCrossings(channel, rising);
+    // a crossing lies between its index - 1 and index so the closest one is
+    // the last before sample or one of the two after it
+    long first = std::lower_bound(crossings.begin(), crossings.end(), sample, IndexIsBefore) - crossings.begin();
+    for (long i = first - 1; i <= first + 1; i++) {
+      if (i < 0 || i >= (long) crossings.size())
+        continue;
+      double distance = fabs(GetPosition(crossings[i]) - position);
+      if (bestDistance < 0 || distance < bestDistance) {
+        bestDistance = distance;
+        crossing = crossings[i];
+      }
+    }
+  }
+  return bestDistance >= 0;
+}
+
+void ZeroCrossingIndex::GetCrossings(unsigned channel, ZERO_CROSSING_DIRECTION direction, unsigned long first, unsigned long last, std::vector<ZERO_CROSSING> &crossings) {
+  crossings.clear();
+  if (direction == ZERO_CROSSING_ANY || first > last)
+    return;
+  const std::vector<ZERO_CROSSING> &all = GetChannelCrossings(channel, direction == ZERO_CROSSING_RISING);
+  std::vector<ZERO_CROSSING>::const_iterator begin = std::lower_bound(all.begin(), all.end(), first, IndexIsBefore);
+  std::vector<ZERO_CROSSING>::const_iterator end = std::upper_bound(begin, all.end(), last, PositionIsBefore);
+  crossings.assign(begin, end);
+}
+
+const std::vector<ZERO_CROSSING>& ZeroCrossingIndex::GetChannelCrossings(unsigned channel, bool rising) {
+  if (m_isIndexed.size() != m_audioFile->waveTracks.size()) {
+    m_crossings.assign(m_audioFile->waveTracks.size() * 2, std::vector<ZERO_CROSSING>());
+    m_isIndexed.assign(m_audioFile->waveTracks.size(), false);
+  }
+  if (channel >= m_isIndexed.size()) {
+    static const std::vector<ZERO_CROSSING> noCrossings;
+    return noCrossings;
+  }
+  if (!m_isIndexed[channel])
+    IndexChannel(channel);
+  return m_crossings[channel * 2 + (rising ? 0 : 1)];
+}
+
+void ZeroCrossingIndex::IndexChannel(unsigned channel) {
+  const std::vector<double> &data = m_audioFile->waveTracks[channel].waveData;
+  std::vector<ZERO_CROSSING> &rising = m_crossings[channel * 2];
+  std::vector<ZERO_CROSSING> &falling = m_crossings[channel * 2 + 1];
+  rising.clear();
+  falling.clear();
+
+  ZERO_CROSSING crossing;
+  for (unsigned i = 1; i < data.size(); i++) {
+    double prev = data[i - 1];
+    double v = data[i];
+    if (prev <= 0.0 && v > 0.0) {
+      crossing.index = i;
+      crossing.fraction = (float) (-prev / (v - prev));
+      rising.push_back(crossing);
+    } else if (prev > 0.0 && v <= 0.0) {
+      crossing.index = i;
+      crossing.fraction = (float) (prev / (prev - v));
+      falling.push_back(crossing);
+    }
+  }
+
+  // don't keep the spare capacity from growing the vectors
+  std::vector<ZERO_CROSSING>(rising).swap(rising);
+  std::vector<ZERO_CROSSING>(falling).swap(falling);
+  m_isIndexed[channel] = true;
+}
@@ -0,0 +1,79 @@
+/*
+ * ZeroCrossingIndex.h is a part of LoopAuditioneer software
+ * Copyright (C) 2011-2024 Lars Palo and contributors (see AUTHORS file)
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ * You can contact the author on larspalo(at)yahoo.se
+ */
+
+#ifndef ZEROCROSSINGINDEX_H
+#define ZEROCROSSINGINDEX_H
+
+#include <vector>
+
+class FileHandling;
+
+enum ZERO_CROSSING_DIRECTION {
+  ZERO_CROSSING_RISING, // from zero or below to above zero
+  ZERO_CROSSING_FALLING, // from above zero to zero or below
+  ZERO_CROSSING_ANY
+};
+
+typedef struct {
+  unsigned index; // the first sample on the new side of zero
+  float fraction; // where the line between index - 1 and index crosses zero (0 to 1)
+} ZERO_CROSSING;
+
+/*
+ * ZeroCrossingIndex keeps the positions of all zero crossings of each channel
+ * of a file, sorted and split by direction, so that the crossings around any
+ * position are found by binary search in O(log n) instead of scanning the
+ * audio. A channel is indexed the first time it's asked for and the whole
+ * index is dropped by Invalidate() when the wave data changes. Each crossing
+ * takes 8 bytes.
+ */
+class ZeroCrossingIndex {
+public:
+  ZeroCrossingIndex(FileHandling *audioFile);
+  ~ZeroCrossingIndex();
+
+  void Invalidate();
+
+  // Exact position of a crossing in samples
+  static double GetPosition(const ZERO_CROSSING &crossing);
+  // The sample of the two around a crossing that is closest to zero
+  static unsigned GetClosestSample(const ZERO_CROSSING &crossing);
+
+  // The first crossing with an index at or after position, false if there is none
+  bool FindNext(unsigned channel, ZERO_CROSSING_DIRECTION direction, unsigned long position, ZERO_CROSSING &crossing);
+  // The last crossing with an index at or before position, false if there is none
+  bool FindPrevious(unsigned channel, ZERO_CROSSING_DIRECTION direction, unsigned long position, ZERO_CROSSING &crossing);
+  // The crossing with an exact position closest to position, false if there is none
+  bool FindNearest(unsigned channel, ZERO_CROSSING_DIRECTION direction, double position, ZERO_CROSSING &crossing);
+  // All crossings of one direction with an index from first to last (inclusive), in order
+  void GetCrossings(unsigned channel, ZERO_CROSSING_DIRECTION direction, unsigned long first, unsigned long last, std::vector<ZERO_CROSSING> &crossings);
+
+private:
+  FileHandling *m_audioFile;
+  // index channel * 2 for rising and channel * 2 + 1 for falling crossings
+  std::vector<std::vector<ZERO_CROSSING> > m_crossings;
+  std::vector<bool> m_isIndexed;
+
+  const std::vector<ZERO_CROSSING>& GetChannelCrossings(unsigned channel, bool rising);
+  void IndexChannel(unsigned channel);
+
+};
+
+#endif